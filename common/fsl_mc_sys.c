@@ -33,28 +33,161 @@
 
 #include <errno.h>
 #include <assert.h>
+#include <stdio.h>
 #include <string.h>
+#include <stdlib.h>		/* rand_r() */
+#include <time.h>
 #include <fcntl.h>		/* open() */
 #include <unistd.h>		/* close() */
 #include <sys/ioctl.h>
 #include "fsl_mc_sys.h"
+#include "../mc_v10/fsl_mc_cmd.h"
 #include "fsl_mc_ioctl.h"
-#include "utils.h"
 
-int mc_io_init(struct fsl_mc_io *mc_io)
+#define MC_IO_DEBUG_PRINTF(_mc_io, _fmt, ...) \
+do { \
+	if ((_mc_io)->debug) \
+		fprintf(stderr, "DBG: %s:%d: " _fmt, \
+			__func__, __LINE__, ##__VA_ARGS__); \
+} while (0)
+
+/*
+ * Commands rejected because the MC is busy never ran and are always
+ * resent. Timed out commands may have been executed by the MC, and
+ * running most of them twice is not harmless: a second destroy, assign,
+ * connect or set_obj_label fails or acts twice, and a second open leaks
+ * a token. So only the read-only queries are resent when they time out.
+ *
+ * Retries back off exponentially, with jitter so that concurrent
+ * portals do not retry in lockstep, until the time budget of the
+ * command class is spent.
+ */
+#define MC_RETRY_MIN_BACKOFF_US		500
+#define MC_RETRY_MAX_BACKOFF_US		100000
+
+enum mc_cmd_class {
+	MC_CMD_CLASS_SESSION,		/* open/close */
+	MC_CMD_CLASS_PROVISION,		/* create/destroy */
+	MC_CMD_CLASS_DEFAULT,
+};
+
+/* retry time budget of each command class, in microseconds */
+static const uint64_t mc_retry_budget_us[] = {
+	[MC_CMD_CLASS_SESSION] = 1000000,
+	[MC_CMD_CLASS_PROVISION] = 10000000,
+	[MC_CMD_CLASS_DEFAULT] = 2000000,
+};
+
+/*
+ * 12-bit command id, located in the upper bits of the header by both
+ * the v9 and the v10 command encodings
+ */
+static uint16_t mc_cmd_id(const struct mc_command *cmd)
+{
+	return (uint16_t)(le64toh(cmd->header) >> 52);
+}
+
+static enum mc_cmd_class mc_cmd_class(uint16_t cmd_id)
+{
+	if (cmd_id >= 0x800 && cmd_id < 0x900)
+		return MC_CMD_CLASS_SESSION;
+
+	/*
+	 * 0x900-0x9ff: object create/destroy,
+	 * 0x151/0x152: dprc create/destroy container
+	 */
+	if ((cmd_id >= 0x900 && cmd_id < 0xa00) ||
+	    cmd_id == 0x151 || cmd_id == 0x152)
+		return MC_CMD_CLASS_PROVISION;
+
+	return MC_CMD_CLASS_DEFAULT;
+}
+
+/*
+ * Command ids which only read state, for every object type of the v9 and
+ * v10 flibs which uses them
+ */
+static bool mc_cmd_is_query(uint16_t cmd_id)
+{
+	/* get_api_version of each object type */
+	if (cmd_id >= 0xa01 && cmd_id <= 0xa10)
+		return true;
+
+	switch (cmd_id) {
+	case 0x004:	/* get_attributes */
+	case 0x006:	/* dprtc is_enabled */
+	case 0x011:	/* dprtc get_irq */
+	case 0x013:	/* dprtc get_irq_enable */
+	case 0x015:	/* get_irq_mask */
+	case 0x016:	/* get_irq_status */
+	case 0x034:	/* dpsw if_get_counter */
+	case 0x045:	/* dpsw if_get_max_frame_length */
+	case 0x0a2:	/* dpdmux get_max_frame_length */
+	case 0x0a9:	/* dpsw if_get_taildrop */
+	case 0x0b2:	/* dpdmux if_get_counter */
+	case 0x0c4:	/* dpmac get_counter */
+	case 0x0c5:	/* dpmac get_mac_addr */
+	case 0x0e1:	/* dpci get_link_state */
+	case 0x0e2:	/* dpci get_peer_attr */
+	case 0x131:	/* dpdbg get_dpni_priv_tx_conf_fqid */
+	case 0x132:	/* dpdbg get_dpcon_info */
+	case 0x133:	/* dpdbg get_dpbp_info */
+	case 0x134:	/* dpdbg get_dpci_fqid */
+	case 0x150:	/* dpdbg get_dpmac_counter */
+	case 0x153:	/* dpdbg get_ctlu_profiling_counters */
+	case 0x159:	/* dprc get_obj_count */
+	case 0x15a:	/* dprc get_obj */
+	case 0x15b:	/* dprc get_res_count */
+	case 0x15c:	/* dprc get_res_ids */
+	case 0x169:	/* dprc get_pool */
+	case 0x16a:	/* dprc get_pool_count */
+	case 0x16c:	/* dprc get_connection */
+	case 0x16d:	/* dprc get_mem */
+	case 0x196:	/* dpseci get_rx_queue */
+	case 0x197:	/* dpseci get_tx_queue */
+	case 0x1d2:	/* dprtc get_freq_compensation */
+	case 0x1d3:	/* dprtc get_time */
+	case 0x1da:	/* dprtc get_ext_trigger_timestamp */
+	case 0x215:	/* dpni get_link_state */
+	case 0x217:	/* dpni get_max_frame_length */
+	case 0x225:	/* dpni get_primary_mac_addr */
+	case 0x25d:	/* dpni get_statistics */
+	case 0x282:	/* dpaiop get_sl_version */
+	case 0x283:	/* dpaiop get_state */
+	case 0x830:	/* dprc get_container_id */
+	case 0x831:	/* dpmng get_version */
+	case 0x832:	/* dpmng get_soc_version */
+		return true;
+	default:
+		return false;
+	}
+}
+
+static uint64_t mc_time_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+int mc_io_init(struct fsl_mc_io *mc_io, const char *device_file)
 {
 	int fd = -1;
 	int error;
 
-	fd = open(restool.device_file, O_RDWR | O_SYNC);
+	fd = open(device_file, O_RDWR | O_SYNC);
 
 	if (fd < 0) {
 		error = -errno;
-		perror("open() failed ");
 		goto error;
 	}
 
 	mc_io->fd = fd;
+	mc_io->legacy = strcmp(device_file, "/dev/mc_restool") == 0;
+	mc_io->retry_seed = (unsigned int)(mc_time_us() ^ (uintptr_t)mc_io);
+	mc_io->trace = NULL;
+	memset(&mc_io->retry_stats, 0, sizeof(mc_io->retry_stats));
 	return 0;
 error:
 	if (fd != -1)
@@ -65,30 +198,95 @@ error:
 
 void mc_io_cleanup(struct fsl_mc_io *mc_io)
 {
+	struct mc_retry_stats *stats = &mc_io->retry_stats;
 	int error;
 
 	assert(mc_io->fd != -1);
 
+	MC_IO_DEBUG_PRINTF(mc_io,
+		"MC commands: %llu, retries: %llu, out of budget: %llu, backoff: %llu us\n",
+		(unsigned long long)stats->num_commands,
+		(unsigned long long)stats->num_retries,
+		(unsigned long long)stats->num_exhausted,
+		(unsigned long long)stats->backoff_us);
+
 	error = close(mc_io->fd);
 	if (error == -1)
 		perror("close failed");
 }
 
-int mc_send_command(struct fsl_mc_io *mc_io, struct mc_command *cmd)
+static int mc_send_command_once(struct fsl_mc_io *mc_io,
+				struct mc_command *cmd)
 {
 	int error;
 
-	if (strcmp(restool.device_file, "/dev/mc_restool") == 0)
+	if (mc_io->legacy)
 		error = ioctl(mc_io->fd, RESTOOL_SEND_MC_COMMAND_LEGACY, cmd);
 	else
 		error = ioctl(mc_io->fd, RESTOOL_SEND_MC_COMMAND, cmd);
 
-	if (error == -1) {
-		error = -errno;
-		DEBUG_PRINTF(
+	if (error == -1)
+		return -errno;
+
+	return error;
+}
+
+int mc_send_command(struct fsl_mc_io *mc_io, struct mc_command *cmd)
+{
+	struct mc_retry_stats *stats = &mc_io->retry_stats;
+	uint16_t cmd_id = mc_cmd_id(cmd);
+	enum mc_cmd_class cmd_class = mc_cmd_class(cmd_id);
+	uint64_t backoff_us = MC_RETRY_MIN_BACKOFF_US;
+	uint64_t trace_start_us = mc_io->trace ? mc_time_us() : 0;
+	uint64_t start_us = 0;
+	uint64_t elapsed_us;
+	uint64_t delay_us;
+	struct mc_command saved_cmd = *cmd;
+	int error;
+
+	stats->num_commands++;
+	for (;;) {
+		error = mc_send_command_once(mc_io, cmd);
+		if (error != -EBUSY &&
+		    (error != -ETIMEDOUT || !mc_cmd_is_query(cmd_id)))
+			break;
+
+		if (start_us == 0)
+			start_us = mc_time_us();
+		elapsed_us = mc_time_us() - start_us;
+		if (elapsed_us >= mc_retry_budget_us[cmd_class]) {
+			stats->num_exhausted++;
+			break;
+		}
+
+		/* sleep for a random time between half and all of the backoff */
+		delay_us = backoff_us / 2 +
+			   rand_r(&mc_io->retry_seed) % (backoff_us / 2 + 1);
+		if (delay_us > mc_retry_budget_us[cmd_class] - elapsed_us)
+			delay_us = mc_retry_budget_us[cmd_class] - elapsed_us;
+
+		MC_IO_DEBUG_PRINTF(mc_io,
+			"MC command %#x failed with error %d, retrying in %lu us\n",
+			cmd_id, error, (unsigned long)delay_us);
+		usleep(delay_us);
+		stats->backoff_us += delay_us;
+		stats->num_retries++;
+
+		if (backoff_us < MC_RETRY_MAX_BACKOFF_US)
+			backoff_us *= 2;
+
+		/* the ioctl may have overwritten the command with a response */
+		*cmd = saved_cmd;
+	}
+
+	if (error < 0)
+		MC_IO_DEBUG_PRINTF(mc_io,
 			"ioctl(RESTOOL_SEND_MC_COMMAND) failed with error %d\n",
 			error);
-	}
+
+	if (mc_io->trace)
+		mc_io->trace(mc_io, &saved_cmd, cmd, error,
+			     mc_time_us() - trace_start_us);
 
 	return error;
 }
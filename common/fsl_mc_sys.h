@@ -35,17 +35,58 @@
 #define _FSL_MC_SYS_H
 
 #include <stdint.h>
+#include <stdbool.h>
 
 struct mc_command;
 
+/**
+ * struct mc_retry_stats - MC command retry counters
+ * @num_commands:	commands sent
+ * @num_retries:	commands resent because the MC was busy or timed out
+ * @num_exhausted:	commands failed after running out of retry budget
+ * @backoff_us:		total time spent backing off, in microseconds
+ */
+struct mc_retry_stats {
+	uint64_t num_commands;
+	uint64_t num_retries;
+	uint64_t num_exhausted;
+	uint64_t backoff_us;
+};
+
+struct fsl_mc_io;
+
+/**
+ * Hook called once per MC command, after its completion (retries
+ * included), with the command as sent and as returned by the MC
+ */
+typedef void mc_trace_fn_t(struct fsl_mc_io *mc_io,
+			   const struct mc_command *cmd,
+			   const struct mc_command *rsp,
+			   int error,
+			   uint64_t duration_us);
+
 /**
  * struct fsl_mc_io - MC I/O object
+ * @fd:		file descriptor of the MC portal device
+ * @legacy:	the portal is the legacy /dev/mc_restool device
+ * @debug:	print transport errors to stderr
+ * @retry_seed:	state of the backoff jitter generator
+ * @retry_stats: retry counters of this portal
+ * @trace:	optional command trace hook
+ *
+ * All the transport state lives here, so each MC portal can be used
+ * independently of the others (e.g. from different threads).
  */
 struct fsl_mc_io {
 	int fd;
+	bool legacy;
+	bool debug;
+	unsigned int retry_seed;
+	struct mc_retry_stats retry_stats;
+	mc_trace_fn_t *trace;
 };
 
-int mc_io_init(struct fsl_mc_io *mc_io);
+int mc_io_init(struct fsl_mc_io *mc_io, const char *device_file);
 
 void mc_io_cleanup(struct fsl_mc_io *mc_io);
 
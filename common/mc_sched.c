@@ -0,0 +1,420 @@
+/* Copyright 2026 NXP
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * * Neither the name of the above-listed copyright holders nor the
+ * names of any contributors may be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ *
+ * ALTERNATIVELY, this software may be distributed under the terms of the
+ * GNU General Public License ("GPL") as published by the Free Software
+ * Foundation, either version 2 of that License or (at your option) any
+ * later version.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Concurrent execution of independent MC operations.
+ *
+ * Each worker thread owns one MC portal (a separate open of the device
+ * file, which the fsl-mc driver backs with its own MC portal) and a queue
+ * of tasks. Tasks are distributed round-robin at submission time; a worker
+ * runs the most recently queued task of its own queue first and, when that
+ * is empty, steals the oldest task from the queue of another worker.
+ */
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "mc_sched.h"
+
+struct mc_task {
+	mc_task_fn_t *fn;
+	void *arg;
+};
+
+/**
+ * Double-ended queue of tasks: the owner pops from the tail, thieves
+ * take from the head
+ */
+struct mc_task_queue {
+	pthread_mutex_t lock;
+	struct mc_task *tasks;
+	unsigned int size;
+	unsigned int head;
+	unsigned int count;
+};
+
+struct mc_worker {
+	struct mc_sched *sched;
+	struct fsl_mc_io mc_io;
+	struct mc_task_queue queue;
+	pthread_t thread;
+	unsigned int index;
+	unsigned long num_run;
+	unsigned long num_stolen;
+};
+
+struct mc_sched {
+	/**
+	 * portal used to run the tasks when there are no workers
+	 */
+	struct fsl_mc_io *mc_io;
+
+	struct mc_worker *workers;
+	unsigned int num_workers;
+	unsigned int next_worker;
+
+	/**
+	 * protects the fields below
+	 */
+	pthread_mutex_t lock;
+
+	/**
+	 * signaled when a task is queued or the workers have to stop
+	 */
+	pthread_cond_t work_cond;
+
+	/**
+	 * signaled when a task completes
+	 */
+	pthread_cond_t done_cond;
+
+	unsigned int num_queued;
+	unsigned int num_pending;
+	unsigned int in_flight;
+	unsigned int max_in_flight;
+	int first_error;
+	bool stop;
+};
+
+#define MC_TASK_QUEUE_MIN_SIZE	16
+
+static int queue_push(struct mc_task_queue *queue, const struct mc_task *task)
+{
+	struct mc_task *tasks;
+	unsigned int size;
+	int error = 0;
+
+	pthread_mutex_lock(&queue->lock);
+	if (queue->count == queue->size) {
+		size = queue->size ? queue->size * 2 : MC_TASK_QUEUE_MIN_SIZE;
+		tasks = malloc(size * sizeof(*tasks));
+		if (!tasks) {
+			error = -ENOMEM;
+			goto out;
+		}
+
+		for (unsigned int i = 0; i < queue->count; i++)
+			tasks[i] = queue->tasks[(queue->head + i) % queue->size];
+
+		free(queue->tasks);
+		queue->tasks = tasks;
+		queue->size = size;
+		queue->head = 0;
+	}
+
+	queue->tasks[(queue->head + queue->count) % queue->size] = *task;
+	queue->count++;
+out:
+	pthread_mutex_unlock(&queue->lock);
+	return error;
+}
+
+static bool queue_pop_tail(struct mc_task_queue *queue, struct mc_task *task)
+{
+	bool found = false;
+
+	pthread_mutex_lock(&queue->lock);
+	if (queue->count != 0) {
+		queue->count--;
+		*task = queue->tasks[(queue->head + queue->count) %
+				     queue->size];
+		found = true;
+	}
+	pthread_mutex_unlock(&queue->lock);
+
+	return found;
+}
+
+static bool queue_pop_head(struct mc_task_queue *queue, struct mc_task *task)
+{
+	bool found = false;
+
+	pthread_mutex_lock(&queue->lock);
+	if (queue->count != 0) {
+		*task = queue->tasks[queue->head];
+		queue->head = (queue->head + 1) % queue->size;
+		queue->count--;
+		found = true;
+	}
+	pthread_mutex_unlock(&queue->lock);
+
+	return found;
+}
+
+static bool worker_take_task(struct mc_worker *worker, struct mc_task *task)
+{
+	struct mc_sched *sched = worker->sched;
+	struct mc_worker *victim;
+
+	if (queue_pop_tail(&worker->queue, task))
+		return true;
+
+	for (unsigned int i = 1; i < sched->num_workers; i++) {
+		victim = &sched->workers[(worker->index + i) %
+					 sched->num_workers];
+		if (queue_pop_head(&victim->queue, task)) {
+			worker->num_stolen++;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void *worker_main(void *arg)
+{
+	struct mc_worker *worker = arg;
+	struct mc_sched *sched = worker->sched;
+	struct mc_task task;
+	int error;
+
+	for (;;) {
+		if (!worker_take_task(worker, &task)) {
+			pthread_mutex_lock(&sched->lock);
+			while (sched->num_queued == 0 && !sched->stop)
+				pthread_cond_wait(&sched->work_cond,
+						  &sched->lock);
+			if (sched->num_queued == 0 && sched->stop) {
+				pthread_mutex_unlock(&sched->lock);
+				break;
+			}
+			pthread_mutex_unlock(&sched->lock);
+			continue;
+		}
+
+		pthread_mutex_lock(&sched->lock);
+		sched->num_queued--;
+		while (sched->max_in_flight != 0 &&
+		       sched->in_flight >= sched->max_in_flight)
+			pthread_cond_wait(&sched->done_cond, &sched->lock);
+		sched->in_flight++;
+		pthread_mutex_unlock(&sched->lock);
+
+		error = task.fn(&worker->mc_io, task.arg);
+		worker->num_run++;
+
+		pthread_mutex_lock(&sched->lock);
+		sched->in_flight--;
+		sched->num_pending--;
+		if (error < 0 && sched->first_error == 0)
+			sched->first_error = error;
+		pthread_cond_broadcast(&sched->done_cond);
+		pthread_mutex_unlock(&sched->lock);
+	}
+
+	return NULL;
+}
+
+static void stop_workers(struct mc_sched *sched, unsigned int num_workers)
+{
+	struct mc_worker *worker;
+
+	pthread_mutex_lock(&sched->lock);
+	sched->stop = true;
+	pthread_cond_broadcast(&sched->work_cond);
+	pthread_mutex_unlock(&sched->lock);
+
+	for (unsigned int i = 0; i < num_workers; i++) {
+		worker = &sched->workers[i];
+		pthread_join(worker->thread, NULL);
+		if (sched->mc_io->debug)
+			fprintf(stderr,
+				"DBG: %s: worker %u ran %lu tasks (%lu stolen)\n",
+				__func__, i, worker->num_run,
+				worker->num_stolen);
+		mc_io_cleanup(&worker->mc_io);
+		pthread_mutex_destroy(&worker->queue.lock);
+		free(worker->queue.tasks);
+	}
+}
+
+int mc_sched_create(struct mc_sched **sched_out,
+		    struct fsl_mc_io *mc_io,
+		    const char *device_file,
+		    unsigned int num_portals,
+		    unsigned int max_in_flight)
+{
+	struct mc_worker *worker;
+	struct mc_sched *sched;
+	unsigned int i;
+	int error;
+
+	sched = calloc(1, sizeof(*sched));
+	if (!sched)
+		return -ENOMEM;
+
+	sched->mc_io = mc_io;
+	sched->max_in_flight = max_in_flight;
+	pthread_mutex_init(&sched->lock, NULL);
+	pthread_cond_init(&sched->work_cond, NULL);
+	pthread_cond_init(&sched->done_cond, NULL);
+
+	/*
+	 * All the file descriptors of the legacy device share a single
+	 * MC portal, so there is nothing to gain from more workers.
+	 */
+	if (num_portals > MC_SCHED_MAX_WORKERS)
+		num_portals = MC_SCHED_MAX_WORKERS;
+	if (num_portals <= 1 || mc_io->legacy)
+		goto out;
+
+	sched->workers = calloc(num_portals, sizeof(*sched->workers));
+	if (!sched->workers) {
+		error = -ENOMEM;
+		goto err;
+	}
+
+	/*
+	 * Run with as many portals as could be opened: the driver limits
+	 * their number to the free MC portals of the container.
+	 */
+	for (i = 0; i < num_portals; i++) {
+		worker = &sched->workers[i];
+		error = mc_io_init(&worker->mc_io, device_file);
+		if (error < 0) {
+			if (mc_io->debug)
+				fprintf(stderr,
+					"DBG: %s: no MC portal %u: %s\n",
+					__func__, i, strerror(-error));
+			break;
+		}
+
+		worker->mc_io.debug = mc_io->debug;
+		worker->mc_io.trace = mc_io->trace;
+		worker->sched = sched;
+		worker->index = i;
+		pthread_mutex_init(&worker->queue.lock, NULL);
+	}
+
+	/*
+	 * The workers steal from each other, so their number must be
+	 * final before any of them starts
+	 */
+	sched->num_workers = i;
+	for (i = 0; i < sched->num_workers && sched->num_workers > 1; i++) {
+		worker = &sched->workers[i];
+		if (pthread_create(&worker->thread, NULL, worker_main,
+				   worker) != 0)
+			break;
+	}
+
+	if (i < sched->num_workers || sched->num_workers <= 1) {
+		/* fall back to running the tasks synchronously */
+		stop_workers(sched, i);
+		for ( ; i < sched->num_workers; i++) {
+			worker = &sched->workers[i];
+			mc_io_cleanup(&worker->mc_io);
+			pthread_mutex_destroy(&worker->queue.lock);
+		}
+
+		free(sched->workers);
+		sched->workers = NULL;
+		sched->num_workers = 0;
+	}
+
+	if (mc_io->debug)
+		fprintf(stderr, "DBG: %s: %u worker(s) for %u MC portal(s)\n",
+			__func__, sched->num_workers, num_portals);
+out:
+	*sched_out = sched;
+	return 0;
+err:
+	pthread_cond_destroy(&sched->done_cond);
+	pthread_cond_destroy(&sched->work_cond);
+	pthread_mutex_destroy(&sched->lock);
+	free(sched);
+	return error;
+}
+
+int mc_sched_submit(struct mc_sched *sched, mc_task_fn_t *fn, void *arg)
+{
+	struct mc_task task = { .fn = fn, .arg = arg };
+	struct mc_worker *worker;
+	int error;
+
+	if (sched->num_workers == 0) {
+		error = fn(sched->mc_io, arg);
+		if (error < 0 && sched->first_error == 0)
+			sched->first_error = error;
+		return 0;
+	}
+
+	worker = &sched->workers[sched->next_worker];
+	sched->next_worker = (sched->next_worker + 1) % sched->num_workers;
+
+	pthread_mutex_lock(&sched->lock);
+	sched->num_pending++;
+	sched->num_queued++;
+	pthread_mutex_unlock(&sched->lock);
+
+	error = queue_push(&worker->queue, &task);
+
+	pthread_mutex_lock(&sched->lock);
+	if (error < 0) {
+		sched->num_pending--;
+		sched->num_queued--;
+	} else {
+		pthread_cond_signal(&sched->work_cond);
+	}
+	pthread_mutex_unlock(&sched->lock);
+
+	return error;
+}
+
+int mc_sched_wait(struct mc_sched *sched)
+{
+	int error;
+
+	pthread_mutex_lock(&sched->lock);
+	while (sched->num_pending != 0)
+		pthread_cond_wait(&sched->done_cond, &sched->lock);
+	error = sched->first_error;
+	sched->first_error = 0;
+	pthread_mutex_unlock(&sched->lock);
+
+	return error;
+}
+
+void mc_sched_destroy(struct mc_sched *sched)
+{
+	if (sched == NULL)
+		return;
+
+	(void)mc_sched_wait(sched);
+	stop_workers(sched, sched->num_workers);
+	pthread_cond_destroy(&sched->done_cond);
+	pthread_cond_destroy(&sched->work_cond);
+	pthread_mutex_destroy(&sched->lock);
+	free(sched->workers);
+	free(sched);
+}
@@ -0,0 +1,82 @@
+/* Copyright 2026 NXP
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * * Neither the name of the above-listed copyright holders nor the
+ * names of any contributors may be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ *
+ * ALTERNATIVELY, this software may be distributed under the terms of the
+ * GNU General Public License ("GPL") as published by the Free Software
+ * Foundation, either version 2 of that License or (at your option) any
+ * later version.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _MC_SCHED_H
+#define _MC_SCHED_H
+
+#include <stdbool.h>
+#include "fsl_mc_sys.h"
+
+/**
+ * Maximum number of MC portals (and worker threads) of a scheduler
+ */
+#define MC_SCHED_MAX_WORKERS	16
+
+/**
+ * Task run by a scheduler worker. 'mc_io' is the portal owned by the
+ * worker: MC object handles are only valid on the portal they were opened
+ * on, so a task opens and closes the objects it needs on 'mc_io'.
+ * A negative return value is reported by mc_sched_wait().
+ */
+typedef int mc_task_fn_t(struct fsl_mc_io *mc_io, void *arg);
+
+struct mc_sched;
+
+/**
+ * Create a scheduler running tasks on up to 'num_portals' MC portals
+ * opened on 'device_file', each owned by one worker thread, with at most
+ * 'max_in_flight' tasks running at the same time (0 means no limit beyond
+ * the number of portals).
+ *
+ * With a single portal no thread is created and tasks run synchronously,
+ * in submission order, on 'mc_io'.
+ */
+int mc_sched_create(struct mc_sched **sched,
+		    struct fsl_mc_io *mc_io,
+		    const char *device_file,
+		    unsigned int num_portals,
+		    unsigned int max_in_flight);
+
+int mc_sched_submit(struct mc_sched *sched, mc_task_fn_t *fn, void *arg);
+
+/**
+ * Wait for all the submitted tasks to complete and return the error of
+ * the first failed one, if any
+ */
+int mc_sched_wait(struct mc_sched *sched);
+
+/**
+ * Wait for the submitted tasks, stop the workers and close their portals
+ */
+void mc_sched_destroy(struct mc_sched *sched);
+
+#endif /* _MC_SCHED_H */
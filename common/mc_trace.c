@@ -0,0 +1,312 @@
+/* Copyright 2026 NXP
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * * Neither the name of the above-listed copyright holders nor the
+ * names of any contributors may be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ *
+ * ALTERNATIVELY, this software may be distributed under the terms of the
+ * GNU General Public License ("GPL") as published by the Free Software
+ * Foundation, either version 2 of that License or (at your option) any
+ * later version.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * MC command tracing. Commands are decoded generically from their header:
+ * the flags and the status sit at the same place in the v9 and the v10
+ * encodings, the command id and the token are read with the header layout
+ * of the MC firmware version. Tokens are mapped back to the objects they
+ * were opened on by watching the open commands.
+ */
+#include <endian.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include "mc_trace.h"
+#include "utils.h"
+
+#define MC_TRACE_LINE_SIZE	1024
+#define MC_TRACE_MAX_TOKENS	64
+#define MC_TRACE_NAME_SIZE	32
+
+struct mc_cmd_desc {
+	uint16_t cmd_id;
+	const char *name;
+};
+
+/**
+ * Object open commands: the command id identifies the object type
+ */
+static const struct mc_cmd_desc mc_open_cmds[] = {
+	{ 0x801, "dpni" },
+	{ 0x802, "dpsw" },
+	{ 0x803, "dpio" },
+	{ 0x804, "dpbp" },
+	{ 0x805, "dprc" },
+	{ 0x806, "dpdmux" },
+	{ 0x807, "dpci" },
+	{ 0x808, "dpcon" },
+	{ 0x809, "dpseci" },
+	{ 0x80a, "dpaiop" },
+	{ 0x80b, "dpmcp" },
+	{ 0x80c, "dpmac" },
+	{ 0x80d, "dpdcei" },
+	{ 0x80e, "dpdmai" },
+	{ 0x80f, "dpdbg" },
+	{ 0x810, "dprtc" },
+};
+
+/**
+ * Commands sharing the same id for all object types
+ */
+static const struct mc_cmd_desc mc_common_cmds[] = {
+	{ 0x800, "close" },
+	{ 0x002, "enable" },
+	{ 0x003, "disable" },
+	{ 0x004, "get_attributes" },
+	{ 0x005, "reset" },
+	{ 0x006, "is_enabled" },
+	{ 0x830, "get_container_id" },
+	{ 0x831, "get_mc_version" },
+};
+
+/**
+ * Container commands, the most frequent ones issued by restool
+ */
+static const struct mc_cmd_desc mc_dprc_cmds[] = {
+	{ 0x151, "create_container" },
+	{ 0x152, "destroy_container" },
+	{ 0x157, "assign" },
+	{ 0x158, "unassign" },
+	{ 0x159, "get_obj_count" },
+	{ 0x15a, "get_obj" },
+	{ 0x15b, "get_res_count" },
+	{ 0x15c, "get_res_ids" },
+	{ 0x161, "set_obj_label" },
+	{ 0x167, "connect" },
+	{ 0x168, "disconnect" },
+	{ 0x169, "get_pool" },
+	{ 0x16a, "get_pool_count" },
+	{ 0x16b, "set_locked" },
+	{ 0x16c, "get_connection" },
+	{ 0x16d, "get_mem" },
+};
+
+struct mc_token_entry {
+	int fd;
+	uint16_t token;
+	const char *obj_type;
+	uint32_t obj_id;
+};
+
+static FILE *trace_file;
+static pthread_mutex_t trace_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct mc_token_entry trace_tokens[MC_TRACE_MAX_TOKENS];
+static unsigned int trace_num_tokens;
+static unsigned long trace_seq;
+
+/**
+ * The v10 header holds a 16 bit token and the command id followed by its
+ * 4 bit version, the v9 header a 10 bit token and a 12 bit command id.
+ * Before the MC version is known only get_mc_version is sent, which has
+ * no token and the same command id in both.
+ */
+static void decode_header(const struct mc_command *cmd, uint16_t *cmd_id,
+			  uint16_t *token)
+{
+	const struct mc_cmd_header *hdr =
+		(const struct mc_cmd_header *)&cmd->header;
+
+	if (restool.mc_fw_version.major == MC_FW_VERSION_9) {
+		mc_trace_decode_v9(le64toh(cmd->header), cmd_id, token);
+		return;
+	}
+
+	*cmd_id = le16toh(hdr->cmd_id) >> 4;
+	*token = le16toh(hdr->token);
+}
+
+static const char *find_cmd_name(const struct mc_cmd_desc *descs,
+				 unsigned int num_descs, uint16_t cmd_id)
+{
+	for (unsigned int i = 0; i < num_descs; i++)
+		if (descs[i].cmd_id == cmd_id)
+			return descs[i].name;
+
+	return NULL;
+}
+
+#define FIND_CMD_NAME(_descs, _cmd_id) \
+	find_cmd_name(_descs, sizeof(_descs) / sizeof((_descs)[0]), _cmd_id)
+
+/**
+ * Must be called with trace_lock held
+ */
+static struct mc_token_entry *find_token(int fd, uint16_t token)
+{
+	for (unsigned int i = 0; i < trace_num_tokens; i++)
+		if (trace_tokens[i].fd == fd && trace_tokens[i].token == token)
+			return &trace_tokens[i];
+
+	return NULL;
+}
+
+/**
+ * Must be called with trace_lock held
+ */
+static void track_token(int fd, uint16_t cmd_id, uint16_t token,
+			const struct mc_command *cmd,
+			const struct mc_command *rsp, int error)
+{
+	struct mc_token_entry *entry;
+	const char *obj_type;
+	uint16_t rsp_cmd_id;
+
+	if (error < 0)
+		return;
+
+	if (cmd_id == 0x800) {
+		entry = find_token(fd, token);
+		if (entry)
+			*entry = trace_tokens[--trace_num_tokens];
+		return;
+	}
+
+	obj_type = FIND_CMD_NAME(mc_open_cmds, cmd_id);
+	if (!obj_type)
+		return;
+
+	/* the token of the opened object is returned in the header */
+	decode_header(rsp, &rsp_cmd_id, &token);
+	entry = find_token(fd, token);
+	if (!entry) {
+		if (trace_num_tokens == MC_TRACE_MAX_TOKENS)
+			trace_num_tokens--;
+		entry = &trace_tokens[trace_num_tokens++];
+	}
+
+	entry->fd = fd;
+	entry->token = token;
+	entry->obj_type = obj_type;
+	entry->obj_id = (uint32_t)le64toh(cmd->params[0]);
+}
+
+static int print_params(char *buf, size_t size, const uint64_t *params)
+{
+	int last = MC_CMD_NUM_OF_PARAMS - 1;
+	int n = 0;
+
+	while (last >= 0 && params[last] == 0)
+		last--;
+
+	for (int i = 0; i <= last && (size_t)n < size; i++)
+		n += snprintf(buf + n, size - n, " %016" PRIx64,
+			      le64toh(params[i]));
+
+	return n;
+}
+
+static void mc_trace_cmd(struct fsl_mc_io *mc_io,
+			 const struct mc_command *cmd,
+			 const struct mc_command *rsp,
+			 int error,
+			 uint64_t duration_us)
+{
+	uint64_t header = le64toh(cmd->header);
+	uint16_t cmd_id, token;
+	uint8_t flags_hw = (uint8_t)(header >> 8);
+	uint8_t flags_sw = (uint8_t)(header >> 24);
+	uint8_t status = (uint8_t)(le64toh(rsp->header) >> 16);
+	struct mc_token_entry *entry;
+	char line[MC_TRACE_LINE_SIZE];
+	char open_name[MC_TRACE_NAME_SIZE];
+	const char *cmd_name, *obj_type;
+	size_t n;
+
+	pthread_mutex_lock(&trace_lock);
+	if (!trace_file)
+		goto out;
+
+	decode_header(cmd, &cmd_id, &token);
+	cmd_name = FIND_CMD_NAME(mc_common_cmds, cmd_id);
+	obj_type = FIND_CMD_NAME(mc_open_cmds, cmd_id);
+	if (obj_type) {
+		snprintf(open_name, sizeof(open_name), "%s_open", obj_type);
+		cmd_name = open_name;
+	}
+	entry = find_token(mc_io->fd, token);
+	if (!cmd_name && entry && strcmp(entry->obj_type, "dprc") == 0)
+		cmd_name = FIND_CMD_NAME(mc_dprc_cmds, cmd_id);
+
+	n = snprintf(line, sizeof(line),
+		     "mc-trace: #%lu fd=%d cmd=0x%03x %s token=0x%04x",
+		     ++trace_seq, mc_io->fd, cmd_id,
+		     cmd_name ? cmd_name : "-", token);
+	if (entry)
+		n += snprintf(line + n, sizeof(line) - n, " (%s.%u)",
+			      entry->obj_type, entry->obj_id);
+	n += snprintf(line + n, sizeof(line) - n,
+		      " flags=0x%02x/0x%02x status=0x%02x error=%d time=%" PRIu64 "us\n"
+		      "  cmd:",
+		      flags_hw, flags_sw, status, error, duration_us);
+	n += print_params(line + n, sizeof(line) - n, cmd->params);
+	n += snprintf(line + n, sizeof(line) - n, "\n  rsp:");
+	n += print_params(line + n, sizeof(line) - n, rsp->params);
+	snprintf(line + n, sizeof(line) - n, "\n");
+
+	fputs(line, trace_file);
+	track_token(mc_io->fd, cmd_id, token, cmd, rsp, error);
+out:
+	pthread_mutex_unlock(&trace_lock);
+}
+
+int mc_trace_start(struct fsl_mc_io *mc_io, const char *path)
+{
+	FILE *file = stderr;
+
+	if (path) {
+		file = fopen(path, "w");
+		if (!file)
+			return -errno;
+	}
+
+	pthread_mutex_lock(&trace_lock);
+	trace_file = file;
+	pthread_mutex_unlock(&trace_lock);
+
+	mc_io->trace = mc_trace_cmd;
+	return 0;
+}
+
+void mc_trace_stop(struct fsl_mc_io *mc_io)
+{
+	mc_io->trace = NULL;
+
+	pthread_mutex_lock(&trace_lock);
+	if (trace_file && trace_file != stderr)
+		fclose(trace_file);
+	trace_file = NULL;
+	trace_num_tokens = 0;
+	pthread_mutex_unlock(&trace_lock);
+}
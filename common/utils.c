@@ -0,0 +1,158 @@
+/* Copyright 2026 NXP
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * * Neither the name of the above-listed copyright holders nor the
+ * names of any contributors may be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ *
+ * ALTERNATIVELY, this software may be distributed under the terms of the
+ * GNU General Public License ("GPL") as published by the Free Software
+ * Foundation, either version 2 of that License or (at your option) any
+ * later version.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include "utils.h"
+
+void print_stat_value(double value)
+{
+	static const char units[] = " kMGTP";
+	unsigned int unit = 0;
+
+	if (value < 1e7) {
+		printf(" %9.0f", value);
+		return;
+	}
+
+	while (value >= 1000 && unit < sizeof(units) - 2) {
+		value /= 1000;
+		unit++;
+	}
+	printf(" %8.1f%c", value, units[unit]);
+}
+
+double timespec_elapsed(const struct timespec *from,
+			const struct timespec *to)
+{
+	return (to->tv_sec - from->tv_sec) +
+	       (to->tv_nsec - from->tv_nsec) / 1e9;
+}
+
+static volatile sig_atomic_t watch_interrupted;
+
+static void watch_sigint(int sig)
+{
+	(void)sig;
+	watch_interrupted = 1;
+}
+
+int get_watch_options(struct watch *watch, int interval_opt, int count_opt,
+		      int duration_opt)
+{
+	bool repeat = false;
+	bool counted = false;
+	long value;
+	int error;
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(interval_opt)) {
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(interval_opt);
+		error = get_option_value(interval_opt, &value,
+					 "Invalid sampling interval", 10,
+					 3600 * 1000);
+		if (error)
+			return -EINVAL;
+		watch->interval_ms = (unsigned int)value;
+		repeat = true;
+	}
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(count_opt)) {
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(count_opt);
+		error = get_option_value(count_opt, &value,
+					 "Invalid count", 0, INT32_MAX);
+		if (error)
+			return -EINVAL;
+		watch->count = (unsigned int)value;
+		counted = true;
+	}
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(duration_opt)) {
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(duration_opt);
+		error = get_option_value(duration_opt, &value,
+					 "Invalid duration", 0, INT32_MAX);
+		if (error)
+			return -EINVAL;
+		watch->duration_s = (unsigned int)value;
+		repeat = true;
+	}
+
+	if (repeat && !counted)
+		watch->count = 0;
+
+	return repeat || counted;
+}
+
+void watch_start(struct watch *watch)
+{
+	struct sigaction sa = { .sa_handler = watch_sigint };
+
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGINT, &sa, &watch->old_sa);
+	watch_interrupted = 0;
+
+	watch->samples = 0;
+	clock_gettime(CLOCK_MONOTONIC, &watch->start);
+	watch->last = watch->start;
+	watch->now = watch->start;
+}
+
+bool watch_next(struct watch *watch)
+{
+	struct timespec interval = {
+		.tv_sec = watch->interval_ms / 1000,
+		.tv_nsec = (watch->interval_ms % 1000) * 1000000L,
+	};
+
+	if (watch->count && watch->samples >= watch->count)
+		return false;
+
+	if (watch->duration_s &&
+	    timespec_elapsed(&watch->start, &watch->now) >= watch->duration_s)
+		return false;
+
+	/* only SIGINT ends the wait early, other signals resume it */
+	while (!watch_interrupted && nanosleep(&interval, &interval) != 0 &&
+	       errno == EINTR)
+		;
+
+	if (watch_interrupted)
+		return false;
+
+	watch->last = watch->now;
+	clock_gettime(CLOCK_MONOTONIC, &watch->now);
+	watch->samples++;
+	return true;
+}
+
+void watch_stop(struct watch *watch)
+{
+	sigaction(SIGINT, &watch->old_sa, NULL);
+}
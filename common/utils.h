@@ -37,6 +37,7 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <time.h>
+#include <signal.h>
 #include "../restool.h"
 
 #define C_ASSERT(_cond) \
@@ -78,4 +79,56 @@ do { \
 
 void diff_time(struct timespec *, struct timespec *, struct timespec *);
 
+/**
+ * Print a counter or a rate right aligned in a column of 10 characters,
+ * with a k/M/G/T/P suffix once it does not fit
+ */
+void print_stat_value(double value);
+
+/**
+ * Seconds from one CLOCK_MONOTONIC reading to a later one
+ */
+double timespec_elapsed(const struct timespec *from,
+			const struct timespec *to);
+
+/**
+ * Repeated sampling for the commands that watch counters or states: a
+ * first sample right away, then one every interval_ms until count more
+ * samples were taken, duration_s have passed or SIGINT. A zero count or
+ * duration_s is no limit.
+ */
+struct watch {
+	unsigned int interval_ms;
+	unsigned int count;
+	unsigned int duration_s;
+	unsigned int samples;
+	struct timespec start;
+	struct timespec last;
+	struct timespec now;
+	struct sigaction old_sa;
+};
+
+/**
+ * Parse the interval in ms (--interval, or --watch for the commands which
+ * sample once by default), --count=<n> and --duration=<seconds> into a
+ * watch holding the defaults of the command. The interval or --duration
+ * without --count lifts the default count. Returns 1 if any of them was
+ * given, 0 if none was, or -EINVAL.
+ */
+int get_watch_options(struct watch *watch, int interval_opt, int count_opt,
+		      int duration_opt);
+
+/**
+ * Catch SIGINT until watch_stop() and take the first sample time
+ */
+void watch_start(struct watch *watch);
+
+/**
+ * Wait for the next sample and update last and now, or return false once
+ * the watch is over
+ */
+bool watch_next(struct watch *watch);
+
+void watch_stop(struct watch *watch);
+
 #endif /* _UTILS_H */
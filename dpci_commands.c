@@ -213,7 +213,7 @@ static int print_dpci_attr_v9(uint32_t dpci_id,
 		goto out;
 	}
 
-	error = dpci_get_link_state(&restool.mc_io, 0, dpci_handle,
+	error = dpci_get_link_state(&restool.mc_io, LINK_LANE, dpci_handle,
 					&link_state);
 	if (error < 0) {
 		mc_status = flib_error_to_mc_status(error);
@@ -309,7 +309,7 @@ static int print_dpci_attr_v10(uint32_t dpci_id,
 		goto out;
 	}
 
-	error = dpci_get_link_state_v10(&restool.mc_io, 0, dpci_handle,
+	error = dpci_get_link_state_v10(&restool.mc_io, LINK_LANE, dpci_handle,
 					&link_state);
 	if (error) {
 		mc_status = flib_error_to_mc_status(error);
@@ -37,6 +37,7 @@
 #include <errno.h>
 #include <assert.h>
 #include <getopt.h>
+#include <time.h>
 #include "restool.h"
 #include "utils.h"
 #include "mc_v10/fsl_dpdbg.h"
@@ -185,6 +186,63 @@ static struct option dpdbg_destroy_options[] = {
 C_ASSERT(ARRAY_SIZE(dpdbg_destroy_options) <= MAX_NUM_CMD_LINE_OPTIONS + 1);
 
 
+enum dpdbg_profile_options {
+	PROFILE_OPT_HELP = 0,
+	PROFILE_OPT_CTLU,
+	PROFILE_OPT_TABLE_ID,
+	PROFILE_OPT_INTERVAL,
+	PROFILE_OPT_COUNT,
+	PROFILE_OPT_DURATION,
+};
+
+static struct option dpdbg_profile_options[] = {
+	[PROFILE_OPT_HELP] = {
+		.name = "help",
+		.has_arg = 0,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[PROFILE_OPT_CTLU] = {
+		.name = "ctlu",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[PROFILE_OPT_TABLE_ID] = {
+		.name = "table-id",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[PROFILE_OPT_INTERVAL] = {
+		.name = "interval",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[PROFILE_OPT_COUNT] = {
+		.name = "count",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[PROFILE_OPT_DURATION] = {
+		.name = "duration",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	{ 0 },
+};
+
+C_ASSERT(ARRAY_SIZE(dpdbg_profile_options) <= MAX_NUM_CMD_LINE_OPTIONS + 1);
+
 static int cmd_dpdbg_help(void)
 {
 	static const char help_msg[] =
@@ -197,6 +255,7 @@ static int cmd_dpdbg_help(void)
 		"    destroy - destroy DPDBG object.\n"
 		"    dump - displays in MC console information about MC objects or memory usage.\n"
 		"    set - set MC modules on or off.\n"
+		"    profile - samples the profiling counters of a lookup engine.\n"
 		"\n"
 		"For command-specific help, use the --help option of each command.\n"
 		"\n";
@@ -647,6 +706,315 @@ static int cmd_dpdbg_set(void)
 	return error;
 }
 
+static const struct {
+	const char *name;
+	uint8_t type;
+} ctlu_types[] = {
+	{ "eiop-egress", DBG_CTLU_EIOP_EGRESS },
+	{ "eiop-ingress", DBG_CTLU_EIOP_INGRESS },
+	{ "aiop", DBG_CTLU_AIOP },
+	{ "aiop-mflu", DBG_CTLU_AIOP_MFLU },
+};
+
+/* counters are 32 bits wide and wrap around */
+static void ctlu_counters_delta(const struct ctlu_profiling_counters *cur,
+				const struct ctlu_profiling_counters *prev,
+				struct ctlu_profiling_counters *delta)
+{
+	delta->rule_lookups = cur->rule_lookups - prev->rule_lookups;
+	delta->rule_hits = cur->rule_hits - prev->rule_hits;
+	delta->entry_lookups = cur->entry_lookups - prev->entry_lookups;
+	delta->entry_hits = cur->entry_hits - prev->entry_hits;
+	delta->cache_accesses = cur->cache_accesses - prev->cache_accesses;
+	delta->cache_hits = cur->cache_hits - prev->cache_hits;
+	delta->cache_updates = cur->cache_updates - prev->cache_updates;
+	delta->memory_accesses = cur->memory_accesses - prev->memory_accesses;
+}
+
+/* the counters over a whole run, which may count past 32 bits */
+struct ctlu_counters_total {
+	uint64_t rule_lookups;
+	uint64_t rule_hits;
+	uint64_t entry_lookups;
+	uint64_t entry_hits;
+	uint64_t cache_accesses;
+	uint64_t cache_hits;
+	uint64_t cache_updates;
+	uint64_t memory_accesses;
+};
+
+static void ctlu_counters_add(struct ctlu_counters_total *total,
+			      const struct ctlu_profiling_counters *delta)
+{
+	total->rule_lookups += delta->rule_lookups;
+	total->rule_hits += delta->rule_hits;
+	total->entry_lookups += delta->entry_lookups;
+	total->entry_hits += delta->entry_hits;
+	total->cache_accesses += delta->cache_accesses;
+	total->cache_hits += delta->cache_hits;
+	total->cache_updates += delta->cache_updates;
+	total->memory_accesses += delta->memory_accesses;
+}
+
+static double ratio(uint64_t part, uint64_t total)
+{
+	return total ? 100.0 * part / total : 0.0;
+}
+
+static void print_ctlu_sample(const char *when, double secs,
+			      uint64_t rule_lookups, uint64_t rule_hits,
+			      uint64_t entry_lookups, uint64_t entry_hits,
+			      uint64_t cache_accesses, uint64_t cache_hits,
+			      uint64_t cache_updates, uint64_t memory_accesses)
+{
+	if (secs <= 0)
+		secs = 1;
+
+	printf("%8s %12.0f %6.1f%% %12.0f %6.1f%% %12.0f %6.1f%% %12.0f %12.0f\n",
+	       when, rule_lookups / secs, ratio(rule_hits, rule_lookups),
+	       entry_lookups / secs, ratio(entry_hits, entry_lookups),
+	       cache_accesses / secs,
+	       ratio(cache_accesses - cache_hits, cache_accesses),
+	       cache_updates / secs, memory_accesses / secs);
+}
+
+/**
+ * Sample the profiling counters of a CTLU on every interval of the watch
+ * and print the lookup rates, the hit ratios and the cache miss rate of
+ * each interval, then the same over the whole run
+ */
+static int profile(uint8_t ctlu_type, struct ctlu_profiling_options *opts,
+		   struct watch *watch)
+{
+	struct ctlu_profiling_counters prev, cur, delta;
+	struct ctlu_counters_total total = { 0 };
+	struct timespec end;
+	uint32_t dpdbg_id = 0;
+	uint16_t dpdbg_handle = 0;
+	bool profiling = false;
+	bool dpdbg_opened = false;
+	char when[16];
+	int error = 0;
+
+	error = dpdbg_open_v10(&restool.mc_io, 0, dpdbg_id, &dpdbg_handle);
+	if (error < 0) {
+		mc_status = flib_error_to_mc_status(error);
+		ERROR_PRINTF("MC error: %s (status %#x)\n",
+				mc_status_to_string(mc_status), mc_status);
+		goto out;
+	}
+	dpdbg_opened = true;
+
+	if (dpdbg_handle == 0) {
+		DEBUG_PRINTF("dpdbg_open() returned invalid handle (auth 0)\n");
+		error = -ENOENT;
+		goto out;
+	}
+
+	error = dpdbg_set_ctlu_profiling_counters(&restool.mc_io, 0,
+						  dpdbg_handle, ctlu_type,
+						  opts);
+	if (error < 0) {
+		mc_status = flib_error_to_mc_status(error);
+		ERROR_PRINTF("MC error: %s (status %#x)\n",
+				mc_status_to_string(mc_status), mc_status);
+		goto out;
+	}
+	profiling = true;
+
+	error = dpdbg_get_ctlu_profiling_counters(&restool.mc_io, CNT_LANE,
+						  dpdbg_handle, ctlu_type,
+						  &prev);
+	if (error < 0) {
+		mc_status = flib_error_to_mc_status(error);
+		ERROR_PRINTF("MC error: %s (status %#x)\n",
+				mc_status_to_string(mc_status), mc_status);
+		goto out;
+	}
+
+	watch_start(watch);
+	end = watch->start;
+	printf("%8s %12s %7s %12s %7s %12s %7s %12s %12s\n", "time",
+	       "rule-lkp/s", "hit", "entry-lkp/s", "hit", "cache-acc/s",
+	       "miss", "cache-upd/s", "mem-acc/s");
+	while (watch_next(watch)) {
+		error = dpdbg_get_ctlu_profiling_counters(&restool.mc_io,
+							  CNT_LANE,
+							  dpdbg_handle,
+							  ctlu_type, &cur);
+		if (error < 0) {
+			mc_status = flib_error_to_mc_status(error);
+			ERROR_PRINTF("MC error: %s (status %#x)\n",
+					mc_status_to_string(mc_status),
+					mc_status);
+			break;
+		}
+
+		ctlu_counters_delta(&cur, &prev, &delta);
+		ctlu_counters_add(&total, &delta);
+		snprintf(when, sizeof(when), "%.1f",
+			 timespec_elapsed(&watch->start, &watch->now));
+		print_ctlu_sample(when,
+				  timespec_elapsed(&watch->last, &watch->now),
+				  delta.rule_lookups, delta.rule_hits,
+				  delta.entry_lookups, delta.entry_hits,
+				  delta.cache_accesses, delta.cache_hits,
+				  delta.cache_updates, delta.memory_accesses);
+		fflush(stdout);
+		prev = cur;
+		end = watch->now;
+	}
+
+	watch_stop(watch);
+
+	print_ctlu_sample("total", timespec_elapsed(&watch->start, &end),
+			  total.rule_lookups, total.rule_hits,
+			  total.entry_lookups, total.entry_hits,
+			  total.cache_accesses, total.cache_hits,
+			  total.cache_updates, total.memory_accesses);
+out:
+	if (profiling) {
+		int error2;
+
+		/* leave the CTLU as it was before: not profiling */
+		opts->enable_profiling_counters = 0;
+		opts->enable_profiling_for_tid = 0;
+		error2 = dpdbg_set_ctlu_profiling_counters(&restool.mc_io, 0,
+							   dpdbg_handle,
+							   ctlu_type, opts);
+		if (error2 < 0) {
+			mc_status = flib_error_to_mc_status(error2);
+			ERROR_PRINTF("MC error: %s (status %#x)\n",
+					mc_status_to_string(mc_status),
+					mc_status);
+			if (error == 0)
+				error = error2;
+		}
+	}
+
+	if (dpdbg_opened) {
+		int error2;
+
+		error2 = dpdbg_close_v10(&restool.mc_io, 0, dpdbg_handle);
+		if (error2 < 0) {
+			mc_status = flib_error_to_mc_status(error2);
+			ERROR_PRINTF("MC error: %s (status %#x)\n",
+					mc_status_to_string(mc_status),
+					mc_status);
+			if (error == 0)
+				error = error2;
+		}
+	}
+
+	return error;
+}
+
+static int cmd_dpdbg_profile(void)
+{
+	static const char usage_msg[] =
+		"\n"
+		"Usage: restool dpdbg profile --ctlu=<type> [--table-id=<id>]\n"
+		"		[--interval=<ms>] [--count=<n>] [--duration=<seconds>]\n"
+		"Samples the profiling counters of a lookup engine and prints, per\n"
+		"interval, the rule and entry lookups per second with their hit\n"
+		"ratio, the cache accesses per second with their miss ratio, the\n"
+		"cache updates and the memory accesses per second.\n"
+		"where:\n"
+		"    ctlu - eiop-egress, eiop-ingress, aiop or aiop-mflu\n"
+		"    table-id - only profile the lookups of this table\n"
+		"    interval - sampling period in milliseconds, 1000 by default\n"
+		"    count - stop after this many intervals\n"
+		"    duration - stop after this many seconds, 10 by default,\n"
+		"               0 runs until interrupted\n"
+		"Profiling is turned off again when the command ends.\n"
+		"\n"
+		"EXAMPLE:\n"
+		"Profile the ingress classification for a minute:\n"
+		"   $ restool dpdbg profile --ctlu=eiop-ingress --duration=60\n"
+		"\n";
+
+	struct ctlu_profiling_options opts = {
+		.enable_profiling_counters = 1,
+	};
+	struct dprc_obj_desc target_obj_desc;
+	uint32_t target_parent_dprc_id;
+	struct watch watch = {
+		.interval_ms = 1000,
+		.duration_s = 10,
+	};
+	bool found = false;
+	uint32_t dpdbg_id = 0;
+	int ctlu_type = -1;
+	long value;
+	int error;
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(PROFILE_OPT_HELP)) {
+		puts(usage_msg);
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(PROFILE_OPT_HELP);
+		return 0;
+	}
+
+	if (restool.obj_name != NULL) {
+		ERROR_PRINTF("Unexpected argument: \'%s\'\n\n",
+				restool.obj_name);
+		puts(usage_msg);
+		return -EINVAL;
+	}
+
+	if (!(restool.cmd_option_mask & ONE_BIT_MASK(PROFILE_OPT_CTLU))) {
+		ERROR_PRINTF("--ctlu option missing\n");
+		puts(usage_msg);
+		return -EINVAL;
+	}
+
+	restool.cmd_option_mask &= ~ONE_BIT_MASK(PROFILE_OPT_CTLU);
+	for (unsigned int i = 0; i < ARRAY_SIZE(ctlu_types); i++)
+		if (strcmp(restool.cmd_option_args[PROFILE_OPT_CTLU],
+			   ctlu_types[i].name) == 0)
+			ctlu_type = ctlu_types[i].type;
+
+	if (ctlu_type < 0) {
+		ERROR_PRINTF("Invalid CTLU type: %s\n",
+				restool.cmd_option_args[PROFILE_OPT_CTLU]);
+		puts(usage_msg);
+		return -EINVAL;
+	}
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(PROFILE_OPT_TABLE_ID)) {
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(PROFILE_OPT_TABLE_ID);
+		error = get_option_value(PROFILE_OPT_TABLE_ID, &value,
+					 "Invalid table id", 0, UINT16_MAX);
+		if (error)
+			return -EINVAL;
+		opts.enable_profiling_for_tid = 1;
+		opts.table_id = (uint16_t)value;
+	}
+
+	error = get_watch_options(&watch, PROFILE_OPT_INTERVAL,
+				  PROFILE_OPT_COUNT, PROFILE_OPT_DURATION);
+	if (error < 0)
+		return error;
+
+	memset(&target_obj_desc, 0, sizeof(struct dprc_obj_desc));
+	error = find_target_obj_desc(restool.root_dprc_id,
+					restool.root_dprc_handle,
+					0,
+					dpdbg_id,
+					"dpdbg",
+					&target_obj_desc,
+					&target_parent_dprc_id,
+					&found);
+	if (error < 0)
+		return error;
+
+	if (strcmp(target_obj_desc.type, "dpdbg")) {
+		printf("dpdbg.0 does not exist\n");
+		return -EINVAL;
+	}
+
+	return profile((uint8_t)ctlu_type, &opts, &watch);
+}
+
 static int cmd_dpdbg_destroy(void)
 {
 	static const char usage_msg[] = "\nUsage: restool dpdbg destroy\n\n";
@@ -759,6 +1127,10 @@ struct object_command dpdbg_commands[] = {
 	  .options = dpdbg_set_options,
 	  .cmd_func = cmd_dpdbg_set },
 
+	{ .cmd_name = "profile",
+	  .options = dpdbg_profile_options,
+	  .cmd_func = cmd_dpdbg_profile },
+
 	{ .cmd_name = "create",
 	  .options = dpdbg_create_options,
 	  .cmd_func = cmd_dpdbg_create },
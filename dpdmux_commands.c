@@ -35,6 +35,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
+#include <math.h>
 #include <errno.h>
 #include <assert.h>
 #include <getopt.h>
@@ -192,6 +193,50 @@ static struct option dpdmux_destroy_options[] = {
 
 C_ASSERT(ARRAY_SIZE(dpdmux_destroy_options) <= MAX_NUM_CMD_LINE_OPTIONS + 1);
 
+/**
+ * dpdmux stats command options
+ */
+enum dpdmux_stats_options {
+	STATS_OPT_HELP = 0,
+	STATS_OPT_WATCH,
+	STATS_OPT_COUNT,
+	STATS_OPT_DURATION,
+};
+
+static struct option dpdmux_stats_options[] = {
+	[STATS_OPT_HELP] = {
+		.name = "help",
+		.has_arg = 0,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[STATS_OPT_WATCH] = {
+		.name = "watch",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[STATS_OPT_COUNT] = {
+		.name = "count",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[STATS_OPT_DURATION] = {
+		.name = "duration",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	{ 0 },
+};
+
+C_ASSERT(ARRAY_SIZE(dpdmux_stats_options) <= MAX_NUM_CMD_LINE_OPTIONS + 1);
+
 static struct option_entry options_map[] = {
 	OPTION_MAP_ENTRY(DPDMUX_OPT_BRIDGE_EN),
 	OPTION_MAP_ENTRY(DPDMUX_OPT_CLS_MASK_SUPPORT),
@@ -215,6 +260,7 @@ static int cmd_dpdmux_help(void)
 		"   info - displays detailed information about a DPDMUX object.\n"
 		"   create - creates a new child DPDMUX under the root DPRC.\n"
 		"   destroy - destroys a child DPDMUX under the root DPRC.\n"
+		"   stats - displays the traffic and balance of the interfaces.\n"
 		"\n"
 		"For command-specific help, use the --help option of each command.\n"
 		"\n";
@@ -258,7 +304,7 @@ static int print_dpdmux_endpoint(uint32_t target_id, uint16_t num_ifs,
 		endpoint1.id = target_id;
 		endpoint1.if_id = k;
 
-		error = dprc_get_connection(&restool.mc_io, 0,
+		error = dprc_get_connection(&restool.mc_io, CONN_LANE,
 					restool.root_dprc_handle,
 					&endpoint1,
 					&endpoint2,
@@ -300,7 +346,7 @@ static int print_dpdmux_endpoint(uint32_t target_id, uint16_t num_ifs,
 		printf("\tmax frame length: %hu\n", max_frame_length);
 
 		for (uint32_t i = 0; i < ARRAY_SIZE(dpdmux_counters); ++i) {
-			dpdmux_if_get_counter(&restool.mc_io, 0,
+			dpdmux_if_get_counter(&restool.mc_io, CNT_LANE,
 					token, k, i, &count);
 			printf("\t%s: %" PRIu64 "\n", dpdmux_counters[i], count);
 		}
@@ -1190,6 +1236,275 @@ static int cmd_dpdmux_destroy_v10(void)
 	return destroy_dpdmux(MC_FW_VERSION_10);
 }
 
+#define DPDMUX_NUM_COUNTERS	(DPDMUX_CNT_ING_NO_BUFFER_DISCARD + 1)
+
+C_ASSERT(ARRAY_SIZE(dpdmux_counters) == DPDMUX_NUM_COUNTERS);
+
+/* the counters of one interface, interface 0 being the uplink */
+struct dpdmux_if_stats {
+	uint64_t counters[DPDMUX_NUM_COUNTERS];
+};
+
+static int read_dpdmux_stats(uint16_t token, struct dpdmux_if_stats *ifs,
+			     uint16_t num_ifs)
+{
+	int error;
+
+	for (uint16_t k = 0; k < num_ifs; k++) {
+		for (int c = 0; c < DPDMUX_NUM_COUNTERS; c++) {
+			error = dpdmux_if_get_counter(&restool.mc_io, CNT_LANE,
+						      token, k, c,
+						      &ifs[k].counters[c]);
+			if (error)
+				return error;
+		}
+	}
+
+	return 0;
+}
+
+/* the growth of a counter since the previous sample, or its value */
+static double dpdmux_delta(const struct dpdmux_if_stats *cur,
+			   const struct dpdmux_if_stats *prev, int c)
+{
+	if (!prev)
+		return cur->counters[c];
+
+	return cur->counters[c] >= prev->counters[c] ?
+	       cur->counters[c] - prev->counters[c] : 0;
+}
+
+static double dpdmux_ratio(double part, double whole)
+{
+	return whole > 0 ? 100 * part / whole : 0;
+}
+
+/**
+ * Print one row per interface with its traffic, its drop ratios and, for
+ * the downlinks, their share of the traffic leaving towards them, followed
+ * by how unevenly that traffic is spread. The values are rates per second
+ * when 'prev' is given, the counters themselves otherwise.
+ */
+static void print_dpdmux_stats(const struct dpdmux_if_stats *cur,
+			       const struct dpdmux_if_stats *prev,
+			       uint16_t num_ifs, double secs)
+{
+	double down_frames = 0, max_share = 0, sum_sq = 0, mean, cv;
+	double up_in, up_drop;
+	uint16_t max_if = 1;
+
+	if (!prev)
+		secs = 1;
+
+	for (uint16_t k = 1; k < num_ifs; k++)
+		down_frames += dpdmux_delta(&cur[k], prev ? &prev[k] : NULL,
+					    DPDMUX_CNT_EGR_FRAME);
+
+	printf("%-3s %-8s %9s %9s %9s %9s %9s %9s %7s\n", "if", "role",
+	       "ing-frm", "ing-byte", "egr-frm", "egr-byte", "ing-drop%",
+	       "egr-drop%", "share%");
+
+	for (uint16_t k = 0; k < num_ifs; k++) {
+		const struct dpdmux_if_stats *p = prev ? &prev[k] : NULL;
+		double ing = dpdmux_delta(&cur[k], p, DPDMUX_CNT_ING_FRAME);
+		double egr = dpdmux_delta(&cur[k], p, DPDMUX_CNT_EGR_FRAME);
+		double ing_drop =
+			dpdmux_delta(&cur[k], p, DPDMUX_CNT_ING_FRAME_DISCARD) +
+			dpdmux_delta(&cur[k], p,
+				     DPDMUX_CNT_ING_NO_BUFFER_DISCARD);
+		double egr_drop =
+			dpdmux_delta(&cur[k], p, DPDMUX_CNT_EGR_FRAME_DISCARD);
+
+		printf("%-3u %-8s", k, k == 0 ? "uplink" : "downlink");
+		print_stat_value(ing / secs);
+		print_stat_value(dpdmux_delta(&cur[k], p,
+					       DPDMUX_CNT_ING_BYTE) / secs);
+		print_stat_value(egr / secs);
+		print_stat_value(dpdmux_delta(&cur[k], p,
+					       DPDMUX_CNT_EGR_BYTE) / secs);
+		printf(" %9.2f %9.2f", dpdmux_ratio(ing_drop, ing),
+		       dpdmux_ratio(egr_drop, egr + egr_drop));
+		if (k == 0) {
+			printf(" %7s\n", "-");
+			continue;
+		}
+		printf(" %7.1f\n", dpdmux_ratio(egr, down_frames));
+
+		if (egr > max_share) {
+			max_share = egr;
+			max_if = k;
+		}
+	}
+
+	up_in = dpdmux_delta(&cur[0], prev, DPDMUX_CNT_ING_FRAME);
+	up_drop = dpdmux_delta(&cur[0], prev, DPDMUX_CNT_ING_FRAME_DISCARD) +
+		  dpdmux_delta(&cur[0], prev, DPDMUX_CNT_ING_NO_BUFFER_DISCARD);
+	printf("uplink to downlinks: %.0f frames in, %.0f out, %.2f%% dropped\n",
+	       up_in / secs, down_frames / secs, dpdmux_ratio(up_drop, up_in));
+
+	if (num_ifs < 3 || down_frames == 0)
+		return;
+
+	/* how far the busiest downlink and the spread are from an even split */
+	mean = down_frames / (num_ifs - 1);
+	for (uint16_t k = 1; k < num_ifs; k++) {
+		double egr = dpdmux_delta(&cur[k], prev ? &prev[k] : NULL,
+					  DPDMUX_CNT_EGR_FRAME);
+
+		sum_sq += (egr - mean) * (egr - mean);
+	}
+	cv = sqrt(sum_sq / (num_ifs - 1)) / mean;
+	printf("downlink imbalance: busiest if %u at %.2fx the mean, coefficient of variation %.2f\n",
+	       max_if, max_share / mean, cv);
+}
+
+/**
+ * Print the counters of a DPDMUX and, if repeat, their rates on every
+ * interval of the watch
+ */
+static int dpdmux_stats(uint32_t dpdmux_id, struct watch *watch, bool repeat)
+{
+	struct dpdmux_if_stats *cur = NULL, *prev = NULL, *tmp;
+	struct dpdmux_attr_v10 dpdmux_attr;
+	bool dpdmux_opened = false;
+	uint16_t dpdmux_handle;
+	uint16_t num_ifs;
+	int error, error2;
+
+	error = dpdmux_open_v10(&restool.mc_io, 0, dpdmux_id, &dpdmux_handle);
+	if (error < 0) {
+		mc_status = flib_error_to_mc_status(error);
+		ERROR_PRINTF("MC error: %s (status %#x)\n",
+			     mc_status_to_string(mc_status), mc_status);
+		goto out;
+	}
+	dpdmux_opened = true;
+	if (0 == dpdmux_handle) {
+		DEBUG_PRINTF(
+			"dpdmux_open() returned invalid handle (auth 0) for dpdmux.%u\n",
+			dpdmux_id);
+		error = -ENOENT;
+		goto out;
+	}
+
+	memset(&dpdmux_attr, 0, sizeof(dpdmux_attr));
+	error = dpdmux_get_attributes_v10(&restool.mc_io, 0, dpdmux_handle,
+					  &dpdmux_attr);
+	if (error < 0) {
+		mc_status = flib_error_to_mc_status(error);
+		ERROR_PRINTF("MC error: %s (status %#x)\n",
+			     mc_status_to_string(mc_status), mc_status);
+		goto out;
+	}
+
+	/* the uplink comes on top of the downlinks */
+	num_ifs = dpdmux_attr.num_ifs + 1;
+	cur = calloc(num_ifs, sizeof(*cur));
+	prev = calloc(num_ifs, sizeof(*prev));
+	if (!cur || !prev) {
+		error = -ENOMEM;
+		goto out;
+	}
+
+	watch_start(watch);
+	do {
+		error = read_dpdmux_stats(dpdmux_handle, cur, num_ifs);
+		if (error) {
+			mc_status = flib_error_to_mc_status(error);
+			ERROR_PRINTF("MC error: %s (status %#x)\n",
+				     mc_status_to_string(mc_status), mc_status);
+			break;
+		}
+
+		if (watch->samples == 0) {
+			printf("dpdmux.%u counters:\n", dpdmux_id);
+			print_dpdmux_stats(cur, NULL, num_ifs, 0);
+		} else {
+			double secs = timespec_elapsed(&watch->last, &watch->now);
+
+			printf("\ndpdmux.%u rates per second over %.1f s:\n",
+			       dpdmux_id, secs);
+			print_dpdmux_stats(cur, prev, num_ifs, secs);
+		}
+		fflush(stdout);
+
+		tmp = prev;
+		prev = cur;
+		cur = tmp;
+	} while (repeat && watch_next(watch));
+
+	watch_stop(watch);
+out:
+	free(prev);
+	free(cur);
+	if (dpdmux_opened) {
+		error2 = dpdmux_close_v10(&restool.mc_io, 0, dpdmux_handle);
+		if (error2 < 0) {
+			mc_status = flib_error_to_mc_status(error2);
+			ERROR_PRINTF("MC error: %s (status %#x)\n",
+				     mc_status_to_string(mc_status), mc_status);
+			if (error == 0)
+				error = error2;
+		}
+	}
+
+	return error;
+}
+
+static int cmd_dpdmux_stats_v10(void)
+{
+	static const char usage_msg[] =
+		"\n"
+		"Usage: restool dpdmux stats <dpdmux-object> [--watch=<ms>]\n"
+		"	[--count=<n>] [--duration=<seconds>]\n"
+		"\n"
+		"  Prints the traffic and drop ratios of the uplink (interface 0)\n"
+		"  and of every downlink, the share of the traffic each downlink\n"
+		"  gets and how unevenly it is spread across them.\n"
+		"\n"
+		"OPTIONS:\n"
+		"--watch=<ms>\n"
+		"   Samples the counters again every <ms> milliseconds and\n"
+		"   prints their rate per second, until interrupted\n"
+		"--count=<n>\n"
+		"   Stops after <n> intervals, of 1000 ms without --watch\n"
+		"--duration=<seconds>\n"
+		"   Stops after <seconds>\n"
+		"\n"
+		"EXAMPLE:\n"
+		"Watch the traffic of dpdmux.0 every second:\n"
+		"   $ restool dpdmux stats dpdmux.0 --watch=1000\n"
+		"\n";
+
+	struct watch watch = { .interval_ms = 1000 };
+	uint32_t dpdmux_id;
+	int repeat;
+	int error;
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(STATS_OPT_HELP)) {
+		puts(usage_msg);
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(STATS_OPT_HELP);
+		return 0;
+	}
+
+	if (restool.obj_name == NULL) {
+		ERROR_PRINTF("<object> argument missing\n");
+		puts(usage_msg);
+		return -EINVAL;
+	}
+
+	error = parse_object_name(restool.obj_name, "dpdmux", &dpdmux_id);
+	if (error < 0)
+		return error;
+
+	repeat = get_watch_options(&watch, STATS_OPT_WATCH, STATS_OPT_COUNT,
+				   STATS_OPT_DURATION);
+	if (repeat < 0)
+		return repeat;
+
+	return dpdmux_stats(dpdmux_id, &watch, repeat);
+}
+
 struct object_command dpdmux_commands_v9[] = {
 	{ .cmd_name = "--help",
 	  .options = NULL,
@@ -1227,6 +1542,10 @@ struct object_command dpdmux_commands_v10[] = {
 	  .options = dpdmux_destroy_options,
 	  .cmd_func = cmd_dpdmux_destroy_v10 },
 
+	{ .cmd_name = "stats",
+	  .options = dpdmux_stats_options,
+	  .cmd_func = cmd_dpdmux_stats_v10 },
+
 	{ .cmd_name = NULL },
 };
 
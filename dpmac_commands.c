@@ -38,9 +38,12 @@
 #include <errno.h>
 #include <assert.h>
 #include <getopt.h>
+#include <time.h>
 #include <sys/ioctl.h>
 #include "restool.h"
 #include "utils.h"
+#include "mc_sched.h"
+#include "obj_index.h"
 #include "mc_v9/fsl_dpmac.h"
 #include "mc_v10/fsl_dpmac.h"
 
@@ -130,6 +133,74 @@ static struct option dpmac_destroy_options[] = {
 
 C_ASSERT(ARRAY_SIZE(dpmac_destroy_options) <= MAX_NUM_CMD_LINE_OPTIONS + 1);
 
+/**
+ * dpmac stats command options
+ */
+enum dpmac_stats_options {
+	STATS_OPT_HELP = 0,
+	STATS_OPT_ALL,
+	STATS_OPT_WATCH,
+	STATS_OPT_COUNT,
+	STATS_OPT_DURATION,
+	STATS_OPT_THRESHOLD,
+	STATS_OPT_JSON,
+};
+
+static struct option dpmac_stats_options[] = {
+	[STATS_OPT_HELP] = {
+		.name = "help",
+		.has_arg = 0,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[STATS_OPT_ALL] = {
+		.name = "all",
+		.has_arg = 0,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[STATS_OPT_WATCH] = {
+		.name = "watch",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[STATS_OPT_COUNT] = {
+		.name = "count",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[STATS_OPT_DURATION] = {
+		.name = "duration",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[STATS_OPT_THRESHOLD] = {
+		.name = "threshold",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[STATS_OPT_JSON] = {
+		.name = "json",
+		.has_arg = 0,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	{ 0 },
+};
+
+C_ASSERT(ARRAY_SIZE(dpmac_stats_options) <= MAX_NUM_CMD_LINE_OPTIONS + 1);
+
 const struct flib_ops dpmac_ops = {
 	.obj_open = dpmac_open_v10,
 	.obj_close = dpmac_close_v10,
@@ -146,6 +217,7 @@ static int cmd_dpmac_help(void)
 		"   info - displays detailed information about a DPMAC object.\n"
 		"   create - creates a new child DPMAC under the root DPRC.\n"
 		"   destroy - destroys a child DPMAC under the root DPRC.\n"
+		"   stats - samples the traffic and error rates of DPMACs.\n"
 		"\n"
 		"For command-specific help, use the --help option of each command.\n"
 		"\n";
@@ -169,7 +241,7 @@ static int print_dpmac_endpoint(uint32_t target_id)
 	endpoint1.id = target_id;
 	endpoint1.if_id = 0;
 
-	error = dprc_get_connection(&restool.mc_io, 0,
+	error = dprc_get_connection(&restool.mc_io, CONN_LANE,
 					restool.root_dprc_handle,
 					&endpoint1, &endpoint2, &state);
 	printf("endpoint state: %d\n", state);
@@ -318,7 +390,7 @@ static int print_dpmac_counters(struct fsl_mc_io *mc_io, uint16_t token)
 	printf("Counters: \n");
 	for (i = 0; i < ARRAY_SIZE(dpaa2_mac_counters); i++) {
 		error = dpmac_get_counter_v10(mc_io,
-					    0,
+					    CNT_LANE,
 					    token,
 					    dpaa2_mac_counters[i].id, &counter_value);
 		if (error < 0) {
@@ -892,6 +964,358 @@ static int cmd_dpmac_destroy_v10(void)
 	return destroy_dpmac(MC_FW_VERSION_10);
 }
 
+/* the counters dpmac stats samples: the traffic ones, then the errors */
+enum dpmac_stat {
+	DPMAC_STAT_RX_FRAMES,
+	DPMAC_STAT_RX_BYTES,
+	DPMAC_STAT_TX_FRAMES,
+	DPMAC_STAT_TX_BYTES,
+	DPMAC_STAT_FIRST_ERROR,
+	DPMAC_STAT_RX_ERRORS = DPMAC_STAT_FIRST_ERROR,
+	DPMAC_STAT_RX_FRAGS,
+	DPMAC_STAT_RX_JABBER,
+	DPMAC_STAT_RX_ALIGN,
+	DPMAC_STAT_RX_OVERSIZED,
+	DPMAC_STAT_TX_ERRORS,
+	DPMAC_STAT_TX_UNDERSIZED,
+	DPMAC_NUM_STATS,
+};
+
+static const struct {
+	enum dpmac_counter id;
+	const char *key;
+} dpmac_stat_counters[] = {
+	[DPMAC_STAT_RX_FRAMES] = { DPMAC_CNT_ING_ALL_FRAME, "rx_frames" },
+	[DPMAC_STAT_RX_BYTES] = { DPMAC_CNT_ING_BYTE, "rx_bytes" },
+	[DPMAC_STAT_TX_FRAMES] = { DPMAC_CNT_ENG_GOOD_FRAME, "tx_frames" },
+	[DPMAC_STAT_TX_BYTES] = { DPMAC_CNT_EGR_BYTE, "tx_bytes" },
+	/* FCS errors are counted in the rx frame errors */
+	[DPMAC_STAT_RX_ERRORS] = { DPMAC_CNT_ING_ERR_FRAME, "rx_errors" },
+	[DPMAC_STAT_RX_FRAGS] = { DPMAC_CNT_ING_FRAG, "rx_frags" },
+	[DPMAC_STAT_RX_JABBER] = { DPMAC_CNT_ING_JABBER, "rx_jabber" },
+	[DPMAC_STAT_RX_ALIGN] = { DPMAC_CNT_ING_ALIGN_ERR, "rx_align" },
+	[DPMAC_STAT_RX_OVERSIZED] = { DPMAC_CNT_ING_OVERSIZED,
+				      "rx_oversized" },
+	[DPMAC_STAT_TX_ERRORS] = { DPMAC_CNT_EGR_ERR_FRAME, "tx_errors" },
+	[DPMAC_STAT_TX_UNDERSIZED] = { DPMAC_CNT_EGR_UNDERSIZED,
+				       "tx_undersized" },
+};
+
+C_ASSERT(ARRAY_SIZE(dpmac_stat_counters) == DPMAC_NUM_STATS);
+
+/* one DPMAC being sampled, with the counters of its last two samples */
+struct dpmac_sampler {
+	uint32_t dpmac_id;
+	uint64_t prev[DPMAC_NUM_STATS];
+	uint64_t cur[DPMAC_NUM_STATS];
+	struct timespec prev_time;
+	struct timespec cur_time;
+	/* the samples read in a row, there is a rate from the second one */
+	unsigned int samples;
+	int error;
+};
+
+static int dpmac_sample_task_run(struct fsl_mc_io *mc_io, void *arg)
+{
+	struct dpmac_sampler *sampler = arg;
+	uint16_t token;
+	int error, error2;
+
+	memcpy(sampler->prev, sampler->cur, sizeof(sampler->prev));
+	sampler->prev_time = sampler->cur_time;
+
+	error = dpmac_open_v10(mc_io, 0, sampler->dpmac_id, &token);
+	if (error < 0)
+		goto out;
+
+	for (int s = 0; s < DPMAC_NUM_STATS && error == 0; s++)
+		error = dpmac_get_counter_v10(mc_io, CNT_LANE, token,
+					      dpmac_stat_counters[s].id,
+					      &sampler->cur[s]);
+	clock_gettime(CLOCK_MONOTONIC, &sampler->cur_time);
+
+	error2 = dpmac_close_v10(mc_io, 0, token);
+	if (error == 0)
+		error = error2;
+out:
+	sampler->error = error;
+	sampler->samples = error ? 0 : sampler->samples + 1;
+	return error;
+}
+
+/**
+ * Sample all the DPMACs, in parallel over the MC portals of 'sched' when
+ * there is one. A DPMAC which fails is reported and left out of this
+ * sample rather than ending the whole run.
+ */
+static void sample_dpmacs(struct mc_sched *sched,
+			  struct dpmac_sampler *samplers, unsigned int num)
+{
+	for (unsigned int i = 0; i < num; i++) {
+		if (sched) {
+			int error = mc_sched_submit(sched,
+						    dpmac_sample_task_run,
+						    &samplers[i]);
+
+			if (error < 0) {
+				samplers[i].error = error;
+				samplers[i].samples = 0;
+			}
+		} else
+			dpmac_sample_task_run(&restool.mc_io, &samplers[i]);
+	}
+
+	if (sched)
+		(void)mc_sched_wait(sched);
+
+	for (unsigned int i = 0; i < num; i++) {
+		if (!samplers[i].error)
+			continue;
+
+		mc_status = flib_error_to_mc_status(samplers[i].error);
+		ERROR_PRINTF("dpmac.%u: MC error: %s (status %#x)\n",
+			     samplers[i].dpmac_id,
+			     mc_status_to_string(mc_status), mc_status);
+	}
+}
+
+/**
+ * The growth of a 64 bit counter between two samples. A counter found
+ * lower than before was reset, e.g. by a link re-init, and only counted
+ * its new value since then.
+ */
+static uint64_t dpmac_counter_delta(uint64_t prev, uint64_t cur, bool *reset)
+{
+	if (cur >= prev)
+		return cur - prev;
+
+	*reset = true;
+	return cur;
+}
+
+/**
+ * Print the rates of one DPMAC since its previous sample, and flag an
+ * error burst when its error counters grew by 'threshold' or more
+ */
+static void print_dpmac_sample(const struct dpmac_sampler *sampler,
+			       uint64_t threshold, bool json)
+{
+	uint64_t deltas[DPMAC_NUM_STATS], errors = 0;
+	bool reset = false;
+	double secs;
+	bool burst;
+
+	secs = timespec_elapsed(&sampler->prev_time, &sampler->cur_time);
+	if (secs <= 0)
+		return;
+
+	for (int s = 0; s < DPMAC_NUM_STATS; s++)
+		deltas[s] = dpmac_counter_delta(sampler->prev[s],
+						sampler->cur[s], &reset);
+	for (int s = DPMAC_STAT_FIRST_ERROR; s < DPMAC_NUM_STATS; s++)
+		errors += deltas[s];
+	burst = errors >= threshold && errors > 0;
+
+	if (json) {
+		struct timespec now;
+
+		clock_gettime(CLOCK_REALTIME, &now);
+		printf("{\"time\": %ld.%03ld, \"dpmac\": \"dpmac.%u\", \"interval_ms\": %.0f",
+		       (long)now.tv_sec, now.tv_nsec / 1000000,
+		       sampler->dpmac_id, secs * 1000);
+		printf(", \"rx_fps\": %.0f, \"rx_Bps\": %.0f, \"tx_fps\": %.0f, \"tx_Bps\": %.0f",
+		       deltas[DPMAC_STAT_RX_FRAMES] / secs,
+		       deltas[DPMAC_STAT_RX_BYTES] / secs,
+		       deltas[DPMAC_STAT_TX_FRAMES] / secs,
+		       deltas[DPMAC_STAT_TX_BYTES] / secs);
+		printf(", \"errors\": {");
+		for (int s = DPMAC_STAT_FIRST_ERROR; s < DPMAC_NUM_STATS; s++)
+			printf("%s\"%s\": %" PRIu64,
+			       s == DPMAC_STAT_FIRST_ERROR ? "" : ", ",
+			       dpmac_stat_counters[s].key, deltas[s]);
+		printf("}, \"burst\": %s, \"reset\": %s}\n",
+		       burst ? "true" : "false", reset ? "true" : "false");
+		return;
+	}
+
+	printf("dpmac.%-4u %12.0f %14.0f %12.0f %14.0f %8" PRIu64 "%s%s\n",
+	       sampler->dpmac_id, deltas[DPMAC_STAT_RX_FRAMES] / secs,
+	       deltas[DPMAC_STAT_RX_BYTES] / secs,
+	       deltas[DPMAC_STAT_TX_FRAMES] / secs,
+	       deltas[DPMAC_STAT_TX_BYTES] / secs, errors,
+	       burst ? "  BURST" : "", reset ? "  counter reset" : "");
+}
+
+static int dpmac_stats(struct dpmac_sampler *samplers, unsigned int num,
+		       struct watch *watch, uint64_t threshold, bool json)
+{
+	struct mc_sched *sched = NULL;
+	int error = 0;
+
+	if (restool.num_jobs > 1 && num > 1) {
+		error = mc_sched_create(&sched, &restool.mc_io,
+					restool.device_file, restool.num_jobs,
+					restool.max_in_flight);
+		if (error < 0)
+			return error;
+	}
+
+	/* the first sample is the baseline of the rates */
+	sample_dpmacs(sched, samplers, num);
+
+	watch_start(watch);
+	while (watch_next(watch)) {
+		sample_dpmacs(sched, samplers, num);
+
+		if (!json)
+			printf("%-10s %12s %14s %12s %14s %8s\n", "dpmac",
+			       "rx-frames/s", "rx-bytes/s", "tx-frames/s",
+			       "tx-bytes/s", "errors");
+		for (unsigned int i = 0; i < num; i++) {
+			/* without a baseline there is nothing to compare to */
+			if (samplers[i].samples < 2)
+				continue;
+			print_dpmac_sample(&samplers[i], threshold, json);
+		}
+		fflush(stdout);
+	}
+
+	watch_stop(watch);
+	mc_sched_destroy(sched);
+
+	for (unsigned int i = 0; i < num; i++)
+		if (samplers[i].error && error == 0)
+			error = samplers[i].error;
+
+	return error;
+}
+
+static int cmd_dpmac_stats_v10(void)
+{
+	static const char usage_msg[] =
+		"\n"
+		"Usage: restool dpmac stats <dpmac-object> | --all\n"
+		"	[--watch=<ms>] [--count=<n>] [--duration=<seconds>]\n"
+		"	[--threshold=<n>] [--json]\n"
+		"\n"
+		"  Samples the counters of a DPMAC, or of all of them, and prints\n"
+		"  their rx and tx frame and byte rates and how many errors they\n"
+		"  counted in the interval: rx frame errors (including FCS\n"
+		"  errors), fragments, jabbers, alignment errors and oversized\n"
+		"  frames, tx frame errors and undersized frames. With --jobs,\n"
+		"  the DPMACs are sampled in parallel on several MC portals.\n"
+		"\n"
+		"OPTIONS:\n"
+		"--all\n"
+		"   Samples all the DPMACs instead of a single one\n"
+		"--watch=<ms>\n"
+		"   Samples every <ms> milliseconds until interrupted. Without\n"
+		"   it, a single interval of 1000 ms is sampled.\n"
+		"--count=<n>\n"
+		"   Stops after <n> intervals\n"
+		"--duration=<seconds>\n"
+		"   Stops after <seconds>\n"
+		"--threshold=<n>\n"
+		"   Flags a burst when a DPMAC counts <n> errors or more in an\n"
+		"   interval. Default is 1.\n"
+		"--json\n"
+		"   Prints one JSON object per DPMAC and interval\n"
+		"\n"
+		"EXAMPLE:\n"
+		"Watch all the DPMACs every 500 ms, flagging 10 errors or more:\n"
+		"   $ restool dpmac stats --all --watch=500 --threshold=10\n"
+		"\n";
+
+	struct dpmac_sampler *samplers = NULL;
+	struct watch watch = {
+		.interval_ms = 1000,
+		.count = 1,
+	};
+	unsigned int num = 0;
+	uint64_t threshold = 1;
+	struct obj_index index;
+	bool json = false;
+	uint32_t dpmac_id;
+	long value;
+	int error;
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(STATS_OPT_HELP)) {
+		puts(usage_msg);
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(STATS_OPT_HELP);
+		return 0;
+	}
+
+	error = get_watch_options(&watch, STATS_OPT_WATCH, STATS_OPT_COUNT,
+				  STATS_OPT_DURATION);
+	if (error < 0)
+		return error;
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(STATS_OPT_THRESHOLD)) {
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(STATS_OPT_THRESHOLD);
+		error = get_option_value(STATS_OPT_THRESHOLD, &value,
+					 "Invalid error threshold", 1,
+					 INT32_MAX);
+		if (error)
+			return -EINVAL;
+		threshold = value;
+	}
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(STATS_OPT_JSON)) {
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(STATS_OPT_JSON);
+		json = true;
+	}
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(STATS_OPT_ALL)) {
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(STATS_OPT_ALL);
+		if (restool.obj_name != NULL) {
+			ERROR_PRINTF("--all and <object> are exclusive\n");
+			puts(usage_msg);
+			return -EINVAL;
+		}
+
+		error = obj_index_get(&index);
+		if (error < 0)
+			return error;
+
+		samplers = calloc(index.num_entries, sizeof(*samplers));
+		if (!samplers) {
+			obj_index_free(&index);
+			return -ENOMEM;
+		}
+		for (unsigned int i = 0; i < index.num_entries; i++)
+			if (strcmp(index.entries[i].type, "dpmac") == 0)
+				samplers[num++].dpmac_id = index.entries[i].id;
+		obj_index_free(&index);
+
+		if (num == 0) {
+			ERROR_PRINTF("no DPMAC found\n");
+			error = -ENOENT;
+			goto out;
+		}
+	} else {
+		if (restool.obj_name == NULL) {
+			ERROR_PRINTF("<object> argument missing\n");
+			puts(usage_msg);
+			return -EINVAL;
+		}
+
+		error = parse_object_name(restool.obj_name, "dpmac",
+					  &dpmac_id);
+		if (error < 0)
+			return error;
+
+		samplers = calloc(1, sizeof(*samplers));
+		if (!samplers)
+			return -ENOMEM;
+		samplers[num++].dpmac_id = dpmac_id;
+	}
+
+	error = dpmac_stats(samplers, num, &watch, threshold, json);
+out:
+	free(samplers);
+	return error;
+}
+
 struct object_command dpmac_commands_v9[] = {
 	{ .cmd_name = "--help",
 	  .options = NULL,
@@ -929,6 +1353,10 @@ struct object_command dpmac_commands_v10[] = {
 	  .options = dpmac_destroy_options,
 	  .cmd_func = cmd_dpmac_destroy_v10 },
 
+	{ .cmd_name = "stats",
+	  .options = dpmac_stats_options,
+	  .cmd_func = cmd_dpmac_stats_v10 },
+
 	{ .cmd_name = NULL },
 };
 
@@ -36,8 +36,10 @@
 #include <string.h>
 #include <stdint.h>
 #include <errno.h>
+#include <ctype.h>
 #include <assert.h>
 #include <getopt.h>
+#include <time.h>
 #include <sys/ioctl.h>
 #include "restool.h"
 #include "utils.h"
@@ -106,6 +108,11 @@ struct dpni_config {
 enum dpni_info_options {
 	INFO_OPT_HELP = 0,
 	INFO_OPT_VERBOSE,
+	INFO_OPT_NO_STATS,
+	INFO_OPT_PAGE,
+	INFO_OPT_TC,
+	INFO_OPT_QUEUE,
+	INFO_OPT_CHANNEL,
 };
 
 static struct option dpni_info_options[] = {
@@ -123,11 +130,60 @@ static struct option dpni_info_options[] = {
 		.val = 0,
 	},
 
+	[INFO_OPT_NO_STATS] = {
+		.name = "no-stats",
+		.has_arg = 0,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[INFO_OPT_PAGE] = {
+		.name = "page",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[INFO_OPT_TC] = {
+		.name = "tc",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[INFO_OPT_QUEUE] = {
+		.name = "queue",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[INFO_OPT_CHANNEL] = {
+		.name = "channel",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
 	{ 0 },
 };
 
 C_ASSERT(ARRAY_SIZE(dpni_info_options) <= MAX_NUM_CMD_LINE_OPTIONS + 1);
 
+/* a set of statistics pages, traffic classes, queues or channels */
+struct dpni_stats_set {
+	bool all;
+	uint64_t bits[4];
+};
+
+/* which statistics dpni info reads */
+struct dpni_stats_query {
+	struct dpni_stats_set pages;
+	struct dpni_stats_set tcs;
+	struct dpni_stats_set queues;
+	struct dpni_stats_set channels;
+};
+
 /**
  * dpni create command options
  */
@@ -393,6 +449,82 @@ static struct option dpni_update_options_v10[] = {
 
 C_ASSERT(ARRAY_SIZE(dpni_update_options_v10) <= MAX_NUM_CMD_LINE_OPTIONS + 1);
 
+/**
+ * dpni congestion command options
+ */
+enum dpni_congestion_options {
+	CONGESTION_OPT_HELP = 0,
+	CONGESTION_OPT_INTERVAL,
+	CONGESTION_OPT_COUNT,
+	CONGESTION_OPT_DURATION,
+	CONGESTION_OPT_TC,
+	CONGESTION_OPT_QUEUE,
+	CONGESTION_OPT_BYTES,
+	CONGESTION_OPT_JSON,
+};
+
+static struct option dpni_congestion_options[] = {
+	[CONGESTION_OPT_HELP] = {
+		.name = "help",
+		.has_arg = 0,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[CONGESTION_OPT_INTERVAL] = {
+		.name = "interval",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[CONGESTION_OPT_COUNT] = {
+		.name = "count",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[CONGESTION_OPT_DURATION] = {
+		.name = "duration",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[CONGESTION_OPT_TC] = {
+		.name = "tc",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[CONGESTION_OPT_QUEUE] = {
+		.name = "queue",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[CONGESTION_OPT_BYTES] = {
+		.name = "bytes",
+		.has_arg = 0,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[CONGESTION_OPT_JSON] = {
+		.name = "json",
+		.has_arg = 0,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	{ 0 },
+};
+
+C_ASSERT(ARRAY_SIZE(dpni_congestion_options) <= MAX_NUM_CMD_LINE_OPTIONS + 1);
+
 const struct flib_ops dpni_ops = {
 	.obj_open = dpni_open_v10,
 	.obj_close = dpni_close_v10,
@@ -519,6 +651,7 @@ static int cmd_dpni_help_v10(void)
 		"   create - creates a new child DPNI under the root DPRC.\n"
 		"   destroy - destroys a child DPNI under the root DPRC.\n"
 		"   update - update attributes of already created DPNI.\n"
+		"   congestion - shows the congestion rejects of a DPNI per TC and queue.\n"
 		"\n"
 		"For command-specific help, use the --help option of each command.\n"
 		"\n";
@@ -640,7 +773,7 @@ static int print_dpni_endpoint(uint32_t target_id)
 	endpoint1.id = target_id;
 	endpoint1.if_id = 0;
 
-	error = dprc_get_connection(&restool.mc_io, 0,
+	error = dprc_get_connection(&restool.mc_io, CONN_LANE,
 					restool.root_dprc_handle,
 					&endpoint1, &endpoint2, &state);
 	printf("endpoint state: %d\n", state);
@@ -735,7 +868,7 @@ static int print_dpni_attr_v9(uint32_t dpni_id,
 	}
 
 	memset(&link_state, 0, sizeof(link_state));
-	error = dpni_get_link_state(&restool.mc_io, 0, dpni_handle,
+	error = dpni_get_link_state(&restool.mc_io, LINK_LANE, dpni_handle,
 					&link_state);
 	if (error < 0) {
 		mc_status = flib_error_to_mc_status(error);
@@ -835,19 +968,197 @@ static void dpni_print_stats(const char *strings[],
 	}
 }
 
+/* number of counters of a statistics page */
+static unsigned int dpni_stats_num(const char *strings[])
+{
+	unsigned int i;
+
+	for (i = 0; i < DPNI_STATS_PER_PAGE_V10; i++)
+		if (strings[i] == NULL || strings[i][0] == '\0')
+			break;
+
+	return i;
+}
+
+/**
+ * Parse a list of indexes like "0,2,4-7" into a set, each index being at
+ * most 'max'
+ */
+static int parse_dpni_stats_set(int option, const char *what,
+				struct dpni_stats_set *set, unsigned int max)
+{
+	const char *str = restool.cmd_option_args[option];
+	unsigned long first, last;
+	char *endptr;
+
+	memset(set, 0, sizeof(*set));
+	for (;;) {
+		if (!isdigit((unsigned char)*str))
+			goto err;
+		first = strtoul(str, &endptr, 10);
+		last = first;
+		if (*endptr == '-') {
+			str = endptr + 1;
+			if (!isdigit((unsigned char)*str))
+				goto err;
+			last = strtoul(str, &endptr, 10);
+		}
+
+		if (last < first || last > max)
+			goto err;
+
+		for (unsigned long i = first; i <= last; i++)
+			set->bits[i / 64] |= 1ULL << (i % 64);
+
+		if (*endptr == '\0')
+			return 0;
+		if (*endptr != ',')
+			goto err;
+		str = endptr + 1;
+	}
+
+err:
+	ERROR_PRINTF("Invalid %s list '%s', expected e.g. 0,2,4-6 (at most %u)\n",
+		     what, restool.cmd_option_args[option], max);
+	return -EINVAL;
+}
+
+static bool in_dpni_stats_set(const struct dpni_stats_set *set,
+			      unsigned int i)
+{
+	return set->all || (set->bits[i / 64] >> (i % 64)) & 1;
+}
+
+static void print_dpni_stats_row(const char *strings[], const char *outer,
+				 int outer_id, int tc,
+				 union dpni_statistics_v10 *dpni_stats)
+{
+	unsigned int num = dpni_stats_num(strings);
+	uint64_t *stat = (uint64_t *)&dpni_stats->raw;
+
+	if (outer)
+		printf("%7d ", outer_id);
+	printf("%3d", tc);
+	for (unsigned int i = 0; i < num; i++)
+		printf(" %*" PRIu64, (int)strlen(strings[i]), stat[i]);
+	printf("\n");
+}
+
+static void print_dpni_stats_header(const char *strings[], const char *title,
+				    const char *outer)
+{
+	unsigned int num = dpni_stats_num(strings);
+
+	printf("+ %s\n", title);
+	if (outer)
+		printf("%7s ", outer);
+	printf("%3s", "tc");
+	for (unsigned int i = 0; i < num; i++)
+		printf(" %s", strings[i]);
+	printf("\n");
+}
+
+/**
+ * Print the statistics pages picked by the query. The pages which are
+ * kept per Tx channel, per queue or per traffic class are only read for
+ * the picked ones, and printed as one row each.
+ */
+static void print_dpni_stats_v10(uint16_t dpni_handle,
+				 const struct dpni_attr_v10 *dpni_attr,
+				 const struct dpni_stats_query *query)
+{
+	union dpni_statistics_v10 dpni_stats;
+	int error;
+
+	for (unsigned int page = 0; page < ARRAY_SIZE(dpni_stats_v10);
+	     page++) {
+		const struct dpni_stats_set *outer_set = NULL;
+		const char *outer = NULL;
+		const char *title;
+		bool header = false;
+		int num_outer = 1;
+		int num_tcs;
+
+		if (!in_dpni_stats_set(&query->pages, page))
+			continue;
+
+		switch (page) {
+		case 3:
+			title = "CEETM stats per Tx channel and TC";
+			outer = "channel";
+			outer_set = &query->channels;
+			num_outer = dpni_attr->num_ceetm_ch;
+			num_tcs = dpni_attr->num_tx_tcs;
+			break;
+		case 4:
+			title = "Congestion stats per Rx TC";
+			if (dpni_attr->options & DPNI_OPT_CUSTOM_CG) {
+				title = "Congestion stats per queue and Rx TC";
+				outer = "queue";
+				outer_set = &query->queues;
+				num_outer = dpni_attr->num_queues;
+			}
+			num_tcs = dpni_attr->num_rx_tcs;
+			break;
+		case 5:
+			title = "Policer stats per Rx TC";
+			num_tcs = dpni_attr->num_rx_tcs;
+			break;
+		default:
+			memset(&dpni_stats, 0, sizeof(dpni_stats));
+			error = dpni_get_statistics_v10(&restool.mc_io, CNT_LANE,
+							dpni_handle, page,
+							0, &dpni_stats);
+			if (error < 0)
+				DEBUG_PRINTF("no statistics page %u (error %d)\n",
+					     page, error);
+			dpni_print_stats(dpni_stats_v10[page], dpni_stats);
+			continue;
+		}
+
+		for (int o = 0; o < num_outer; o++) {
+			if (outer_set && !in_dpni_stats_set(outer_set, o))
+				continue;
+
+			for (int tc = 0; tc < num_tcs; tc++) {
+				uint16_t param = (o << 8) | tc;
+
+				if (!in_dpni_stats_set(&query->tcs, tc))
+					continue;
+
+				memset(&dpni_stats, 0, sizeof(dpni_stats));
+				error = dpni_get_statistics_v10(&restool.mc_io,
+								CNT_LANE,
+								dpni_handle,
+								page, param,
+								&dpni_stats);
+				if (error < 0)
+					continue;
+
+				if (!header) {
+					print_dpni_stats_header(
+						dpni_stats_v10[page], title,
+						outer);
+					header = true;
+				}
+				print_dpni_stats_row(dpni_stats_v10[page],
+						     outer, o, tc, &dpni_stats);
+			}
+		}
+	}
+}
+
 static int print_dpni_attr_v10(uint32_t dpni_id,
-			      struct dprc_obj_desc *target_obj_desc)
+			      struct dprc_obj_desc *target_obj_desc,
+			      const struct dpni_stats_query *query)
 {
 	struct dpni_attr_v10 dpni_attr;
-	union dpni_statistics_v10 dpni_stats;
 	uint16_t dpni_handle, dpni_major, dpni_minor;
 	struct dpni_link_state_v10 link_state;
 	bool dpni_opened = false;
 	uint8_t mac_addr[6];
-	int tc, q, ch;
 	int error = 0;
 	int error2;
-	unsigned int page;
 	uint16_t max_frame_length;
 
 	error = dpni_open_v10(&restool.mc_io, 0, dpni_id, &dpni_handle);
@@ -886,7 +1197,7 @@ static int print_dpni_attr_v10(uint32_t dpni_id,
 	}
 
 	memset(&link_state, 0, sizeof(link_state));
-	error = dpni_get_link_state_v10(&restool.mc_io, 0, dpni_handle,
+	error = dpni_get_link_state_v10(&restool.mc_io, LINK_LANE, dpni_handle,
 					&link_state);
 	if (error < 0) {
 		mc_status = flib_error_to_mc_status(error);
@@ -945,79 +1256,8 @@ static int print_dpni_attr_v10(uint32_t dpni_id,
 	printf("num_channels: %u\n", (uint32_t)dpni_attr.num_ceetm_ch);
 	printf("num_opr: %u\n", (uint32_t)dpni_attr.num_opr);
 
-	for (page = 0; page < 7; page++) {
-		memset(&dpni_stats, 0, sizeof(dpni_stats));
-
-		switch (page) {
-		case 3:
-			for (ch = 0; ch < dpni_attr.num_ceetm_ch; ch++) {
-				int tc;
-
-				for (tc = 0; tc < dpni_attr.num_tx_tcs; tc++) {
-					uint16_t param = (ch << 8) | tc;
-
-					memset(&dpni_stats, 0, sizeof(dpni_stats));
-					error = dpni_get_statistics_v10(&restool.mc_io, 0,
-								dpni_handle, page, param, &dpni_stats);
-					if (!error) {
-						printf("+ CEETM stats Tx channel %d, TC %d\n", ch, tc);
-						dpni_print_stats(dpni_stats_v10[page], dpni_stats);
-					}
-				}
-			}
-			break;
-		case 4:
-			if (dpni_attr.options & DPNI_OPT_CUSTOM_CG) {
-				for (q = 0; q < dpni_attr.num_queues; q++) {
-					for (tc = 0; tc < dpni_attr.num_rx_tcs; tc++) {
-						uint16_t param = (q << 8 ) | tc;
-
-						memset(&dpni_stats, 0, sizeof(dpni_stats));
-						error = dpni_get_statistics_v10(&restool.mc_io, 0, dpni_handle,
-										page, param, &dpni_stats);
-						if (!error) {
-							printf("+ Congestion stats for Queue %d, Rx TC %d\n", q, tc);
-							dpni_print_stats(dpni_stats_v10[page], dpni_stats);
-						}
-					}
-				}
-			} else {
-				for (tc = 0; tc < dpni_attr.num_rx_tcs; tc++) {
-					uint16_t param = tc;
-
-					memset(&dpni_stats, 0, sizeof(dpni_stats));
-					error = dpni_get_statistics_v10(&restool.mc_io, 0, dpni_handle,
-									page, param, &dpni_stats);
-					if (!error) {
-						printf("+ Congestion stats for Rx TC %d\n", tc);
-						dpni_print_stats(dpni_stats_v10[page], dpni_stats);
-					}
-				}
-			}
-
-			break;
-		case 5:
-			for (tc = 0; tc < dpni_attr.num_rx_tcs; tc++) {
-				uint16_t param = tc;
-
-				memset(&dpni_stats, 0, sizeof(dpni_stats));
-				error = dpni_get_statistics_v10(&restool.mc_io, 0, dpni_handle,
-								page, param, &dpni_stats);
-				if (!error) {
-					printf("+ Policer stats for TC %d\n", tc);
-					dpni_print_stats(dpni_stats_v10[page], dpni_stats);
-				}
-			}
-
-			break;
-		default:
-			error = dpni_get_statistics_v10(&restool.mc_io, 0,
-							dpni_handle, page,
-							0, &dpni_stats);
-			dpni_print_stats(dpni_stats_v10[page], dpni_stats);
-			break;
-		}
-	}
+	if (query)
+		print_dpni_stats_v10(dpni_handle, &dpni_attr, query);
 
 	print_obj_label(target_obj_desc);
 
@@ -1037,7 +1277,8 @@ out:
 	return error;
 }
 
-static int print_dpni_info(uint32_t dpni_id, int mc_fw_version)
+static int print_dpni_info(uint32_t dpni_id, int mc_fw_version,
+			   const struct dpni_stats_query *query)
 {
 	int error;
 	struct dprc_obj_desc target_obj_desc;
@@ -1060,7 +1301,7 @@ static int print_dpni_info(uint32_t dpni_id, int mc_fw_version)
 	if (mc_fw_version == MC_FW_VERSION_9)
 		error = print_dpni_attr_v9(dpni_id, &target_obj_desc);
 	else if (mc_fw_version == MC_FW_VERSION_10)
-		error = print_dpni_attr_v10(dpni_id, &target_obj_desc);
+		error = print_dpni_attr_v10(dpni_id, &target_obj_desc, query);
 	if (error < 0)
 		goto out;
 
@@ -1077,17 +1318,45 @@ static int info_dpni(int mc_fw_version)
 {
 	static const char usage_msg[] =
 		"\n"
-		"Usage: restool dpni info <dpni-object> [--verbose]\n"
+		"Usage: restool dpni info <dpni-object> [--verbose] [--no-stats]\n"
+		"	[--page=<list>] [--tc=<list>] [--queue=<list>]\n"
+		"	[--channel=<list>]\n"
 		"\n"
 		"OPTIONS:\n"
 		"--verbose\n"
 		"   Shows extended/verbose information about the object\n"
+		"--no-stats\n"
+		"   Does not read the statistics\n"
+		"--page=<list>\n"
+		"   Only reads these statistics pages, 0 to 6, e.g. 0,1\n"
+		"--tc=<list>\n"
+		"   Only reads the per traffic class statistics (pages 3, 4\n"
+		"   and 5) of these traffic classes, e.g. 0-3\n"
+		"--queue=<list>\n"
+		"   Only reads the per queue congestion statistics (page 4,\n"
+		"   with DPNI_OPT_CUSTOM_CG) of these queues\n"
+		"--channel=<list>\n"
+		"   Only reads the CEETM statistics (page 3) of these Tx\n"
+		"   channels\n"
 		"\n"
 		"EXAMPLE:\n"
 		"Display information about dpni.5:\n"
 		"   $ restool dpni info dpni.5\n"
+		"Display the congestion statistics of queues 0 to 3 of TC 3:\n"
+		"   $ restool dpni info dpni.5 --page=4 --tc=3 --queue=0-3\n"
 		"\n";
 
+	struct dpni_stats_query query = {
+		.pages = { .all = true },
+		.tcs = { .all = true },
+		.queues = { .all = true },
+		.channels = { .all = true },
+	};
+	const uint32_t sel_mask = ONE_BIT_MASK(INFO_OPT_PAGE) |
+				  ONE_BIT_MASK(INFO_OPT_TC) |
+				  ONE_BIT_MASK(INFO_OPT_QUEUE) |
+				  ONE_BIT_MASK(INFO_OPT_CHANNEL);
+	bool no_stats = false;
 	uint32_t obj_id;
 	int error;
 
@@ -1109,7 +1378,54 @@ static int info_dpni(int mc_fw_version)
 	if (error < 0)
 		goto out;
 
-	error = print_dpni_info(obj_id, mc_fw_version);
+	if (restool.cmd_option_mask & ONE_BIT_MASK(INFO_OPT_NO_STATS)) {
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(INFO_OPT_NO_STATS);
+		no_stats = true;
+	}
+
+	if ((restool.cmd_option_mask & sel_mask) &&
+	    (no_stats || mc_fw_version != MC_FW_VERSION_10)) {
+		ERROR_PRINTF("--page, --tc, --queue and --channel need the statistics of MC v10\n");
+		puts(usage_msg);
+		error = -EINVAL;
+		goto out;
+	}
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(INFO_OPT_PAGE)) {
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(INFO_OPT_PAGE);
+		error = parse_dpni_stats_set(INFO_OPT_PAGE, "page",
+					     &query.pages,
+					     ARRAY_SIZE(dpni_stats_v10) - 1);
+		if (error < 0)
+			goto out;
+	}
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(INFO_OPT_TC)) {
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(INFO_OPT_TC);
+		error = parse_dpni_stats_set(INFO_OPT_TC, "TC", &query.tcs,
+					     UINT8_MAX);
+		if (error < 0)
+			goto out;
+	}
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(INFO_OPT_QUEUE)) {
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(INFO_OPT_QUEUE);
+		error = parse_dpni_stats_set(INFO_OPT_QUEUE, "queue",
+					     &query.queues, UINT8_MAX);
+		if (error < 0)
+			goto out;
+	}
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(INFO_OPT_CHANNEL)) {
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(INFO_OPT_CHANNEL);
+		error = parse_dpni_stats_set(INFO_OPT_CHANNEL, "channel",
+					     &query.channels, UINT8_MAX);
+		if (error < 0)
+			goto out;
+	}
+
+	error = print_dpni_info(obj_id, mc_fw_version,
+				no_stats ? NULL : &query);
 
 out:
 	return error;
@@ -2122,6 +2438,395 @@ static int cmd_dpni_update_v10(void)
 	return update_dpni_v10(usage_msg);
 }
 
+/* one sample of the counters a congestion heatmap is made of */
+struct dpni_cg_sample {
+	struct timespec time;
+	uint64_t ingress_frames;
+	uint64_t discarded_frames;
+	uint64_t nobuffer_discards;
+	/* rejects of each congestion group: queue major, then TC */
+	uint64_t *rejects;
+};
+
+/* what a congestion heatmap covers */
+struct dpni_cg_map {
+	uint16_t dpni_handle;
+	/* one queue unless the DPNI has a congestion group per queue */
+	int num_queues;
+	int num_tcs;
+	const struct dpni_stats_set *tcs;
+	const struct dpni_stats_set *queues;
+	bool bytes;
+};
+
+/**
+ * Read pages 0 and 2 for the Rx totals and page 4 for the congestion group
+ * rejects of the picked queues and traffic classes
+ */
+static int read_dpni_cg_sample(const struct dpni_cg_map *map,
+			       struct dpni_cg_sample *sample)
+{
+	union dpni_statistics_v10 stats;
+	int error;
+
+	memset(&stats, 0, sizeof(stats));
+	error = dpni_get_statistics_v10(&restool.mc_io, CNT_LANE,
+					map->dpni_handle, 0, 0, &stats);
+	if (error < 0)
+		return error;
+	sample->ingress_frames = map->bytes ? stats.page_0.ingress_all_bytes :
+				 stats.page_0.ingress_all_frames;
+
+	memset(&stats, 0, sizeof(stats));
+	error = dpni_get_statistics_v10(&restool.mc_io, CNT_LANE,
+					map->dpni_handle, 2, 0, &stats);
+	if (error < 0)
+		return error;
+	sample->discarded_frames = stats.page_2.ingress_discarded_frames;
+	sample->nobuffer_discards = stats.page_2.ingress_nobuffer_discards;
+
+	for (int q = 0; q < map->num_queues; q++) {
+		if (!in_dpni_stats_set(map->queues, q))
+			continue;
+
+		for (int tc = 0; tc < map->num_tcs; tc++) {
+			if (!in_dpni_stats_set(map->tcs, tc))
+				continue;
+
+			memset(&stats, 0, sizeof(stats));
+			error = dpni_get_statistics_v10(&restool.mc_io,
+							CNT_LANE,
+							map->dpni_handle, 4,
+							(q << 8) | tc, &stats);
+			if (error < 0)
+				return error;
+
+			sample->rejects[q * map->num_tcs + tc] = map->bytes ?
+				stats.page_4.cgr_reject_bytes :
+				stats.page_4.cgr_reject_frames;
+		}
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &sample->time);
+	return 0;
+}
+
+static double dpni_cg_rate(uint64_t cur, uint64_t prev, double secs)
+{
+	return cur >= prev && secs > 0 ? (cur - prev) / secs : 0;
+}
+
+/* shades of a heatmap cell, from no rejects to the highest rate */
+static const char cg_shades[] = " .:-=+*#%@";
+
+static void print_dpni_cg_heatmap(const struct dpni_cg_map *map,
+				  const struct dpni_cg_sample *cur,
+				  const struct dpni_cg_sample *prev,
+				  double secs)
+{
+	const char *unit = map->bytes ? "bytes" : "frames";
+	double max = 0, total = 0, ingress;
+
+	for (int i = 0; i < map->num_queues * map->num_tcs; i++) {
+		double rate = dpni_cg_rate(cur->rejects[i], prev->rejects[i],
+					   secs);
+
+		if (rate > max)
+			max = rate;
+		total += rate;
+	}
+
+	ingress = dpni_cg_rate(cur->ingress_frames, prev->ingress_frames,
+			       secs);
+	printf("ingress: %.0f %s/s, rejected by congestion groups: %.0f %s/s (%.2f%%)\n",
+	       ingress, unit, total, unit,
+	       ingress > total ? 100 * total / ingress : total ? 100.0 : 0.0);
+	printf("discarded: %.0f frames/s, no buffer: %.0f frames/s\n",
+	       dpni_cg_rate(cur->discarded_frames, prev->discarded_frames,
+			    secs),
+	       dpni_cg_rate(cur->nobuffer_discards, prev->nobuffer_discards,
+			    secs));
+
+	printf("%4s", "tc/q");
+	for (int q = 0; q < map->num_queues; q++)
+		if (in_dpni_stats_set(map->queues, q))
+			printf("%3d", q);
+	printf(" %14s\n", "rejected/s");
+
+	for (int tc = 0; tc < map->num_tcs; tc++) {
+		double tc_total = 0;
+
+		if (!in_dpni_stats_set(map->tcs, tc))
+			continue;
+
+		printf("%3d ", tc);
+		for (int q = 0; q < map->num_queues; q++) {
+			int i = q * map->num_tcs + tc;
+			double rate;
+			char shade;
+
+			if (!in_dpni_stats_set(map->queues, q))
+				continue;
+
+			rate = dpni_cg_rate(cur->rejects[i], prev->rejects[i],
+					    secs);
+			shade = cg_shades[rate <= 0 ? 0 :
+				1 + (int)((sizeof(cg_shades) - 3) * rate / max)];
+			printf("  %c", shade);
+			tc_total += rate;
+		}
+		printf(" %14.0f\n", tc_total);
+	}
+
+	if (max > 0)
+		printf("scale: '%c' up to %.0f %s/s\n",
+		       cg_shades[sizeof(cg_shades) - 2], max, unit);
+	printf("\n");
+}
+
+static void print_dpni_cg_json(uint32_t dpni_id,
+			       const struct dpni_cg_map *map,
+			       const struct dpni_cg_sample *cur,
+			       const struct dpni_cg_sample *prev,
+			       double secs)
+{
+	bool first_tc = true;
+
+	printf("{ \"dpni\": \"dpni.%u\", \"unit\": \"%s/s\", \"interval\": %.3f, ",
+	       dpni_id, map->bytes ? "bytes" : "frames", secs);
+	printf("\"ingress\": %.0f, \"discarded\": %.0f, \"nobuffer\": %.0f, ",
+	       dpni_cg_rate(cur->ingress_frames, prev->ingress_frames, secs),
+	       dpni_cg_rate(cur->discarded_frames, prev->discarded_frames,
+			    secs),
+	       dpni_cg_rate(cur->nobuffer_discards, prev->nobuffer_discards,
+			    secs));
+	printf("\"rejected\": {");
+	for (int tc = 0; tc < map->num_tcs; tc++) {
+		bool first_q = true;
+
+		if (!in_dpni_stats_set(map->tcs, tc))
+			continue;
+
+		printf("%s \"%d\": [", first_tc ? "" : ",", tc);
+		first_tc = false;
+		for (int q = 0; q < map->num_queues; q++) {
+			int i = q * map->num_tcs + tc;
+
+			if (!in_dpni_stats_set(map->queues, q))
+				continue;
+
+			printf("%s%.0f", first_q ? "" : ", ",
+			       dpni_cg_rate(cur->rejects[i], prev->rejects[i],
+					    secs));
+			first_q = false;
+		}
+		printf("]");
+	}
+	printf(" } }\n");
+}
+
+/**
+ * Sample the congestion counters of a DPNI on every interval of the watch
+ * and print the reject rate of each traffic class and queue
+ */
+static int dpni_congestion(uint32_t dpni_id, const struct dpni_stats_set *tcs,
+			   const struct dpni_stats_set *queues,
+			   struct watch *watch, bool bytes, bool json)
+{
+	struct dpni_cg_sample samples[2] = { { .rejects = NULL } };
+	struct dpni_cg_map map = {
+		.tcs = tcs,
+		.queues = queues,
+		.bytes = bytes,
+	};
+	struct dpni_attr_v10 dpni_attr;
+	bool dpni_opened = false;
+	int error, error2;
+
+	error = dpni_open_v10(&restool.mc_io, 0, dpni_id, &map.dpni_handle);
+	if (error < 0) {
+		mc_status = flib_error_to_mc_status(error);
+		ERROR_PRINTF("MC error: %s (status %#x)\n",
+			     mc_status_to_string(mc_status), mc_status);
+		goto out;
+	}
+	dpni_opened = true;
+	if (0 == map.dpni_handle) {
+		DEBUG_PRINTF(
+			"dpni_open() returned invalid handle (auth 0) for dpni.%u\n",
+			dpni_id);
+		error = -ENOENT;
+		goto out;
+	}
+
+	memset(&dpni_attr, 0, sizeof(dpni_attr));
+	error = dpni_get_attributes_v10(&restool.mc_io, 0, map.dpni_handle,
+					&dpni_attr);
+	if (error < 0) {
+		mc_status = flib_error_to_mc_status(error);
+		ERROR_PRINTF("MC error: %s (status %#x)\n",
+			     mc_status_to_string(mc_status), mc_status);
+		goto out;
+	}
+
+	map.num_tcs = dpni_attr.num_rx_tcs;
+	map.num_queues = dpni_attr.options & DPNI_OPT_CUSTOM_CG ?
+			 dpni_attr.num_queues : 1;
+	for (int i = 0; i < 2; i++) {
+		samples[i].rejects = calloc(map.num_queues * map.num_tcs,
+					    sizeof(*samples[i].rejects));
+		if (!samples[i].rejects) {
+			error = -ENOMEM;
+			goto out;
+		}
+	}
+
+	error = read_dpni_cg_sample(&map, &samples[0]);
+	if (error < 0) {
+		mc_status = flib_error_to_mc_status(error);
+		ERROR_PRINTF("MC error: %s (status %#x)\n",
+			     mc_status_to_string(mc_status), mc_status);
+		goto out;
+	}
+
+	watch_start(watch);
+	while (watch_next(watch)) {
+		unsigned int n = watch->samples;
+		struct dpni_cg_sample *cur = &samples[n % 2];
+		struct dpni_cg_sample *prev = &samples[(n + 1) % 2];
+		double secs;
+
+		error = read_dpni_cg_sample(&map, cur);
+		if (error < 0) {
+			mc_status = flib_error_to_mc_status(error);
+			ERROR_PRINTF("MC error: %s (status %#x)\n",
+				     mc_status_to_string(mc_status), mc_status);
+			break;
+		}
+
+		secs = timespec_elapsed(&prev->time, &cur->time);
+		if (json) {
+			print_dpni_cg_json(dpni_id, &map, cur, prev, secs);
+		} else {
+			printf("dpni.%u congestion, sample %u over %.1f s:\n",
+			       dpni_id, n, secs);
+			print_dpni_cg_heatmap(&map, cur, prev, secs);
+		}
+		fflush(stdout);
+	}
+
+	watch_stop(watch);
+out:
+	free(samples[0].rejects);
+	free(samples[1].rejects);
+	if (dpni_opened) {
+		error2 = dpni_close_v10(&restool.mc_io, 0, map.dpni_handle);
+		if (error2 < 0) {
+			mc_status = flib_error_to_mc_status(error2);
+			ERROR_PRINTF("MC error: %s (status %#x)\n",
+				     mc_status_to_string(mc_status), mc_status);
+			if (error == 0)
+				error = error2;
+		}
+	}
+
+	return error;
+}
+
+static int cmd_dpni_congestion_v10(void)
+{
+	static const char usage_msg[] =
+		"\n"
+		"Usage: restool dpni congestion <dpni-object> [--interval=<ms>]\n"
+		"	[--count=<n>] [--duration=<seconds>] [--tc=<list>]\n"
+		"	[--queue=<list>] [--bytes] [--json]\n"
+		"\n"
+		"  Samples the congestion group rejects of a DPNI and shows their\n"
+		"  rate as a heatmap, along with the Rx frame rate and the\n"
+		"  discards. The heatmap has one row per Rx traffic class, and\n"
+		"  one column per queue when the DPNI has DPNI_OPT_CUSTOM_CG or a\n"
+		"  single column otherwise.\n"
+		"\n"
+		"OPTIONS:\n"
+		"--interval=<ms>\n"
+		"   Samples every <ms> milliseconds until interrupted. Without\n"
+		"   it, a single interval of 1000 ms is sampled.\n"
+		"--count=<n>\n"
+		"   Stops after <n> intervals\n"
+		"--duration=<seconds>\n"
+		"   Stops after <seconds>\n"
+		"--tc=<list>, --queue=<list>\n"
+		"   Only samples these traffic classes or queues, e.g. 0,2,4-7\n"
+		"--bytes\n"
+		"   Shows byte rates instead of frame rates\n"
+		"--json\n"
+		"   Prints one JSON object per sample\n"
+		"\n"
+		"EXAMPLE:\n"
+		"   $ restool dpni congestion dpni.5 --interval=500 --count=10\n"
+		"\n";
+
+	struct dpni_stats_set tcs = { .all = true };
+	struct dpni_stats_set queues = { .all = true };
+	struct watch watch = {
+		.interval_ms = 1000,
+		.count = 1,
+	};
+	bool bytes = false;
+	bool json = false;
+	uint32_t dpni_id;
+	int error;
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(CONGESTION_OPT_HELP)) {
+		puts(usage_msg);
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(CONGESTION_OPT_HELP);
+		return 0;
+	}
+
+	if (restool.obj_name == NULL) {
+		ERROR_PRINTF("<object> argument missing\n");
+		puts(usage_msg);
+		return -EINVAL;
+	}
+
+	error = parse_object_name(restool.obj_name, "dpni", &dpni_id);
+	if (error < 0)
+		return error;
+
+	error = get_watch_options(&watch, CONGESTION_OPT_INTERVAL,
+				  CONGESTION_OPT_COUNT, CONGESTION_OPT_DURATION);
+	if (error < 0)
+		return error;
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(CONGESTION_OPT_TC)) {
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(CONGESTION_OPT_TC);
+		error = parse_dpni_stats_set(CONGESTION_OPT_TC, "TC", &tcs,
+					     UINT8_MAX);
+		if (error < 0)
+			return error;
+	}
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(CONGESTION_OPT_QUEUE)) {
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(CONGESTION_OPT_QUEUE);
+		error = parse_dpni_stats_set(CONGESTION_OPT_QUEUE, "queue",
+					     &queues, UINT8_MAX);
+		if (error < 0)
+			return error;
+	}
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(CONGESTION_OPT_BYTES)) {
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(CONGESTION_OPT_BYTES);
+		bytes = true;
+	}
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(CONGESTION_OPT_JSON)) {
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(CONGESTION_OPT_JSON);
+		json = true;
+	}
+
+	return dpni_congestion(dpni_id, &tcs, &queues, &watch, bytes, json);
+}
+
 struct object_command dpni_commands_v9[] = {
 	{ .cmd_name = "--help",
 	  .options = NULL,
@@ -2163,6 +2868,10 @@ struct object_command dpni_commands_v10[] = {
 	  .options = dpni_update_options_v10,
 	  .cmd_func = cmd_dpni_update_v10 },
 
+	{ .cmd_name = "congestion",
+	  .options = dpni_congestion_options,
+	  .cmd_func = cmd_dpni_congestion_v10 },
+
 	{ .cmd_name = NULL },
 };
 
@@ -38,10 +38,15 @@
 #include <assert.h>
 #include <getopt.h>
 #include <math.h>
+#include <fnmatch.h>
+#include <time.h>
 #include <sys/ioctl.h>
 #include "restool.h"
 #include "utils.h"
 #include "dprc_commands_generate_dpl.h"
+#include "mc_sched.h"
+#include "obj_index.h"
+#include "librestool.h"
 
 #define ALL_DPRC_OPTS (				\
 	DPRC_CFG_OPT_SPAWN_ALLOWED |		\
@@ -99,6 +104,7 @@ enum dprc_show_options {
 	SHOW_OPT_HELP = 0,
 	SHOW_OPT_RESOURCES,
 	SHOW_OPT_RES_TYPE,
+	SHOW_OPT_JSON,
 };
 
 static struct option dprc_show_options[] = {
@@ -115,6 +121,10 @@ static struct option dprc_show_options[] = {
 		.has_arg = 1,
 	},
 
+	[SHOW_OPT_JSON] = {
+		.name = "json",
+	},
+
 	{ 0 },
 };
 
@@ -258,6 +268,35 @@ static struct option dprc_set_label_options[] = {
 
 C_ASSERT(ARRAY_SIZE(dprc_set_label_options) <= MAX_NUM_CMD_LINE_OPTIONS + 1);
 
+/**
+ * dprc find command options
+ */
+enum dprc_find_options {
+	FIND_OPT_HELP = 0,
+	FIND_OPT_LABEL,
+	FIND_OPT_TYPE,
+};
+
+static struct option dprc_find_options[] = {
+	[FIND_OPT_HELP] = {
+		.name = "help",
+	},
+
+	[FIND_OPT_LABEL] = {
+		.name = "label",
+		.has_arg = 1,
+	},
+
+	[FIND_OPT_TYPE] = {
+		.name = "type",
+		.has_arg = 1,
+	},
+
+	{ 0 },
+};
+
+C_ASSERT(ARRAY_SIZE(dprc_find_options) <= MAX_NUM_CMD_LINE_OPTIONS + 1);
+
 /**
  * dprc set-locked command options
  */
@@ -279,9 +318,18 @@ static struct option dprc_set_locked_options[] = {
 	{ 0 },
 };
 
+C_ASSERT(ARRAY_SIZE(dprc_set_locked_options) <= MAX_NUM_CMD_LINE_OPTIONS + 1);
+
+/**
+ * dprc dump-mem command options
+ */
 enum dprc_dump_mem_options {
 	DUMP_MEM_OPT_HELP = 0,
 	DUMP_MEM_OPT_PART,
+	DUMP_MEM_OPT_ANALYZE,
+	DUMP_MEM_OPT_WATCH,
+	DUMP_MEM_OPT_COUNT,
+	DUMP_MEM_OPT_DURATION,
 };
 
 static struct option dprc_dump_mem_options[] = {
@@ -294,10 +342,29 @@ static struct option dprc_dump_mem_options[] = {
 		.has_arg = 1,
 	},
 
+	[DUMP_MEM_OPT_ANALYZE] = {
+		.name = "analyze",
+	},
+
+	[DUMP_MEM_OPT_WATCH] = {
+		.name = "watch",
+		.has_arg = 1,
+	},
+
+	[DUMP_MEM_OPT_COUNT] = {
+		.name = "count",
+		.has_arg = 1,
+	},
+
+	[DUMP_MEM_OPT_DURATION] = {
+		.name = "duration",
+		.has_arg = 1,
+	},
+
 	{ 0 },
 };
 
-C_ASSERT(ARRAY_SIZE(dprc_set_locked_options) <= MAX_NUM_CMD_LINE_OPTIONS + 1);
+C_ASSERT(ARRAY_SIZE(dprc_dump_mem_options) <= MAX_NUM_CMD_LINE_OPTIONS + 1);
 
 /**
  * dprc connect command options
@@ -308,6 +375,7 @@ enum dprc_connect_options {
 	CONNECT_OPT_ENDPOINT2,
 	CONNECT_OPT_COMMITTED_RATE,
 	CONNECT_OPT_MAX_RATE,
+	CONNECT_OPT_FROM_FILE,
 };
 
 static struct option dprc_connect_options[] = {
@@ -338,6 +406,11 @@ static struct option dprc_connect_options[] = {
 		.flag = NULL,
 		.val = 0,
 	},
+
+	[CONNECT_OPT_FROM_FILE] = {
+		.name = "from-file",
+		.has_arg = 1,
+	},
 	{ 0 },
 };
 
@@ -349,6 +422,7 @@ C_ASSERT(ARRAY_SIZE(dprc_connect_options) <= MAX_NUM_CMD_LINE_OPTIONS + 1);
 enum dprc_disconnect_options {
 	DISCONNECT_OPT_HELP = 0,
 	DISCONNECT_OPT_ENDPOINT,
+	DISCONNECT_OPT_FROM_FILE,
 };
 
 static struct option dprc_disconnect_options[] = {
@@ -361,6 +435,11 @@ static struct option dprc_disconnect_options[] = {
 		.has_arg = 1,
 	},
 
+	[DISCONNECT_OPT_FROM_FILE] = {
+		.name = "from-file",
+		.has_arg = 1,
+	},
+
 	{ 0 },
 };
 
@@ -417,6 +496,7 @@ static int cmd_dprc_help(void)
 		"                  change an object's plugged state\n"
 		"   unassign     - moves an object from a child container to a parent container.\n"
 		"   set-label    - sets label/alias for any objects except root container.\n"
+		"   find         - lists the objects whose label matches a pattern.\n"
 		"   set-locked   - lock/unlock a child container.\n"
 		"   connect      - connects 2 objects, creating a link between them.\n"
 		"   disconnect   - removes the link between two objects. Either endpoint can\n"
@@ -433,11 +513,20 @@ static int cmd_dprc_help(void)
 
 static int cmd_dprc_sync(void)
 {
+	uint32_t dprc_id = RESCAN_ALL_CONTAINERS;
 	int error;
 
 	static const char usage_msg[] =
 		"\n"
-		"Usage: restool dprc sync\n"
+		"Usage: restool dprc sync [<container>]\n"
+		"\n"
+		"  <container>\n"
+		"    Only rescan the objects of this container. By default the\n"
+		"    entire fsl-mc bus is rescanned.\n"
+		"\n"
+		"EXAMPLE:\n"
+		"Synchronize the objects of dprc.2 with the fsl-mc bus:\n"
+		"   $ restool dprc sync dprc.2\n"
 		"\n";
 
 	if (restool.cmd_option_mask & ONE_BIT_MASK(SYNC_OPT_HELP)) {
@@ -447,22 +536,17 @@ static int cmd_dprc_sync(void)
 	}
 
 	if (restool.obj_name != NULL) {
-		ERROR_PRINTF(
-			"Unexpected argument: \'%s\'\n\n", restool.obj_name);
-		puts(usage_msg);
-		return -EINVAL;
+		error = parse_object_name(restool.obj_name, "dprc", &dprc_id);
+		if (error < 0) {
+			puts(usage_msg);
+			return error;
+		}
 	}
 
-	DEBUG_PRINTF("calling sytem()\n");
-	error = system("echo 1 > /sys/bus/fsl-mc/rescan");
-	if (error == -1) {
-		error = -errno;
-		DEBUG_PRINTF(
-			"system() failed with error %d\n",
-			error);
-	}
+	/* the rescan itself is issued once, right before restool exits */
+	request_rescan(dprc_id);
 
-	return error;
+	return 0;
 }
 
 /**
@@ -602,141 +686,416 @@ static int cmd_dprc_list(void)
 			 full_path ? "" : NULL);
 }
 
-static int show_one_resource_type(uint16_t dprc_handle,
-				      const char *mc_res_type)
+/* a range of resource ids, both ends included */
+struct res_range {
+	int base_id;
+	int last_id;
+};
+
+/* the ids of one resource type of a container, as a set of intervals */
+struct res_pool {
+	char type[RES_TYPE_MAX_LENGTH + 1];
+	int count;
+	unsigned int num_ranges;
+	struct res_range *ranges;
+	int error;
+};
+
+static int cmp_res_ranges(const void *a, const void *b)
+{
+	const struct res_range *ra = a;
+	const struct res_range *rb = b;
+
+	return (ra->base_id > rb->base_id) - (ra->base_id < rb->base_id);
+}
+
+/* sort the ranges and merge the ones which overlap or are contiguous */
+static void merge_res_ranges(struct res_pool *pool)
+{
+	unsigned int n = 0;
+
+	if (pool->num_ranges < 2)
+		return;
+
+	qsort(pool->ranges, pool->num_ranges, sizeof(*pool->ranges),
+	      cmp_res_ranges);
+	for (unsigned int i = 1; i < pool->num_ranges; i++) {
+		struct res_range *last = &pool->ranges[n];
+		struct res_range *range = &pool->ranges[i];
+
+		if ((int64_t)range->base_id <= (int64_t)last->last_id + 1) {
+			if (range->last_id > last->last_id)
+				last->last_id = range->last_id;
+		} else {
+			pool->ranges[++n] = *range;
+		}
+	}
+
+	pool->num_ranges = n + 1;
+}
+
+/**
+ * Read the count and all the id ranges of one resource type, merged into
+ * as few ranges as possible
+ */
+static int get_res_pool(struct fsl_mc_io *mc_io, uint16_t dprc_handle,
+			struct res_pool *pool)
 {
-	int res_count;
-	int res_discovered_count;
 	struct dprc_res_ids_range_desc range_desc;
+	unsigned int max_ranges = 0;
+	int64_t discovered = 0;
 	int error;
 
-	error = dprc_get_res_count(&restool.mc_io, 0, dprc_handle,
-				   (char *)mc_res_type, &res_count);
-	if (error < 0) {
-		mc_status = flib_error_to_mc_status(error);
-		ERROR_PRINTF("MC error: %s (status %#x)\n",
-			     mc_status_to_string(mc_status), mc_status);
-		goto out;
-	}
+	pool->num_ranges = 0;
+	pool->ranges = NULL;
+	error = dprc_get_res_count(mc_io, 0, dprc_handle, pool->type,
+				   &pool->count);
+	if (error < 0)
+		return error;
 
-	if (res_count == 0) {
-		printf("Don't have any %s resource\n", mc_res_type);
-		goto out;
-	}
+	memset(&range_desc, 0, sizeof(range_desc));
+	while (discovered < pool->count &&
+	       range_desc.iter_status != DPRC_ITER_STATUS_LAST) {
+		error = dprc_get_res_ids(mc_io, 0, dprc_handle, pool->type,
+					 &range_desc);
+		if (error < 0)
+			return error;
 
-	memset(&range_desc, 0, sizeof(struct dprc_res_ids_range_desc));
-	res_discovered_count = 0;
-	do {
-		int id;
+		if (range_desc.last_id < range_desc.base_id)
+			break;
 
-		error = dprc_get_res_ids(&restool.mc_io, 0, dprc_handle,
-					 (char *)mc_res_type, &range_desc);
-		if (error < 0) {
-			mc_status = flib_error_to_mc_status(error);
-			ERROR_PRINTF("MC error: %s (status %#x)\n",
-				     mc_status_to_string(mc_status), mc_status);
-			goto out;
+		if (pool->num_ranges == max_ranges) {
+			struct res_range *ranges;
+
+			max_ranges = max_ranges ? 2 * max_ranges : 16;
+			ranges = realloc(pool->ranges,
+					 max_ranges * sizeof(*ranges));
+			if (!ranges)
+				return -ENOMEM;
+			pool->ranges = ranges;
 		}
 
-		if (range_desc.base_id == range_desc.last_id)
-			printf("%s.%d\n", mc_res_type, range_desc.base_id);
+		pool->ranges[pool->num_ranges].base_id = range_desc.base_id;
+		pool->ranges[pool->num_ranges].last_id = range_desc.last_id;
+		pool->num_ranges++;
+		discovered += (int64_t)range_desc.last_id -
+			      range_desc.base_id + 1;
+	}
+
+	merge_res_ranges(pool);
+	return 0;
+}
+
+static void print_res_pool(const struct res_pool *pool, bool json,
+			   bool first)
+{
+	if (json) {
+		printf("%s\n    { \"type\": \"%s\", \"count\": %d, \"ranges\": [",
+		       first ? "" : ",", pool->type, pool->count);
+		for (unsigned int i = 0; i < pool->num_ranges; i++)
+			printf("%s[%d, %d]", i ? ", " : "",
+			       pool->ranges[i].base_id,
+			       pool->ranges[i].last_id);
+		printf("] }");
+		return;
+	}
+
+	printf("%s: %d\n", pool->type, pool->count);
+	for (unsigned int i = 0; i < pool->num_ranges; i++) {
+		const struct res_range *range = &pool->ranges[i];
+
+		if (range->base_id == range->last_id)
+			printf("    %s.%d\n", pool->type, range->base_id);
 		else
-			printf("%s.%d - %s.%d\n",
-			       mc_res_type, range_desc.base_id,
-			       mc_res_type, range_desc.last_id);
+			printf("    %s.%d - %s.%d (%d)\n",
+			       pool->type, range->base_id,
+			       pool->type, range->last_id,
+			       range->last_id - range->base_id + 1);
+	}
+}
+
+static void print_res_pools_start(const char *dprc_name, bool json)
+{
+	if (json)
+		printf("{\n  \"container\": \"%s\",\n  \"resources\": [",
+		       dprc_name);
+}
 
-		for (id = range_desc.base_id; id <= range_desc.last_id; id++)
-			res_discovered_count++;
+static void print_res_pools_end(bool json)
+{
+	if (json)
+		printf("\n  ]\n}\n");
+}
 
-	} while (res_discovered_count < res_count &&
-		 range_desc.iter_status != DPRC_ITER_STATUS_LAST);
-out:
-	return error;
+struct res_pool_task {
+	uint32_t dprc_id;
+	struct res_pool *pool;
+};
+
+static int res_pool_task_run(struct fsl_mc_io *mc_io, void *arg)
+{
+	struct res_pool_task *task = arg;
+	uint16_t dprc_handle;
+	int error2;
+
+	task->pool->error = dprc_open(mc_io, 0, task->dprc_id, &dprc_handle);
+	if (task->pool->error < 0)
+		return task->pool->error;
+
+	task->pool->error = get_res_pool(mc_io, dprc_handle, task->pool);
+	error2 = dprc_close(mc_io, 0, dprc_handle);
+
+	return task->pool->error ? task->pool->error : error2;
 }
 
-static int show_one_resource_type_count(uint16_t dprc_handle,
-				      const char *mc_res_type)
+/**
+ * Read the resource pools of a container, one pool per task spread over
+ * several MC portals when --jobs allows it
+ */
+static int get_res_pools(uint32_t dprc_id, uint16_t dprc_handle,
+			 struct res_pool *pools, int num_pools)
 {
-	int res_count = -1;
+	struct res_pool_task *tasks;
+	struct mc_sched *sched;
 	int error;
 
-	error = dprc_get_res_count(&restool.mc_io, 0, dprc_handle,
-				   (char *)mc_res_type, &res_count);
-	if (error < 0) {
-		mc_status = flib_error_to_mc_status(error);
-		ERROR_PRINTF("MC error: %s (status %#x)\n",
-			     mc_status_to_string(mc_status), mc_status);
+	/* the pools whose type could not be read keep their error */
+	if (restool.num_jobs <= 1 || num_pools <= 1) {
+		for (int i = 0; i < num_pools; i++)
+			if (pools[i].error == 0)
+				pools[i].error = get_res_pool(&restool.mc_io,
+							      dprc_handle,
+							      &pools[i]);
+		return 0;
+	}
+
+	tasks = calloc(num_pools, sizeof(*tasks));
+	if (!tasks)
+		return -ENOMEM;
+
+	error = mc_sched_create(&sched, &restool.mc_io, restool.device_file,
+				restool.num_jobs, restool.max_in_flight);
+	if (error < 0)
 		goto out;
+
+	for (int i = 0; i < num_pools; i++) {
+		if (pools[i].error < 0)
+			continue;
+
+		tasks[i].dprc_id = dprc_id;
+		tasks[i].pool = &pools[i];
+		error = mc_sched_submit(sched, res_pool_task_run, &tasks[i]);
+		if (error < 0)
+			break;
 	}
 
-	assert(res_count >= 0);
-	printf("%s: %d\n", mc_res_type, res_count);
+	/* the errors are reported per pool */
+	(void)mc_sched_wait(sched);
+	mc_sched_destroy(sched);
 out:
+	free(tasks);
 	return error;
 }
 
 /**
- * List resources of all types found in the container specified by dprc_handle
+ * Show the resources of one type (res_type) or of all the types found in
+ * the container, with their ids merged into ranges
  */
-static int show_mc_resources(uint16_t dprc_handle)
+static int show_mc_resources(uint32_t dprc_id, uint16_t dprc_handle,
+			     const char *dprc_name, const char *res_type,
+			     bool json)
 {
-	int pool_count;
-	char res_type[RES_TYPE_MAX_LENGTH + 1];
-	int error;
+	struct res_pool *pools = NULL;
+	int pool_count = 1;
 	int ret_error = 0;
+	int error;
+
+	if (!res_type) {
+		error = dprc_get_pool_count(&restool.mc_io, 0, dprc_handle,
+					    &pool_count);
+		if (error < 0) {
+			mc_status = flib_error_to_mc_status(error);
+			ERROR_PRINTF("MC error: %s (status %#x)\n",
+				     mc_status_to_string(mc_status), mc_status);
+			return error;
+		}
+
+		assert(pool_count >= 0);
+		if (pool_count == 0 && !json) {
+			printf("Don't have any resource in current dprc container.\n");
+			return 0;
+		}
+	}
+
+	pools = calloc(pool_count + 1, sizeof(*pools));
+	if (!pools)
+		return -ENOMEM;
+
+	if (res_type) {
+		strncpy(pools[0].type, res_type, RES_TYPE_MAX_LENGTH);
+	} else {
+		for (int i = 0; i < pool_count; i++) {
+			error = dprc_get_pool(&restool.mc_io, 0, dprc_handle,
+					      i, pools[i].type);
+
+			/* check for buffer overrun: */
+			assert(pools[i].type[RES_TYPE_MAX_LENGTH] == '\0');
+			if (error < 0) {
+				DEBUG_PRINTF(
+					"dprc_get_pool() failed for pool index %d (error: %d)\n",
+					i, error);
+				pools[i].error = error;
+			}
+		}
+	}
 
-	error = dprc_get_pool_count(&restool.mc_io, 0, dprc_handle,
-				    &pool_count);
+	error = get_res_pools(dprc_id, dprc_handle, pools, pool_count);
 	if (error < 0) {
-		mc_status = flib_error_to_mc_status(error);
-		ERROR_PRINTF("MC error: %s (status %#x)\n",
-			     mc_status_to_string(mc_status), mc_status);
+		ret_error = error;
 		goto out;
 	}
 
-	assert(pool_count >= 0);
-	if (0 == pool_count) {
-		printf("Don't have any resource in current dprc container.\n");
-		return 0;
+	print_res_pools_start(dprc_name, json);
+	for (int i = 0, printed = 0; i < pool_count; i++) {
+		if (pools[i].error < 0) {
+			mc_status = flib_error_to_mc_status(pools[i].error);
+			if (pools[i].type[0] == '\0')
+				ERROR_PRINTF("pool %d: MC error: %s (status %#x)\n",
+					     i, mc_status_to_string(mc_status),
+					     mc_status);
+			else
+				ERROR_PRINTF("%s: MC error: %s (status %#x)\n",
+					     pools[i].type,
+					     mc_status_to_string(mc_status),
+					     mc_status);
+			if (ret_error == 0)
+				ret_error = pools[i].error;
+			continue;
+		}
+
+		if (res_type && pools[i].count == 0 && !json) {
+			printf("Don't have any %s resource\n", res_type);
+			continue;
+		}
+
+		print_res_pool(&pools[i], json, printed++ == 0);
 	}
-	for (int i = 0; i < pool_count; i++) {
-		memset(res_type, 0, sizeof(res_type));
-		error = dprc_get_pool(&restool.mc_io, 0, dprc_handle,
-				      i, res_type);
+	print_res_pools_end(json);
+out:
+	for (int i = 0; i < pool_count; i++)
+		free(pools[i].ranges);
+	free(pools);
+	return ret_error;
+}
 
-		/* check for buffer overrun: */
-		assert(res_type[sizeof(res_type) - 1] == '\0');
+static int get_obj_descs(struct fsl_mc_io *mc_io, uint16_t dprc_handle,
+			 int first, int count, struct dprc_obj_desc *obj_descs)
+{
+	int error;
 
+	for (int i = first; i < first + count; i++) {
+		memset(&obj_descs[i], 0, sizeof(obj_descs[i]));
+		error = dprc_get_obj(mc_io, 0, dprc_handle, i, &obj_descs[i]);
 		if (error < 0) {
 			DEBUG_PRINTF(
-				"dprc_get_pool() failed for pool index %d (error: %d)\n",
+				"dprc_get_object(%u) failed with error %d\n",
 				i, error);
-			if (ret_error == 0)
-				ret_error = error;
-
-			continue;
+			return error;
 		}
+	}
 
-		DEBUG_PRINTF("pool index %d: ", i);
-		error = show_one_resource_type_count(dprc_handle, res_type);
-		if (error < 0) {
-			if (ret_error == 0)
-				ret_error = error;
+	return 0;
+}
 
-			continue;
-		}
+/**
+ * Number of objects read by one task of a concurrent 'dprc show': enough
+ * to amortize opening the container on the worker's own portal
+ */
+#define SHOW_OBJS_PER_TASK	16
+
+struct show_objs_task {
+	uint32_t dprc_id;
+	int first;
+	int count;
+	struct dprc_obj_desc *obj_descs;
+};
+
+static int show_objs_task_run(struct fsl_mc_io *mc_io, void *arg)
+{
+	struct show_objs_task *task = arg;
+	uint16_t dprc_handle;
+	int error, error2;
+
+	error = dprc_open(mc_io, 0, task->dprc_id, &dprc_handle);
+	if (error < 0)
+		return error;
+
+	error = get_obj_descs(mc_io, dprc_handle, task->first, task->count,
+			      task->obj_descs);
+
+	error2 = dprc_close(mc_io, 0, dprc_handle);
+	if (error == 0)
+		error = error2;
+
+	return error;
+}
+
+/**
+ * Read the descriptors of the objects of a container, spreading the reads
+ * over several MC portals when --jobs allows it
+ */
+static int get_all_obj_descs(uint32_t dprc_id, uint16_t dprc_handle,
+			     int num_objs, struct dprc_obj_desc *obj_descs)
+{
+	struct show_objs_task *tasks;
+	int num_tasks;
+	struct mc_sched *sched;
+	int error;
+
+	num_tasks = (num_objs + SHOW_OBJS_PER_TASK - 1) / SHOW_OBJS_PER_TASK;
+	if (restool.num_jobs <= 1 || num_tasks <= 1)
+		return get_obj_descs(&restool.mc_io, dprc_handle, 0, num_objs,
+				     obj_descs);
+
+	tasks = calloc(num_tasks, sizeof(*tasks));
+	if (!tasks)
+		return -ENOMEM;
+
+	error = mc_sched_create(&sched, &restool.mc_io, restool.device_file,
+				restool.num_jobs, restool.max_in_flight);
+	if (error < 0)
+		goto out;
+
+	for (int i = 0; i < num_tasks; i++) {
+		tasks[i].dprc_id = dprc_id;
+		tasks[i].first = i * SHOW_OBJS_PER_TASK;
+		tasks[i].count = num_objs - tasks[i].first;
+		if (tasks[i].count > SHOW_OBJS_PER_TASK)
+			tasks[i].count = SHOW_OBJS_PER_TASK;
+		tasks[i].obj_descs = obj_descs;
+
+		error = mc_sched_submit(sched, show_objs_task_run, &tasks[i]);
+		if (error < 0)
+			break;
 	}
+
+	if (error == 0)
+		error = mc_sched_wait(sched);
+	mc_sched_destroy(sched);
 out:
-	return ret_error;
+	free(tasks);
+	return error;
 }
 
-static int show_mc_objects(uint16_t dprc_handle, const char *dprc_name)
+static int show_mc_objects(uint32_t dprc_id, uint16_t dprc_handle,
+			   const char *dprc_name)
 {
 	int num_child_devices;
 	int error;
 	int width;
 	int labelen;
 	char plug_stat[10] = {'\0'};
+	struct dprc_obj_desc *obj_descs = NULL;
 	struct dprc_obj_desc obj_desc;
 
 	error = dprc_get_obj_count(&restool.mc_io, 0,
@@ -749,23 +1108,26 @@ static int show_mc_objects(uint16_t dprc_handle, const char *dprc_name)
 		goto out;
 	}
 
+	if (num_child_devices > 0) {
+		obj_descs = calloc(num_child_devices, sizeof(*obj_descs));
+		if (!obj_descs) {
+			error = -ENOMEM;
+			goto out;
+		}
+
+		error = get_all_obj_descs(dprc_id, dprc_handle,
+					  num_child_devices, obj_descs);
+		if (error < 0)
+			goto out;
+	}
+
 	printf("%s contains %u objects%c\n", dprc_name, num_child_devices,
 	       num_child_devices == 0 ? '.' : ':');
 	printf("object\t\tlabel\t\tplugged-state\n");
 
 	for (int i = 0; i < num_child_devices; i++) {
 		plug_stat[0] = '\0';
-		memset(&obj_desc, 0, sizeof(obj_desc));
-		error = dprc_get_obj(&restool.mc_io, 0,
-				     dprc_handle,
-				     i,
-				     &obj_desc);
-		if (error < 0) {
-			DEBUG_PRINTF(
-				"dprc_get_object(%u) failed with error %d\n",
-				i, error);
-			goto out;
-		}
+		obj_desc = obj_descs[i];
 		assert(strlen(obj_desc.label) <= MC_OBJ_LABEL_MAX_LENGTH);
 
 		if (obj_desc.id < 0)
@@ -808,6 +1170,7 @@ static int show_mc_objects(uint16_t dprc_handle, const char *dprc_name)
 
 	error = 0;
 out:
+	free(obj_descs);
 	return error;
 }
 
@@ -815,7 +1178,18 @@ static int cmd_dprc_show(void)
 {
 	static const char usage_msg[] =
 		"\n"
-		"Usage: restool dprc show <container>\n"
+		"Usage: restool dprc show <container> [OPTIONS]\n"
+		"\n"
+		"  Lists the objects of the container by default.\n"
+		"\n"
+		"OPTIONS:\n"
+		"--resources\n"
+		"   Lists the resources of all types of the container, with\n"
+		"   their count and their ids merged into ranges.\n"
+		"--resource-type=<type>\n"
+		"   Only lists the resources of this type.\n"
+		"--json\n"
+		"   Prints the resources in JSON format.\n"
 		"\n";
 
 	uint32_t dprc_id;
@@ -824,6 +1198,7 @@ static int cmd_dprc_show(void)
 	int error;
 	bool dprc_opened = false;
 	const char *res_type;
+	bool json = false;
 
 	if (restool.cmd_option_mask & ONE_BIT_MASK(SHOW_OPT_HELP)) {
 		puts(usage_msg);
@@ -857,10 +1232,12 @@ static int cmd_dprc_show(void)
 		dprc_handle = restool.root_dprc_handle;
 	}
 
-	if (restool.cmd_option_mask & ONE_BIT_MASK(SHOW_OPT_RESOURCES)) {
-		restool.cmd_option_mask &= ~ONE_BIT_MASK(SHOW_OPT_RESOURCES);
-		error = show_mc_resources(dprc_handle);
-	} else if (restool.cmd_option_mask & ONE_BIT_MASK(SHOW_OPT_RES_TYPE)) {
+	if (restool.cmd_option_mask & ONE_BIT_MASK(SHOW_OPT_JSON)) {
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(SHOW_OPT_JSON);
+		json = true;
+	}
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(SHOW_OPT_RES_TYPE)) {
 		assert(restool.cmd_option_args[SHOW_OPT_RES_TYPE] != NULL);
 		error = check_resource_type(
 			restool.cmd_option_args[SHOW_OPT_RES_TYPE]);
@@ -869,10 +1246,20 @@ static int cmd_dprc_show(void)
 			goto out;
 		}
 		res_type = restool.cmd_option_args[SHOW_OPT_RES_TYPE];
-		restool.cmd_option_mask &= ~ONE_BIT_MASK(SHOW_OPT_RES_TYPE);
-		error = show_one_resource_type(dprc_handle, res_type);
+		restool.cmd_option_mask &= ~(ONE_BIT_MASK(SHOW_OPT_RES_TYPE) |
+					     ONE_BIT_MASK(SHOW_OPT_RESOURCES));
+		error = show_mc_resources(dprc_id, dprc_handle, dprc_name,
+					  res_type, json);
+	} else if (restool.cmd_option_mask & ONE_BIT_MASK(SHOW_OPT_RESOURCES)) {
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(SHOW_OPT_RESOURCES);
+		error = show_mc_resources(dprc_id, dprc_handle, dprc_name,
+					  NULL, json);
+	} else if (json) {
+		ERROR_PRINTF("--json requires --resources or --resource-type\n");
+		puts(usage_msg);
+		error = -EINVAL;
 	} else {
-		error = show_mc_objects(dprc_handle, dprc_name);
+		error = show_mc_objects(dprc_id, dprc_handle, dprc_name);
 	}
 out:
 	if (dprc_opened) {
@@ -1399,17 +1786,267 @@ out:
 	return error;
 }
 
-static int do_dprc_assign_or_unassign(const char *usage_msg, bool do_assign)
+/* whether an --object argument selects several objects */
+static bool is_obj_selection(const char *arg)
 {
-	uint16_t dprc_handle;
-	int error;
-	bool dprc_opened = false;
-	uint32_t parent_dprc_id;
-	uint32_t child_dprc_id;
-	struct dprc_res_req res_req;
+	return strpbrk(arg, ",*?[") != NULL;
+}
 
-	if (restool.cmd_option_mask & ONE_BIT_MASK(ASSIGN_OPT_HELP)) {
-		puts(usage_msg);
+/**
+ * Mark the objects matched by one item of an --object selection:
+ * <type>.<id>, <type>.[<first>-<last>] or a shell wildcard pattern such as
+ * dpio.* (which never matches containers)
+ */
+static int select_objs(const char *item, struct dprc_obj_desc *obj_descs,
+		       int num_objs, bool *selected)
+{
+	char type[OBJ_TYPE_MAX_LENGTH + 1];
+	char name[OBJ_TYPE_MAX_LENGTH + 16];
+	unsigned int first, last;
+	int num_matched = 0;
+	int len = 0;
+	int id;
+
+	if (sscanf(item, "%" STRINGIFY(OBJ_TYPE_MAX_LENGTH) "[a-z].[%u-%u]%n",
+		   type, &first, &last, &len) == 3 &&
+	    (size_t)len == strlen(item)) {
+		if (first > last || strcmp(type, "dprc") == 0)
+			goto invalid;
+
+		for (int i = 0; i < num_objs; i++) {
+			if (strcmp(obj_descs[i].type, type) == 0 &&
+			    (unsigned int)obj_descs[i].id >= first &&
+			    (unsigned int)obj_descs[i].id <= last) {
+				selected[i] = true;
+				num_matched++;
+			}
+		}
+	} else if (strpbrk(item, "*?[") != NULL) {
+		for (int i = 0; i < num_objs; i++) {
+			snprintf(name, sizeof(name), "%s.%d",
+				 obj_descs[i].type, obj_descs[i].id);
+			if (strcmp(obj_descs[i].type, "dprc") != 0 &&
+			    fnmatch(item, name, 0) == 0) {
+				selected[i] = true;
+				num_matched++;
+			}
+		}
+	} else {
+		if (sscanf(item, "%" STRINGIFY(OBJ_TYPE_MAX_LENGTH)
+			   "[a-z].%d%n", type, &id, &len) != 2 ||
+		    (size_t)len != strlen(item))
+			goto invalid;
+
+		if (strcmp(type, "dprc") == 0) {
+			ERROR_PRINTF("Cannot move or change the plugged state of %s\n",
+				     item);
+			return -EINVAL;
+		}
+
+		for (int i = 0; i < num_objs; i++) {
+			if (strcmp(obj_descs[i].type, type) == 0 &&
+			    obj_descs[i].id == id) {
+				selected[i] = true;
+				num_matched++;
+			}
+		}
+
+		if (num_matched == 0) {
+			ERROR_PRINTF("%s does not exist in the source container\n",
+				     item);
+			return -ENOENT;
+		}
+	}
+
+	if (num_matched == 0)
+		ERROR_PRINTF("warning: no object matches \'%s\'\n", item);
+
+	return num_matched;
+invalid:
+	ERROR_PRINTF("Invalid --object arg: \'%s\'\n", item);
+	return -EINVAL;
+}
+
+/**
+ * Move or change the plugged state of all the objects of an --object
+ * selection. The source container is read once and the requests are then
+ * sent back to back on the same container handle.
+ */
+static int assign_obj_selection(const char *usage_msg, bool do_assign,
+				uint16_t dprc_handle, uint32_t parent_dprc_id,
+				uint32_t child_dprc_id)
+{
+	char *selection = restool.cmd_option_args[ASSIGN_OPT_OBJECT];
+	struct dprc_obj_desc *obj_descs = NULL;
+	char name[OBJ_TYPE_MAX_LENGTH + 16];
+	unsigned int num_selected = 0;
+	unsigned int num_failed = 0;
+	bool set_plugged = false;
+	bool *selected = NULL;
+	bool src_opened = false;
+	uint32_t src_dprc_id;
+	uint16_t src_handle;
+	int first_error = 0;
+	char *item, *saveptr;
+	int num_objs;
+	int state = 0;
+	int error;
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(ASSIGN_OPT_PLUGGED)) {
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(ASSIGN_OPT_PLUGGED);
+		if (!do_assign) {
+			ERROR_PRINTF(
+				"Cannot change plugged state via \'dprc unassign\'\nPlease try \'restool dprc assign --help\'\n");
+			return -EINVAL;
+		}
+
+		state = atoi(restool.cmd_option_args[ASSIGN_OPT_PLUGGED]);
+		if (state < 0 || state > 1) {
+			ERROR_PRINTF("Invalid --plugged arg: \'%s\'\n",
+				     restool.cmd_option_args[ASSIGN_OPT_PLUGGED]);
+			return -EINVAL;
+		}
+
+		set_plugged = true;
+	} else if (child_dprc_id == parent_dprc_id) {
+		ERROR_PRINTF(
+			"change plugged state? --plugged option required\n"
+			"move objects? child-container should be different from parent-container\n");
+		puts(usage_msg);
+		return -EINVAL;
+	}
+
+	/* the container the objects are in */
+	src_dprc_id = do_assign ? parent_dprc_id : child_dprc_id;
+	if (src_dprc_id == parent_dprc_id) {
+		src_handle = dprc_handle;
+	} else {
+		error = open_dprc(src_dprc_id, &src_handle);
+		if (error < 0)
+			return error;
+
+		src_opened = true;
+	}
+
+	error = dprc_get_obj_count(&restool.mc_io, 0, src_handle, &num_objs);
+	if (error < 0) {
+		mc_status = flib_error_to_mc_status(error);
+		ERROR_PRINTF("MC error: %s (status %#x)\n",
+			     mc_status_to_string(mc_status), mc_status);
+		goto out;
+	}
+
+	obj_descs = calloc(num_objs + 1, sizeof(*obj_descs));
+	selected = calloc(num_objs + 1, sizeof(*selected));
+	if (obj_descs == NULL || selected == NULL) {
+		error = -ENOMEM;
+		goto out;
+	}
+
+	error = get_all_obj_descs(src_dprc_id, src_handle, num_objs,
+				  obj_descs);
+	if (error < 0)
+		goto out;
+
+	for (item = strtok_r(selection, ",", &saveptr); item != NULL;
+	     item = strtok_r(NULL, ",", &saveptr)) {
+		error = select_objs(item, obj_descs, num_objs, selected);
+		if (error < 0)
+			goto out;
+	}
+
+	error = 0;
+	for (int i = 0; i < num_objs; i++) {
+		struct dprc_res_req res_req = { 0 };
+
+		if (!selected[i])
+			continue;
+
+		num_selected++;
+		snprintf(name, sizeof(name), "%s.%d", obj_descs[i].type,
+			 obj_descs[i].id);
+		if (in_use(name, set_plugged ? "changed plugged state" :
+					       "moved")) {
+			error = -EBUSY;
+			goto failed;
+		}
+
+		if (!set_plugged &&
+		    (obj_descs[i].state & DPRC_OBJ_STATE_PLUGGED)) {
+			ERROR_PRINTF("%s cannot be moved because it is currently in plugged state\n",
+				     name);
+			error = -EBUSY;
+			goto failed;
+		}
+
+		strcpy(res_req.type, obj_descs[i].type);
+		res_req.id_base_align = obj_descs[i].id;
+		res_req.options = DPRC_RES_REQ_OPT_EXPLICIT;
+		if (state == 1)
+			res_req.options |= DPRC_RES_REQ_OPT_PLUGGED;
+
+		if (do_assign)
+			error = dprc_assign(&restool.mc_io, 0, dprc_handle,
+					    child_dprc_id, &res_req);
+		else
+			error = dprc_unassign(&restool.mc_io, 0, dprc_handle,
+					      child_dprc_id, &res_req);
+		if (error == 0)
+			continue;
+
+		mc_status = flib_error_to_mc_status(error);
+		ERROR_PRINTF("%s: MC error: %s (status %#x)\n", name,
+			     mc_status_to_string(mc_status), mc_status);
+failed:
+		if (first_error == 0)
+			first_error = error;
+		num_failed++;
+	}
+
+	if (num_selected == 0) {
+		ERROR_PRINTF("No object selected by \'%s\'\n",
+			     restool.cmd_option_args[ASSIGN_OPT_OBJECT]);
+		error = -ENOENT;
+		goto out;
+	}
+
+	if (!restool.script || num_failed != 0)
+		printf("%s %u of %u objects\n",
+		       set_plugged && child_dprc_id == parent_dprc_id ?
+		       "changed the plugged state of" :
+		       (do_assign ? "assigned" : "unassigned"),
+		       num_selected - num_failed, num_selected);
+	error = first_error;
+out:
+	free(selected);
+	free(obj_descs);
+	if (src_opened) {
+		int error2;
+
+		error2 = dprc_close(&restool.mc_io, 0, src_handle);
+		if (error2 < 0) {
+			mc_status = flib_error_to_mc_status(error2);
+			ERROR_PRINTF("MC error: %s (status %#x)\n",
+				     mc_status_to_string(mc_status), mc_status);
+			if (error == 0)
+				error = error2;
+		}
+	}
+
+	return error;
+}
+
+static int do_dprc_assign_or_unassign(const char *usage_msg, bool do_assign)
+{
+	uint16_t dprc_handle;
+	int error;
+	bool dprc_opened = false;
+	uint32_t parent_dprc_id;
+	uint32_t child_dprc_id;
+	struct dprc_res_req res_req;
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(ASSIGN_OPT_HELP)) {
+		puts(usage_msg);
 		restool.cmd_option_mask &= ~ONE_BIT_MASK(ASSIGN_OPT_HELP);
 		error = 0;
 		goto out;
@@ -1499,6 +2136,14 @@ static int do_dprc_assign_or_unassign(const char *usage_msg, bool do_assign)
 		restool.cmd_option_mask &= ~ONE_BIT_MASK(ASSIGN_OPT_OBJECT);
 		assert(restool.cmd_option_args[ASSIGN_OPT_OBJECT] != NULL);
 
+		if (is_obj_selection(restool.cmd_option_args[ASSIGN_OPT_OBJECT])) {
+			error = assign_obj_selection(usage_msg, do_assign,
+						     dprc_handle,
+						     parent_dprc_id,
+						     child_dprc_id);
+			goto out;
+		}
+
 		n = sscanf(restool.cmd_option_args[ASSIGN_OPT_OBJECT],
 			   "%" STRINGIFY(OBJ_TYPE_MAX_LENGTH) "[a-z].%d",
 			   res_req.type, &res_req.id_base_align);
@@ -1652,6 +2297,8 @@ static int cmd_dprc_assign(void)
 		"    Specifies the destination container for the operation.\n"
 		"  --object=<object>\n"
 		"    Specifies the object to move from parent container to child container\n"
+		"    Several objects can be selected with a comma separated list of\n"
+		"    objects, id ranges like dpbp.[10-40] and wildcards like dpio.*\n"
 		"  --plugged=<state>\n"
 		"    Specifies the plugged state of the object (valid values are 0 or 1)\n"
 		"\n"
@@ -1670,6 +2317,8 @@ static int cmd_dprc_assign(void)
 		"  $ restool dprc assign dprc.1 --child=dprc.4 --object=dpni.2 --plugged=1\n"
 		"To set dpni.2 in container dprc.1 to be plugged:\n"
 		"  $ restool dprc assign dprc.1 --object=dprc.2 --plugged=1\n"
+		"To move dpbp.10 to dpbp.40 and all the dpio objects of dprc.1 to dprc.4:\n"
+		"  $ restool dprc assign dprc.1 --child=dprc.4 --object='dpbp.[10-40],dpio.*'\n"
 		"\n";
 
 	return do_dprc_assign_or_unassign(usage_msg, true);
@@ -1688,6 +2337,7 @@ static int cmd_dprc_unassign(void)
 		"    Container that is the source of the operation.\n"
 		"  --object=<object>\n"
 		"    Specifies the object to move from parent to child.\n"
+		"    Several objects can be selected as in 'dprc assign'.\n"
 		"\n"
 		"NOTES:\n"
 		"  -It is not possible to unassign dprc objects\n"
@@ -1721,13 +2371,7 @@ static int cmd_dprc_set_label(void)
 	int n;
 	char obj_type[OBJ_TYPE_MAX_LENGTH + 1];
 	uint32_t obj_id;
-	bool target_parent_dprc_opened = false;
-	struct dprc_obj_desc target_obj_desc;
-	uint32_t target_parent_dprc_id;
-	uint16_t target_parent_dprc_handle;
-	bool found;
 
-	memset(&target_obj_desc, 0, sizeof(target_obj_desc));
 	if (restool.cmd_option_mask & ONE_BIT_MASK(SET_LABEL_OPT_HELP)) {
 		puts(usage_msg);
 		restool.cmd_option_mask &= ~ONE_BIT_MASK(SET_LABEL_OPT_HELP);
@@ -1779,33 +2423,14 @@ static int cmd_dprc_set_label(void)
 		goto out;
 	}
 
-	error = find_target_obj_desc(restool.root_dprc_id,
-			restool.root_dprc_handle, 0, obj_id, obj_type,
-			&target_obj_desc, &target_parent_dprc_id, &found);
-
-	if (!found) {
-		if (error == 0)
-			printf("%s does not exist\n", restool.obj_name);
+	error = restool_obj_set_label(restool.ctx, obj_type, obj_id,
+			restool.cmd_option_args[SET_LABEL_OPT_LABEL]);
+	if (error == -ENOENT) {
+		printf("%s does not exist\n", restool.obj_name);
 		error = -EINVAL;
 		goto out;
 	}
 
-	if (error < 0)
-		goto out;
-
-	if (target_parent_dprc_id == restool.root_dprc_id)
-		target_parent_dprc_handle = restool.root_dprc_handle;
-	else {
-		error = open_dprc(target_parent_dprc_id,
-				&target_parent_dprc_handle);
-		if (error < 0)
-			goto out;
-		target_parent_dprc_opened = true;
-	}
-
-	error = dprc_set_obj_label(&restool.mc_io, 0,
-			target_parent_dprc_handle, obj_type, obj_id,
-			restool.cmd_option_args[SET_LABEL_OPT_LABEL]);
 	if (error < 0) {
 		mc_status = flib_error_to_mc_status(error);
 		ERROR_PRINTF("MC error: %s (status %#x)\n",
@@ -1814,23 +2439,90 @@ static int cmd_dprc_set_label(void)
 	}
 
 out:
-	DEBUG_PRINTF("target_parent_dprc_opened=%d\n",
-			(int)target_parent_dprc_opened);
-	if (target_parent_dprc_opened) {
-		int error2;
+	return error;
+}
 
-		error2 = dprc_close(&restool.mc_io, 0,
-					target_parent_dprc_handle);
-		if (error2 < 0) {
-			mc_status = flib_error_to_mc_status(error2);
-			ERROR_PRINTF("MC error: %s (status %#x)\n",
-				     mc_status_to_string(mc_status), mc_status);
-			if (error == 0)
-				error = error2;
-		}
+static int cmd_dprc_find(void)
+{
+	static const char usage_msg[] =
+		"\n"
+		"Usage: restool dprc find --label=<pattern> [--type=<object-type>]\n"
+		"\n"
+		"  --label=<pattern>\n"
+		"    Shell wildcard pattern (e.g. \"eth*\") matched against the\n"
+		"    object labels.\n"
+		"  --type=<object-type>\n"
+		"    Only list objects of this type, e.g. dpni.\n"
+		"\n"
+		"  Lists the matching objects with their container and label.\n"
+		"  Any command also accepts label:<label> in place of an object\n"
+		"  name, e.g. restool dpni info label:mountain\n"
+		"\n"
+		"EXAMPLE:\n"
+		"To list the DPNIs labeled port0 to port9:\n"
+		"  $ restool dprc find --label=\"port[0-9]\" --type=dpni\n"
+		"\n";
+	const char *pattern;
+	const char *type = NULL;
+	struct obj_index index;
+	char name[OBJ_TYPE_MAX_LENGTH + 16];
+	char parent[OBJ_TYPE_MAX_LENGTH + 16];
+	int error;
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(FIND_OPT_HELP)) {
+		puts(usage_msg);
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(FIND_OPT_HELP);
+		return 0;
 	}
 
-	return error;
+	if (restool.obj_name != NULL) {
+		ERROR_PRINTF("Unexpected argument: \'%s\'\n\n",
+			     restool.obj_name);
+		puts(usage_msg);
+		return -EINVAL;
+	}
+
+	if (!(restool.cmd_option_mask & ONE_BIT_MASK(FIND_OPT_LABEL))) {
+		ERROR_PRINTF("missing --label option\n");
+		puts(usage_msg);
+		return -EINVAL;
+	}
+
+	restool.cmd_option_mask &= ~ONE_BIT_MASK(FIND_OPT_LABEL);
+	pattern = restool.cmd_option_args[FIND_OPT_LABEL];
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(FIND_OPT_TYPE)) {
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(FIND_OPT_TYPE);
+		type = restool.cmd_option_args[FIND_OPT_TYPE];
+	}
+
+	error = obj_index_get(&index);
+	if (error < 0)
+		return error;
+
+	for (unsigned int i = 0; i < index.num_entries; i++) {
+		const struct obj_index_entry *entry = &index.entries[i];
+
+		if (entry->label[0] == '\0' ||
+		    (type != NULL && strcmp(entry->type, type) != 0) ||
+		    fnmatch(pattern, entry->label, 0) != 0)
+			continue;
+
+		snprintf(name, sizeof(name), "%s.%u", entry->type, entry->id);
+		if (entry->parent_id == OBJ_INDEX_NO_PARENT)
+			strcpy(parent, "-");
+		else
+			snprintf(parent, sizeof(parent), "dprc.%u",
+				 entry->parent_id);
+
+		if (restool.script)
+			printf("%s %s %s\n", name, parent, entry->label);
+		else
+			printf("%-16s %-16s %s\n", name, parent, entry->label);
+	}
+
+	obj_index_free(&index);
+	return 0;
 }
 
 static int cmd_dprc_set_locked(void)
@@ -1984,6 +2676,300 @@ static int parse_endpoint(char *endpoint_str, struct dprc_endpoint *endpoint)
 	return 0;
 }
 
+/**
+ * One line of a link-map file:
+ *   <endpoint1> <endpoint2> [<committed-rate> <max-rate>]
+ * disconnect only uses <endpoint1>, so that the same file can be used to
+ * tear the links down.
+ */
+struct link_map_entry {
+	unsigned int line;
+	char name1[OBJ_TYPE_MAX_LENGTH + 32];
+	char name2[OBJ_TYPE_MAX_LENGTH + 32];
+	struct dprc_endpoint endpoint1;
+	struct dprc_endpoint endpoint2;
+	struct dprc_connection_cfg cfg;
+};
+
+#define LINK_MAP_MAX_LINKS	1024
+
+/* resolve a label:<label> endpoint in the topology snapshot */
+static int resolve_link_label(const struct obj_index *index, char *name,
+			      size_t size, unsigned int line)
+{
+	const char *label = name + strlen(OBJ_LABEL_PREFIX);
+	const struct obj_index_entry *found = NULL;
+	unsigned int num_found = 0;
+
+	if (strncmp(name, OBJ_LABEL_PREFIX, strlen(OBJ_LABEL_PREFIX)) != 0)
+		return 0;
+
+	for (unsigned int i = 0; i < index->num_entries; i++) {
+		if (strcmp(index->entries[i].label, label) == 0) {
+			found = &index->entries[i];
+			num_found++;
+		}
+	}
+
+	if (num_found != 1) {
+		ERROR_PRINTF("line %u: %s label \'%s\'\n", line,
+			     num_found ? "ambiguous" : "unknown", label);
+		return -EINVAL;
+	}
+
+	snprintf(name, size, "%s.%u", found->type, found->id);
+	return 0;
+}
+
+static int check_link_endpoint(const struct obj_index *index,
+			       const struct dprc_endpoint *endpoint,
+			       const char *name, uint32_t parent_dprc_id,
+			       unsigned int line)
+{
+	const struct obj_index_entry *entry;
+
+	entry = obj_index_find(index, endpoint->type, endpoint->id);
+	if (entry == NULL) {
+		ERROR_PRINTF("line %u: %s does not exist\n", line, name);
+		return -ENOENT;
+	}
+
+	if (!obj_index_in_container(index, entry, parent_dprc_id)) {
+		ERROR_PRINTF("line %u: %s is not in dprc.%u\n", line, name,
+			     parent_dprc_id);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static bool same_endpoint(const struct dprc_endpoint *a,
+			  const struct dprc_endpoint *b)
+{
+	return a->id == b->id && a->if_id == b->if_id &&
+	       strcmp(a->type, b->type) == 0;
+}
+
+static int parse_link_map_line(const struct obj_index *index, char *buf,
+			       bool connect, struct link_map_entry *link)
+{
+	char committed_rate[32];
+	char max_rate[32];
+	char *end;
+	int n;
+
+	n = sscanf(buf, "%47s %47s %31s %31s", link->name1, link->name2,
+		   committed_rate, max_rate);
+	if (n < 1 || (connect && n != 2 && n != 4)) {
+		ERROR_PRINTF("line %u: expected <endpoint1> <endpoint2> "
+			     "[<committed-rate> <max-rate>]\n", link->line);
+		return -EINVAL;
+	}
+
+	if (resolve_link_label(index, link->name1, sizeof(link->name1),
+			       link->line) < 0)
+		return -EINVAL;
+
+	if (parse_endpoint(link->name1, &link->endpoint1) < 0) {
+		ERROR_PRINTF("line %u: invalid endpoint \'%s\'\n",
+			     link->line, link->name1);
+		return -EINVAL;
+	}
+
+	if (!connect)
+		return 0;
+
+	if (resolve_link_label(index, link->name2, sizeof(link->name2),
+			       link->line) < 0)
+		return -EINVAL;
+
+	if (parse_endpoint(link->name2, &link->endpoint2) < 0) {
+		ERROR_PRINTF("line %u: invalid endpoint \'%s\'\n",
+			     link->line, link->name2);
+		return -EINVAL;
+	}
+
+	if (n == 4) {
+		errno = 0;
+		link->cfg.committed_rate = strtoul(committed_rate, &end, 0);
+		if (errno != 0 || *end != '\0' ||
+		    link->cfg.committed_rate == 0)
+			goto bad_rate;
+
+		link->cfg.max_rate = strtoul(max_rate, &end, 0);
+		if (errno != 0 || *end != '\0' ||
+		    link->cfg.max_rate < link->cfg.committed_rate)
+			goto bad_rate;
+	}
+
+	return 0;
+bad_rate:
+	ERROR_PRINTF("line %u: invalid rates \'%s %s\' (Mbits/s, max-rate must "
+		     "not be below committed-rate)\n", link->line,
+		     committed_rate, max_rate);
+	return -EINVAL;
+}
+
+/**
+ * Read the whole link-map file and check every endpoint against one
+ * snapshot of the topology, before anything is sent to the MC
+ */
+static int load_link_map(const char *path, bool connect,
+			 uint32_t parent_dprc_id,
+			 struct link_map_entry **links,
+			 unsigned int *num_links)
+{
+	struct obj_index index;
+	struct link_map_entry *link;
+	unsigned int line = 0;
+	bool valid = true;
+	char buf[256];
+	int error;
+	FILE *f;
+
+	*links = NULL;
+	*num_links = 0;
+	f = fopen(path, "r");
+	if (f == NULL) {
+		error = -errno;
+		ERROR_PRINTF("cannot open %s: %s\n", path, strerror(errno));
+		return error;
+	}
+
+	error = obj_index_build(&index);
+	if (error < 0)
+		goto out_close;
+
+	*links = calloc(LINK_MAP_MAX_LINKS, sizeof(**links));
+	if (*links == NULL) {
+		error = -ENOMEM;
+		goto out;
+	}
+
+	while (fgets(buf, sizeof(buf), f) != NULL) {
+		char *comment = strchr(buf, '#');
+
+		line++;
+		if (comment != NULL)
+			*comment = '\0';
+
+		if (buf[strspn(buf, " \t\r\n")] == '\0')
+			continue;
+
+		if (*num_links == LINK_MAP_MAX_LINKS) {
+			ERROR_PRINTF("line %u: more than %u links\n", line,
+				     LINK_MAP_MAX_LINKS);
+			error = -E2BIG;
+			goto out;
+		}
+
+		link = &(*links)[*num_links];
+		link->line = line;
+		if (parse_link_map_line(&index, buf, connect, link) < 0) {
+			valid = false;
+			continue;
+		}
+
+		if (check_link_endpoint(&index, &link->endpoint1, link->name1,
+					parent_dprc_id, line) < 0 ||
+		    (connect &&
+		     check_link_endpoint(&index, &link->endpoint2, link->name2,
+					 parent_dprc_id, line) < 0)) {
+			valid = false;
+			continue;
+		}
+
+		/* an endpoint can only be part of one link */
+		for (unsigned int i = 0; connect && i < *num_links; i++) {
+			struct link_map_entry *prev = &(*links)[i];
+
+			if (same_endpoint(&prev->endpoint1, &link->endpoint1) ||
+			    same_endpoint(&prev->endpoint2, &link->endpoint1) ||
+			    same_endpoint(&prev->endpoint1, &link->endpoint2) ||
+			    same_endpoint(&prev->endpoint2, &link->endpoint2)) {
+				ERROR_PRINTF("line %u: endpoint already used "
+					     "on line %u\n", line, prev->line);
+				valid = false;
+			}
+		}
+
+		(*num_links)++;
+	}
+
+	if (!valid)
+		error = -EINVAL;
+	else if (*num_links == 0)
+		ERROR_PRINTF("warning: no links in %s\n", path);
+
+	if (obj_index_save(&index) < 0)
+		DEBUG_PRINTF("could not save the object index\n");
+out:
+	obj_index_free(&index);
+out_close:
+	fclose(f);
+	if (error < 0) {
+		free(*links);
+		*links = NULL;
+	}
+
+	return error;
+}
+
+/* connect or disconnect all the links of a file in this MC session */
+static int run_link_map(const char *path, bool connect,
+			uint32_t parent_dprc_id, uint16_t dprc_handle)
+{
+	struct link_map_entry *links;
+	unsigned int num_links;
+	unsigned int num_failed = 0;
+	int first_error = 0;
+	int error;
+
+	error = load_link_map(path, connect, parent_dprc_id, &links,
+			      &num_links);
+	if (error < 0)
+		return error;
+
+	for (unsigned int i = 0; i < num_links; i++) {
+		struct link_map_entry *link = &links[i];
+
+		if (connect)
+			error = dprc_connect(&restool.mc_io, 0, dprc_handle,
+					     &link->endpoint1,
+					     &link->endpoint2, &link->cfg);
+		else
+			error = dprc_disconnect(&restool.mc_io, 0, dprc_handle,
+						&link->endpoint1);
+		if (error < 0) {
+			mc_status = flib_error_to_mc_status(error);
+			ERROR_PRINTF("line %u: %s%s%s: MC error: %s "
+				     "(status %#x)\n", link->line,
+				     link->name1, connect ? " <-> " : "",
+				     connect ? link->name2 : "",
+				     mc_status_to_string(mc_status),
+				     mc_status);
+			if (first_error == 0)
+				first_error = error;
+			num_failed++;
+		}
+	}
+
+	if (!restool.script || num_failed != 0)
+		printf("%u of %u links %s\n", num_links - num_failed,
+		       num_links, connect ? "connected" : "disconnected");
+
+	free(links);
+	return first_error;
+}
+
+static void to_restool_endpoint(struct restool_endpoint *ep,
+				const struct dprc_endpoint *dprc_ep)
+{
+	memset(ep, 0, sizeof(*ep));
+	snprintf(ep->type, sizeof(ep->type), "%s", dprc_ep->type);
+	ep->id = dprc_ep->id;
+	ep->if_id = dprc_ep->if_id;
+}
 
 static int cmd_dprc_connect(void)
 {
@@ -1991,6 +2977,7 @@ static int cmd_dprc_connect(void)
 		"\n"
 		"Usage: restool dprc connect <parent-container> --endpoint1=<object>\n"
 		"		--endpoint2=<object> [OPTIONS]\n"
+		"       restool dprc connect <parent-container> --from-file=<links>\n"
 		"\n"
 		"  <parent-container>\n"
 		"    Specifies the parent-container.\n"
@@ -2004,6 +2991,11 @@ static int cmd_dprc_connect(void)
 		"    Committed rate (Mbits/s). Must be provided alongside max-rate.\n"
 		"  --max-rate=<number>\n"
 		"    Maximum rate (Mbits/s). Must be provided alongside committed-rate.\n"
+		"  --from-file=<links>\n"
+		"    Connects all the links of a link-map file, one per line:\n"
+		"    <endpoint1> <endpoint2> [<committed-rate> <max-rate>]\n"
+		"    ('#' starts a comment). All endpoints are checked before any\n"
+		"    link is made, and the failed links are reported by line.\n"
 		"\n"
 		"NOTES:\n"
 		"  -<parent-container> must be a common ancestor of both <object> arguments\n"
@@ -2017,6 +3009,8 @@ static int cmd_dprc_connect(void)
 		"EXAMPLE:\n"
 		"To connect dpni.8 to dpsw.0.0:\n"
 		"   $ restool dprc connect dprc.1 --endpoint1=dpsw.0.0 --endpoint2=dpni.8\n"
+		"To connect the links of switch.links:\n"
+		"   $ restool dprc connect dprc.1 --from-file=switch.links\n"
 		"\n";
 
 	struct dprc_connection_cfg dprc_connection_cfg;
@@ -2024,6 +3018,7 @@ static int cmd_dprc_connect(void)
 	bool max_rate_given = false;
 	struct dprc_endpoint endpoint1;
 	struct dprc_endpoint endpoint2;
+	struct restool_endpoint ep1, ep2;
 	bool dprc_opened = false;
 	uint32_t parent_dprc_id;
 	uint16_t dprc_handle;
@@ -2049,14 +3044,28 @@ static int cmd_dprc_connect(void)
 	if (error < 0)
 		goto out;
 
-	if (parent_dprc_id != restool.root_dprc_id) {
-		error = open_dprc(parent_dprc_id, &dprc_handle);
-		if (error < 0)
+	if (restool.cmd_option_mask & ONE_BIT_MASK(CONNECT_OPT_FROM_FILE)) {
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(CONNECT_OPT_FROM_FILE);
+		if (restool.cmd_option_mask != 0) {
+			ERROR_PRINTF("--from-file cannot be combined with other options\n");
+			puts(usage_msg);
+			error = -EINVAL;
 			goto out;
+		}
 
-		dprc_opened = true;
-	} else {
-		dprc_handle = restool.root_dprc_handle;
+		if (parent_dprc_id != restool.root_dprc_id) {
+			error = open_dprc(parent_dprc_id, &dprc_handle);
+			if (error < 0)
+				goto out;
+
+			dprc_opened = true;
+		} else {
+			dprc_handle = restool.root_dprc_handle;
+		}
+
+		error = run_link_map(restool.cmd_option_args[CONNECT_OPT_FROM_FILE],
+				     true, parent_dprc_id, dprc_handle);
+		goto out;
 	}
 
 	if (!(restool.cmd_option_mask & ONE_BIT_MASK(CONNECT_OPT_ENDPOINT1))) {
@@ -2129,11 +3138,11 @@ static int cmd_dprc_connect(void)
 		return -EINVAL;
 	}
 
-	error = dprc_connect(&restool.mc_io, 0,
-			     dprc_handle,
-			     &endpoint1,
-			     &endpoint2,
-			     &dprc_connection_cfg);
+	to_restool_endpoint(&ep1, &endpoint1);
+	to_restool_endpoint(&ep2, &endpoint2);
+	error = restool_connect(restool.ctx, parent_dprc_id, &ep1, &ep2,
+				dprc_connection_cfg.committed_rate,
+				dprc_connection_cfg.max_rate);
 
 	if (error < 0) {
 		mc_status = flib_error_to_mc_status(error);
@@ -2162,11 +3171,15 @@ static int cmd_dprc_disconnect(void)
 	static const char usage_msg[] =
 		"\n"
 		"Usage: restool dprc disconnect <parent-container> --endpoint=<object>\n"
+		"       restool dprc disconnect <parent-container> --from-file=<links>\n"
 		"\n"
 		"  <parent-container>\n"
 		"    Specifies the parent-container.\n"
 		"  --endpoint=<object>\n"
 		"    Specifies either endpoint of a connection.\n"
+		"  --from-file=<links>\n"
+		"    Disconnects the first endpoint of each line of a link-map\n"
+		"    file, as used by 'dprc connect --from-file'.\n"
 		"\n"
 		"NOTES:\n"
 		"  -<parent-container> must be an ancestor of the <object>\n"
@@ -2182,6 +3195,7 @@ static int cmd_dprc_disconnect(void)
 	bool dprc_opened = false;
 	uint32_t parent_dprc_id;
 	struct dprc_endpoint endpoint;
+	struct restool_endpoint ep;
 
 	if (restool.cmd_option_mask & ONE_BIT_MASK(DISCONNECT_OPT_HELP)) {
 		puts(usage_msg);
@@ -2202,14 +3216,30 @@ static int cmd_dprc_disconnect(void)
 	if (error < 0)
 		goto out;
 
-	if (parent_dprc_id != restool.root_dprc_id) {
-		error = open_dprc(parent_dprc_id, &dprc_handle);
-		if (error < 0)
+	if (restool.cmd_option_mask & ONE_BIT_MASK(DISCONNECT_OPT_FROM_FILE)) {
+		restool.cmd_option_mask &=
+			~ONE_BIT_MASK(DISCONNECT_OPT_FROM_FILE);
+		if (restool.cmd_option_mask != 0) {
+			ERROR_PRINTF("--from-file cannot be combined with --endpoint\n");
+			puts(usage_msg);
+			error = -EINVAL;
 			goto out;
+		}
 
-		dprc_opened = true;
-	} else {
-		dprc_handle = restool.root_dprc_handle;
+		if (parent_dprc_id != restool.root_dprc_id) {
+			error = open_dprc(parent_dprc_id, &dprc_handle);
+			if (error < 0)
+				goto out;
+
+			dprc_opened = true;
+		} else {
+			dprc_handle = restool.root_dprc_handle;
+		}
+
+		error = run_link_map(
+				restool.cmd_option_args[DISCONNECT_OPT_FROM_FILE],
+				false, parent_dprc_id, dprc_handle);
+		goto out;
 	}
 
 	if (!(restool.cmd_option_mask &
@@ -2230,9 +3260,8 @@ static int cmd_dprc_disconnect(void)
 		goto out;
 	}
 
-	error = dprc_disconnect(&restool.mc_io, 0,
-				dprc_handle,
-				&endpoint);
+	to_restool_endpoint(&ep, &endpoint);
+	error = restool_disconnect(restool.ctx, parent_dprc_id, &ep);
 
 	if (error < 0) {
 		mc_status = flib_error_to_mc_status(error);
@@ -2301,23 +3330,271 @@ static void print_mem_struct(struct dprc_get_mem_page *mem)
 	printf("size4 = %u\n", mem->size4);
 }
 
+static int cmp_mem_extents(const void *a, const void *b)
+{
+	const struct mem_extent *ea = a;
+	const struct mem_extent *eb = b;
+
+	return (ea->offset > eb->offset) - (ea->offset < eb->offset);
+}
+
+static int add_mem_page(struct dprc_get_mem_page *mem,
+			struct mem_extent **extents, unsigned int *num_extents,
+			unsigned int *max_extents)
+{
+	const uint32_t offsets[] = { mem->offset0, mem->offset1, mem->offset2,
+				     mem->offset3, mem->offset4 };
+	const uint32_t sizes[] = { mem->size0, mem->size1, mem->size2,
+				   mem->size3, mem->size4 };
+
+	if (*num_extents + ARRAY_SIZE(sizes) > *max_extents) {
+		unsigned int max = *max_extents ? 2 * *max_extents : 64;
+		struct mem_extent *tmp;
+
+		tmp = realloc(*extents, max * sizeof(*tmp));
+		if (!tmp)
+			return -ENOMEM;
+
+		*extents = tmp;
+		*max_extents = max;
+	}
+
+	for (unsigned int i = 0;
+	     i < mem->num_entries && i < ARRAY_SIZE(sizes); i++) {
+		if (sizes[i] == 0)
+			continue;
+
+		(*extents)[*num_extents].offset = offsets[i];
+		(*extents)[*num_extents].size = sizes[i];
+		(*num_extents)++;
+	}
+
+	return 0;
+}
+
+/**
+ * Read all the pages of the free block list of a memory partition, sorted
+ * by offset. Only the first page asks the MC to parse the partition
+ * again, so that all the pages describe the same state. With 'dump', the
+ * pages are printed as they come instead.
+ */
+int read_mem_extents(uint16_t dprc_handle, uint8_t partition_id, bool dump,
+		     struct mem_extent **extents, unsigned int *num_extents)
+{
+	struct dprc_get_mem_page mem;
+	unsigned int max_extents = 0;
+	uint16_t page = 0;
+	int err;
+
+	*extents = NULL;
+	*num_extents = 0;
+	do {
+		memset(&mem, 0, sizeof(mem));
+		if (dump)
+			printf("Calling with page %u\n", page);
+
+		err = dprc_get_mem(&restool.mc_io, 0, dprc_handle,
+				   partition_id, page == 0, page, &mem);
+		if (err) {
+			mc_status = flib_error_to_mc_status(err);
+			ERROR_PRINTF("Error while getting page %u: %s (status %#x)\n",
+				     page, mc_status_to_string(mc_status),
+				     mc_status);
+			goto err;
+		}
+
+		if (dump) {
+			print_mem_struct(&mem);
+			printf("Finished printing page number %d\n\n", page);
+			continue;
+		}
+
+		err = add_mem_page(&mem, extents, num_extents, &max_extents);
+		if (err)
+			goto err;
+	} while (++page < mem.total_page_count);
+
+	if (*num_extents > 1)
+		qsort(*extents, *num_extents, sizeof(**extents),
+		      cmp_mem_extents);
+
+	return 0;
+err:
+	free(*extents);
+	*extents = NULL;
+	*num_extents = 0;
+	return err;
+}
+
+void get_mem_stats(const struct mem_extent *extents,
+		   unsigned int num_extents, struct mem_stats *stats)
+{
+	memset(stats, 0, sizeof(*stats));
+	stats->num_blocks = num_extents;
+	for (unsigned int i = 0; i < num_extents; i++) {
+		uint32_t size = extents[i].size;
+		int bucket = 31 - __builtin_clz(size);
+
+		stats->total_free += size;
+		if (size > stats->largest_free)
+			stats->largest_free = size;
+		stats->hist[bucket]++;
+	}
+
+	if (stats->total_free)
+		stats->frag_index = 1.0 - (double)stats->largest_free /
+					  stats->total_free;
+}
+
+const char *mem_size_str(uint64_t size, char *buf, size_t len)
+{
+	static const char units[] = "BKMGT";
+	double value = size;
+	unsigned int unit = 0;
+
+	while (value >= 1024 && unit < sizeof(units) - 2) {
+		value /= 1024;
+		unit++;
+	}
+
+	if (unit == 0)
+		snprintf(buf, len, "%lluB", (unsigned long long)size);
+	else
+		snprintf(buf, len, "%.1f%c", value, units[unit]);
+
+	return buf;
+}
+
+static void print_mem_analysis(const struct mem_extent *extents,
+			       const struct mem_stats *stats)
+{
+	unsigned int max_count = 0;
+	char buf[2][16];
+
+	printf("free blocks (sorted by offset):\n");
+	for (unsigned int i = 0; i < stats->num_blocks; i++)
+		printf("  %#010x - %#010x  %10u  (%s)\n", extents[i].offset,
+		       (uint32_t)(extents[i].offset + extents[i].size - 1),
+		       extents[i].size,
+		       mem_size_str(extents[i].size, buf[0], sizeof(buf[0])));
+
+	printf("\n");
+	printf("free blocks: %u\n", stats->num_blocks);
+	printf("total free: %llu (%s)\n",
+	       (unsigned long long)stats->total_free,
+	       mem_size_str(stats->total_free, buf[0], sizeof(buf[0])));
+	printf("largest free block: %u (%s)\n", stats->largest_free,
+	       mem_size_str(stats->largest_free, buf[0], sizeof(buf[0])));
+	printf("fragmentation index: %.1f%%\n", 100 * stats->frag_index);
+
+	if (stats->num_blocks == 0)
+		return;
+
+	for (int i = 0; i < MEM_HIST_BUCKETS; i++)
+		if (stats->hist[i] > max_count)
+			max_count = stats->hist[i];
+
+	printf("\nfree block sizes:\n");
+	for (int i = 0; i < MEM_HIST_BUCKETS; i++) {
+		int width;
+
+		if (!stats->hist[i])
+			continue;
+
+		width = (stats->hist[i] * 40 + max_count - 1) / max_count;
+		printf("  [%6s, %6s) %6u %.*s\n",
+		       mem_size_str(UINT64_C(1) << i, buf[0], sizeof(buf[0])),
+		       mem_size_str(UINT64_C(2) << i, buf[1], sizeof(buf[1])),
+		       stats->hist[i], width,
+		       "########################################");
+	}
+}
+
+/**
+ * Print one line per sample with the free memory, the largest free block
+ * and its lowest value so far, which is what limits the next allocation
+ */
+static int watch_mem(uint16_t dprc_handle, uint8_t partition_id,
+		     struct watch *watch)
+{
+	uint32_t min_largest = UINT32_MAX;
+	struct mem_extent *extents;
+	unsigned int num_extents;
+	struct mem_stats stats;
+	char buf[3][16];
+	int err = 0;
+
+	printf("%-19s %10s %10s %10s %7s %6s\n", "time", "free", "largest",
+	       "min-largest", "blocks", "frag");
+	watch_start(watch);
+	do {
+		char now_str[32];
+		time_t now;
+
+		err = read_mem_extents(dprc_handle, partition_id, false,
+				       &extents, &num_extents);
+		if (err)
+			break;
+
+		get_mem_stats(extents, num_extents, &stats);
+		free(extents);
+		if (stats.largest_free < min_largest)
+			min_largest = stats.largest_free;
+
+		now = time(NULL);
+		strftime(now_str, sizeof(now_str), "%Y-%m-%d %H:%M:%S",
+			 localtime(&now));
+		printf("%-19s %10s %10s %10s %7u %5.1f%%\n", now_str,
+		       mem_size_str(stats.total_free, buf[0], sizeof(buf[0])),
+		       mem_size_str(stats.largest_free, buf[1], sizeof(buf[1])),
+		       mem_size_str(min_largest, buf[2], sizeof(buf[2])),
+		       stats.num_blocks, 100 * stats.frag_index);
+		fflush(stdout);
+	} while (watch_next(watch));
+
+	watch_stop(watch);
+	return err;
+}
+
 static int cmd_dprc_dump_mem(void)
 {
 	static const char usage_msg[] =
 		"\n"
 		"Usage: restool dprc dump-mem <container> --partition_id=<number>\n"
+		"		[--analyze] [--watch=<ms>] [--count=<n>]\n"
+		"		[--duration=<seconds>]\n"
 		"\n"
 		"  --partition_id=<number>\n"
 		"		MEM_PART_PEB - Packet-Express-Buffer memory partition\n"
+		"  --analyze\n"
+		"    Instead of the raw pages, prints the free blocks sorted by\n"
+		"    offset, the total free memory, the largest free block, the\n"
+		"    fragmentation index (1 - largest / total free) and a\n"
+		"    histogram of the free block sizes.\n"
+		"  --watch=<ms>\n"
+		"    Prints the free memory, the largest free block and its\n"
+		"    lowest value seen, every <ms> milliseconds until\n"
+		"    interrupted.\n"
+		"  --count=<n>\n"
+		"    Stops after <n> intervals, of 1000 ms without --watch.\n"
+		"  --duration=<seconds>\n"
+		"    Stops after <seconds>.\n"
 		"\n"
 		"EXAMPLE:\n"
 		"To dump the free memory blocks of PEB partition:\n"
 		"  $ restool dprc dump-mem dprc.1 --partition_id=MEM_PART_PEB\n"
+		"To check the PEB fragmentation every 5 seconds:\n"
+		"  $ restool dprc dump-mem dprc.1 --partition_id=MEM_PART_PEB --watch=5000\n"
 		"\n";
-	uint16_t dprc_handle, total_page_cnt, page = 0;
-	struct dprc_get_mem_page mem = {0};
+	uint16_t dprc_handle;
+	struct mem_extent *extents;
+	unsigned int num_extents;
+	struct mem_stats stats;
 	uint32_t current_dprc_id;
 	bool dprc_opened = false;
+	struct watch watch = { .interval_ms = 1000 };
+	bool analyze = false;
+	int repeat;
 	int err;
 
 	if (restool.cmd_option_mask & ONE_BIT_MASK(DUMP_MEM_OPT_HELP)) {
@@ -2359,27 +3636,39 @@ static int cmd_dprc_dump_mem(void)
 	restool.cmd_option_mask &= ~ONE_BIT_MASK(DUMP_MEM_OPT_PART);
 	assert(restool.cmd_option_args[DUMP_MEM_OPT_PART] != NULL);
 
-	if (!strcmp(restool.cmd_option_args[CONNECT_OPT_ENDPOINT1],
-				"MEM_PART_PEB")) {
-		do {
-			printf("Calling with page %u\n", page);
-			err = dprc_get_mem(&restool.mc_io, 0, dprc_handle,
-					   MEM_PART_PEB, 1, page, &mem);
-			total_page_cnt = mem.total_page_count;
+	if (restool.cmd_option_mask & ONE_BIT_MASK(DUMP_MEM_OPT_ANALYZE)) {
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(DUMP_MEM_OPT_ANALYZE);
+		analyze = true;
+	}
 
-			if (err) {
-				ERROR_PRINTF("Error while getting page\n");
-				goto out;
-			}
+	repeat = get_watch_options(&watch, DUMP_MEM_OPT_WATCH,
+				   DUMP_MEM_OPT_COUNT, DUMP_MEM_OPT_DURATION);
+	if (repeat < 0) {
+		err = repeat;
+		goto out;
+	}
 
-			print_mem_struct(&mem);
-			memset(&mem, 0, sizeof(struct dprc_get_mem_page));
-			printf("Finished printing page number %d\n\n", page);
-		} while (++page != total_page_cnt);
-	} else {
-		ERROR_PRINTF("This command is currently only supported"
+	if (strcmp(restool.cmd_option_args[DUMP_MEM_OPT_PART],
+		   "MEM_PART_PEB")) {
+		ERROR_PRINTF("This command is currently only supported "
 			     "for MEM_PART_PEB\n");
+		err = -EINVAL;
+		goto out;
 	}
+
+	if (repeat) {
+		err = watch_mem(dprc_handle, MEM_PART_PEB, &watch);
+		goto out;
+	}
+
+	err = read_mem_extents(dprc_handle, MEM_PART_PEB, !analyze,
+			       &extents, &num_extents);
+	if (err || !analyze)
+		goto out;
+
+	get_mem_stats(extents, num_extents, &stats);
+	print_mem_analysis(extents, &stats);
+	free(extents);
 out:
 	if (dprc_opened) {
 		int err2;
@@ -2441,6 +3730,10 @@ struct object_command dprc_commands[] = {
 	  .options = dprc_set_label_options,
 	  .cmd_func = cmd_dprc_set_label },
 
+	{ .cmd_name = "find",
+	  .options = dprc_find_options,
+	  .cmd_func = cmd_dprc_find },
+
 	{ .cmd_name = "set-locked",
 	  .options = dprc_set_locked_options,
 	  .cmd_func = cmd_dprc_set_locked },
@@ -40,6 +40,7 @@
 #include <sys/ioctl.h>
 #include "restool.h"
 #include "utils.h"
+#include "obj_index.h"
 #include "mc_v9/fsl_dpseci.h"
 #include "mc_v10/fsl_dpseci.h"
 
@@ -145,6 +146,34 @@ static struct option dpseci_destroy_options[] = {
 
 C_ASSERT(ARRAY_SIZE(dpseci_destroy_options) <= MAX_NUM_CMD_LINE_OPTIONS + 1);
 
+/**
+ * dpseci queues command options
+ */
+enum dpseci_queues_options {
+	QUEUES_OPT_HELP = 0,
+	QUEUES_OPT_ALL,
+};
+
+static struct option dpseci_queues_options[] = {
+	[QUEUES_OPT_HELP] = {
+		.name = "help",
+		.has_arg = 0,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[QUEUES_OPT_ALL] = {
+		.name = "all",
+		.has_arg = 0,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	{ 0 },
+};
+
+C_ASSERT(ARRAY_SIZE(dpseci_queues_options) <= MAX_NUM_CMD_LINE_OPTIONS + 1);
+
 const struct flib_ops dpseci_ops = {
 	.obj_open = dpseci_open_v10,
 	.obj_close = dpseci_close_v10,
@@ -168,6 +197,7 @@ static int cmd_dpseci_help(void)
 		"   info - displays detailed information about a DPSECI object.\n"
 		"   create - creates a new child DPSECI under the root DPRC.\n"
 		"   destroy - destroys a child DPSECI under the root DPRC.\n"
+		"   queues - displays the queues and SEC priorities of DPSECIs.\n"
 		"\n"
 		"For command-specific help, use the --help option of each command.\n"
 		"\n";
@@ -907,6 +937,253 @@ static int cmd_dpseci_destroy_v10(void)
 	return destroy_dpseci(MC_FW_VERSION_10);
 }
 
+/* SEC hardware priorities a tx queue can have */
+#define DPSECI_SEC_PRIO_MAX	8
+
+/* the tx queues of each SEC priority, and where the rx queues are sent */
+struct dpseci_queue_usage {
+	unsigned int num_objs;
+	unsigned int tx_queues[DPSECI_SEC_PRIO_MAX + 1];
+	unsigned int tx_objs[DPSECI_SEC_PRIO_MAX + 1];
+	unsigned int rx_dest[DPSECI_DEST_DPCON + 1];
+};
+
+static const char *dpseci_dest_str(enum dpseci_dest dest_type)
+{
+	switch (dest_type) {
+	case DPSECI_DEST_NONE:
+		return "none";
+	case DPSECI_DEST_DPIO:
+		return "dpio";
+	case DPSECI_DEST_DPCON:
+		return "dpcon";
+	default:
+		return "?";
+	}
+}
+
+/**
+ * Print the tx and rx queues of a DPSECI side by side, and add them to
+ * the usage of all the DPSECIs
+ */
+static int print_dpseci_queues(uint32_t dpseci_id,
+			       struct dpseci_queue_usage *usage)
+{
+	struct dpseci_rx_queue_attr_v10 rx_attr;
+	struct dpseci_tx_queue_attr_v10 tx_attr;
+	struct dpseci_attr_v10 dpseci_attr;
+	bool used[DPSECI_SEC_PRIO_MAX + 1] = { false };
+	bool dpseci_opened = false;
+	uint16_t dpseci_handle;
+	unsigned int num_queues;
+	char dest[32];
+	int error;
+
+	error = dpseci_open_v10(&restool.mc_io, 0, dpseci_id, &dpseci_handle);
+	if (error < 0)
+		goto out_mc;
+	dpseci_opened = true;
+	if (0 == dpseci_handle) {
+		DEBUG_PRINTF(
+			"dpseci_open() returned invalid handle (auth 0) for dpseci.%u\n",
+			dpseci_id);
+		error = -ENOENT;
+		goto out;
+	}
+
+	memset(&dpseci_attr, 0, sizeof(dpseci_attr));
+	error = dpseci_get_attributes_v10(&restool.mc_io, 0, dpseci_handle,
+					  &dpseci_attr);
+	if (error < 0)
+		goto out_mc;
+
+	printf("dpseci.%u: %u tx queues, %u rx queues\n", dpseci_id,
+	       dpseci_attr.num_tx_queues, dpseci_attr.num_rx_queues);
+	printf("  %-5s %-10s %-8s %-10s %-12s %-9s %s\n", "queue", "tx-fqid",
+	       "sec-prio", "rx-fqid", "rx-dest", "dest-prio", "order");
+
+	num_queues = dpseci_attr.num_tx_queues > dpseci_attr.num_rx_queues ?
+		     dpseci_attr.num_tx_queues : dpseci_attr.num_rx_queues;
+	for (unsigned int q = 0; q < num_queues; q++) {
+		printf("  %-5u", q);
+
+		if (q < dpseci_attr.num_tx_queues) {
+			error = dpseci_get_tx_queue_v10(&restool.mc_io, 0,
+							dpseci_handle, q,
+							&tx_attr);
+			if (error < 0)
+				goto out_mc;
+
+			printf(" %#-10x %-8u", tx_attr.fqid, tx_attr.priority);
+			if (tx_attr.priority <= DPSECI_SEC_PRIO_MAX) {
+				usage->tx_queues[tx_attr.priority]++;
+				used[tx_attr.priority] = true;
+			}
+		} else {
+			printf(" %-10s %-8s", "-", "-");
+		}
+
+		if (q < dpseci_attr.num_rx_queues) {
+			memset(&rx_attr, 0, sizeof(rx_attr));
+			error = dpseci_get_rx_queue_v10(&restool.mc_io, 0,
+							dpseci_handle, q,
+							&rx_attr);
+			if (error < 0)
+				goto out_mc;
+
+			if (rx_attr.dest_type == DPSECI_DEST_NONE)
+				snprintf(dest, sizeof(dest), "none");
+			else
+				snprintf(dest, sizeof(dest), "%s.%d",
+					 dpseci_dest_str(rx_attr.dest_type),
+					 rx_attr.dest_id);
+			printf(" %#-10x %-12s %-9u %s", rx_attr.fqid, dest,
+			       rx_attr.dest_priority,
+			       rx_attr.order_preservation_en ? "strict" : "-");
+			if (rx_attr.dest_type <= DPSECI_DEST_DPCON)
+				usage->rx_dest[rx_attr.dest_type]++;
+		}
+		printf("\n");
+	}
+
+	for (int p = 0; p <= DPSECI_SEC_PRIO_MAX; p++)
+		usage->tx_objs[p] += used[p];
+	usage->num_objs++;
+	goto out;
+
+out_mc:
+	mc_status = flib_error_to_mc_status(error);
+	ERROR_PRINTF("MC error: %s (status %#x)\n",
+		     mc_status_to_string(mc_status), mc_status);
+out:
+	if (dpseci_opened) {
+		int error2;
+
+		error2 = dpseci_close_v10(&restool.mc_io, 0, dpseci_handle);
+		if (error2 < 0) {
+			mc_status = flib_error_to_mc_status(error2);
+			ERROR_PRINTF("MC error: %s (status %#x)\n",
+				     mc_status_to_string(mc_status), mc_status);
+			if (error == 0)
+				error = error2;
+		}
+	}
+
+	return error;
+}
+
+static void print_dpseci_queue_usage(const struct dpseci_queue_usage *usage)
+{
+	unsigned int total = 0;
+
+	for (int p = 0; p <= DPSECI_SEC_PRIO_MAX; p++)
+		total += usage->tx_queues[p];
+
+	printf("\nSEC priority usage, %u tx queues in %u dpseci:\n", total,
+	       usage->num_objs);
+	printf("  %-8s %-9s %-7s %s\n", "sec-prio", "tx-queues", "share%",
+	       "dpseci");
+	for (int p = 0; p <= DPSECI_SEC_PRIO_MAX; p++) {
+		if (usage->tx_queues[p] == 0)
+			continue;
+
+		printf("  %-8d %-9u %-7.1f %u\n", p, usage->tx_queues[p],
+		       100.0 * usage->tx_queues[p] / total, usage->tx_objs[p]);
+	}
+
+	printf("rx queue destinations: ");
+	for (int d = DPSECI_DEST_NONE; d <= DPSECI_DEST_DPCON; d++)
+		printf("%s%s %u", d == DPSECI_DEST_NONE ? "" : ", ",
+		       dpseci_dest_str(d), usage->rx_dest[d]);
+	printf("\n");
+}
+
+static int cmd_dpseci_queues_v10(void)
+{
+	static const char usage_msg[] =
+		"\n"
+		"Usage: restool dpseci queues <dpseci-object> | --all\n"
+		"\n"
+		"  Prints the tx queues of a DPSECI, towards the SEC, with their\n"
+		"  FQID and SEC priority, and its rx queues, back from the SEC,\n"
+		"  with their FQID and the DPIO or DPCON they are sent to.\n"
+		"  Then prints how many tx queues use each SEC priority and how\n"
+		"  many DPSECIs use it, and where the rx queues go.\n"
+		"\n"
+		"OPTIONS:\n"
+		"--all\n"
+		"   Prints the queues of all the DPSECIs\n"
+		"\n"
+		"EXAMPLE:\n"
+		"   $ restool dpseci queues --all\n"
+		"\n";
+
+	struct dpseci_queue_usage usage = { 0 };
+	struct obj_index index;
+	uint32_t dpseci_id;
+	unsigned int num = 0;
+	int error;
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(QUEUES_OPT_HELP)) {
+		puts(usage_msg);
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(QUEUES_OPT_HELP);
+		return 0;
+	}
+
+	if (!(restool.cmd_option_mask & ONE_BIT_MASK(QUEUES_OPT_ALL))) {
+		if (restool.obj_name == NULL) {
+			ERROR_PRINTF("<object> argument missing\n");
+			puts(usage_msg);
+			return -EINVAL;
+		}
+
+		error = parse_object_name(restool.obj_name, "dpseci",
+					  &dpseci_id);
+		if (error < 0)
+			return error;
+
+		error = print_dpseci_queues(dpseci_id, &usage);
+		if (error < 0)
+			return error;
+
+		print_dpseci_queue_usage(&usage);
+		return 0;
+	}
+
+	restool.cmd_option_mask &= ~ONE_BIT_MASK(QUEUES_OPT_ALL);
+	if (restool.obj_name != NULL) {
+		ERROR_PRINTF("--all and <object> are exclusive\n");
+		puts(usage_msg);
+		return -EINVAL;
+	}
+
+	error = obj_index_get(&index);
+	if (error < 0)
+		return error;
+
+	for (unsigned int i = 0; i < index.num_entries; i++) {
+		if (strcmp(index.entries[i].type, "dpseci") != 0)
+			continue;
+
+		if (num++ != 0)
+			printf("\n");
+		error = print_dpseci_queues(index.entries[i].id, &usage);
+		if (error < 0)
+			break;
+	}
+	obj_index_free(&index);
+	if (error < 0)
+		return error;
+
+	if (num == 0) {
+		ERROR_PRINTF("no DPSECI found\n");
+		return -ENOENT;
+	}
+
+	print_dpseci_queue_usage(&usage);
+	return 0;
+}
+
 struct object_command dpseci_commands_v9[] = {
 	{ .cmd_name = "--help",
 	  .options = NULL,
@@ -944,6 +1221,10 @@ struct object_command dpseci_commands_v10[] = {
 	  .options = dpseci_destroy_options,
 	  .cmd_func = cmd_dpseci_destroy_v10 },
 
+	{ .cmd_name = "queues",
+	  .options = dpseci_queues_options,
+	  .cmd_func = cmd_dpseci_queues_v10 },
+
 	{ .cmd_name = NULL },
 };
 
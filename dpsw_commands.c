@@ -37,10 +37,12 @@
 #include <stdint.h>
 #include <errno.h>
 #include <assert.h>
+#include <ctype.h>
 #include <getopt.h>
 #include <sys/ioctl.h>
 #include "restool.h"
 #include "utils.h"
+#include "mc_sched.h"
 #include "mc_v9/fsl_dpsw.h"
 #include "mc_v10/fsl_dpsw.h"
 
@@ -283,7 +285,103 @@ static struct option dpsw_update_options[] = {
 	{ 0 },
 };
 
-C_ASSERT(ARRAY_SIZE(dpsw_destroy_options) <= MAX_NUM_CMD_LINE_OPTIONS + 1);
+C_ASSERT(ARRAY_SIZE(dpsw_update_options) <= MAX_NUM_CMD_LINE_OPTIONS + 1);
+
+/**
+ * dpsw stats command options
+ */
+enum dpsw_stats_options {
+	STATS_OPT_HELP = 0,
+	STATS_OPT_WATCH,
+	STATS_OPT_COUNT,
+	STATS_OPT_DURATION,
+	STATS_OPT_SORT,
+	STATS_OPT_TOP,
+};
+
+static struct option dpsw_stats_options[] = {
+	[STATS_OPT_HELP] = {
+		.name = "help",
+		.has_arg = 0,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[STATS_OPT_WATCH] = {
+		.name = "watch",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[STATS_OPT_COUNT] = {
+		.name = "count",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[STATS_OPT_DURATION] = {
+		.name = "duration",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[STATS_OPT_SORT] = {
+		.name = "sort",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[STATS_OPT_TOP] = {
+		.name = "top",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	{ 0 },
+};
+
+C_ASSERT(ARRAY_SIZE(dpsw_stats_options) <= MAX_NUM_CMD_LINE_OPTIONS + 1);
+
+/**
+ * dpsw taildrop command options
+ */
+enum dpsw_taildrop_options {
+	TAILDROP_OPT_HELP = 0,
+	TAILDROP_OPT_PROFILE,
+	TAILDROP_OPT_CHECK,
+};
+
+static struct option dpsw_taildrop_options[] = {
+	[TAILDROP_OPT_HELP] = {
+		.name = "help",
+		.has_arg = 0,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[TAILDROP_OPT_PROFILE] = {
+		.name = "profile",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[TAILDROP_OPT_CHECK] = {
+		.name = "check",
+		.has_arg = 0,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	{ 0 },
+};
+
+C_ASSERT(ARRAY_SIZE(dpsw_taildrop_options) <= MAX_NUM_CMD_LINE_OPTIONS + 1);
 
 const struct flib_ops dpsw_ops = {
 	.obj_open = dpsw_open_v10,
@@ -331,6 +429,8 @@ static int cmd_dpsw_help(void)
 		"   create - creates a new child DPSW under the root DPRC.\n"
 		"   destroy - destroys a child DPSW under the root DPRC.\n"
 		"   update - configure a child DPSW under the root DPRC.\n"
+		"   stats - displays the counters of all the ports of a DPSW.\n"
+		"   taildrop - applies or checks a per-port taildrop profile.\n"
 		"\n"
 		"For command-specific help, use the --help option of each command.\n"
 		"\n";
@@ -395,7 +495,7 @@ static int print_dpsw_endpoint(uint32_t target_id, uint16_t num_ifs,
 		endpoint1.id = target_id;
 		endpoint1.if_id = k;
 
-		error = dprc_get_connection(&restool.mc_io, 0,
+		error = dprc_get_connection(&restool.mc_io, CONN_LANE,
 					restool.root_dprc_handle,
 					&endpoint1,
 					&endpoint2,
@@ -462,7 +562,7 @@ static int print_dpsw_endpoint(uint32_t target_id, uint16_t num_ifs,
 		for (counter_iterator = DPSW_CNT_ING_FRAME;
 		     counter_iterator <= DPSW_CNT_ING_NO_BUFFER_DISCARD;
 		     counter_iterator++) {
-			error = dpsw_if_get_counter(&restool.mc_io, 0,
+			error = dpsw_if_get_counter(&restool.mc_io, CNT_LANE,
 					token, k, counter_iterator,
 					&counter);
 			if (error)
@@ -1514,6 +1614,839 @@ struct object_command dpsw_commands_v9[] = {
 	{ .cmd_name = NULL },
 };
 
+#define DPSW_NUM_COUNTERS	(DPSW_CNT_ING_NO_BUFFER_DISCARD + 1)
+
+C_ASSERT(ARRAY_SIZE(dpsw_counter_stats) == DPSW_NUM_COUNTERS);
+
+/* column names of the dpsw stats matrix, one per counter */
+static const char *const dpsw_counter_columns[] = {
+	[DPSW_CNT_ING_FRAME] = "ing-frm",
+	[DPSW_CNT_ING_BYTE] = "ing-byte",
+	[DPSW_CNT_ING_FLTR_FRAME] = "ing-fltr",
+	[DPSW_CNT_ING_FRAME_DISCARD] = "ing-disc",
+	[DPSW_CNT_ING_MCAST_FRAME] = "ing-mc",
+	[DPSW_CNT_ING_MCAST_BYTE] = "ing-mc-B",
+	[DPSW_CNT_ING_BCAST_FRAME] = "ing-bc",
+	[DPSW_CNT_ING_BCAST_BYTES] = "ing-bc-B",
+	[DPSW_CNT_EGR_FRAME] = "egr-frm",
+	[DPSW_CNT_EGR_BYTE] = "egr-byte",
+	[DPSW_CNT_EGR_FRAME_DISCARD] = "egr-disc",
+	[DPSW_CNT_EGR_STP_FRAME_DISCARD] = "egr-stp",
+	[DPSW_CNT_ING_NO_BUFFER_DISCARD] = "ing-nobuf",
+};
+
+C_ASSERT(ARRAY_SIZE(dpsw_counter_columns) == DPSW_NUM_COUNTERS);
+
+/* the sort keys beyond the counters: the port and its discards */
+#define DPSW_SORT_PORT		(-1)
+#define DPSW_SORT_DISCARDS	DPSW_NUM_COUNTERS
+
+/* the counters of one port, and their rates once there are two samples */
+struct dpsw_port_stats {
+	uint16_t if_id;
+	uint64_t counters[DPSW_NUM_COUNTERS];
+	double values[DPSW_NUM_COUNTERS + 1];
+};
+
+struct dpsw_stats_task {
+	uint32_t dpsw_id;
+	struct dpsw_port_stats *port;
+};
+
+static int read_dpsw_port_stats(struct fsl_mc_io *mc_io, uint16_t token,
+				struct dpsw_port_stats *port)
+{
+	int error;
+
+	for (int c = 0; c < DPSW_NUM_COUNTERS; c++) {
+		error = dpsw_if_get_counter(mc_io, CNT_LANE, token,
+					    port->if_id, c,
+					    &port->counters[c]);
+		if (error)
+			return error;
+	}
+
+	return 0;
+}
+
+static int dpsw_stats_task_run(struct fsl_mc_io *mc_io, void *arg)
+{
+	struct dpsw_stats_task *task = arg;
+	uint16_t token;
+	int error, error2;
+
+	error = dpsw_open_v10(mc_io, 0, task->dpsw_id, &token);
+	if (error < 0)
+		return error;
+
+	error = read_dpsw_port_stats(mc_io, token, task->port);
+	error2 = dpsw_close_v10(mc_io, 0, token);
+
+	return error ? error : error2;
+}
+
+/**
+ * Read all the counters of all the ports, one task per port spread over
+ * the MC portals of 'sched' when there is one
+ */
+static int read_dpsw_stats(struct mc_sched *sched, uint16_t token,
+			   struct dpsw_stats_task *tasks,
+			   struct dpsw_port_stats *ports, uint16_t num_ifs)
+{
+	int error = 0;
+
+	if (!sched) {
+		for (int i = 0; i < num_ifs && error == 0; i++)
+			error = read_dpsw_port_stats(&restool.mc_io, token,
+						     &ports[i]);
+		return error;
+	}
+
+	for (int i = 0; i < num_ifs; i++) {
+		error = mc_sched_submit(sched, dpsw_stats_task_run, &tasks[i]);
+		if (error < 0)
+			break;
+	}
+
+	return error ? error : mc_sched_wait(sched);
+}
+
+static int dpsw_sort_key;
+
+static int cmp_dpsw_ports(const void *a, const void *b)
+{
+	const struct dpsw_port_stats *pa = a;
+	const struct dpsw_port_stats *pb = b;
+
+	if (dpsw_sort_key == DPSW_SORT_PORT)
+		return pa->if_id - pb->if_id;
+
+	/* largest first, then by port */
+	if (pa->values[dpsw_sort_key] != pb->values[dpsw_sort_key])
+		return pa->values[dpsw_sort_key] < pb->values[dpsw_sort_key] ?
+		       1 : -1;
+
+	return pa->if_id - pb->if_id;
+}
+
+static void print_dpsw_stats_matrix(struct dpsw_port_stats *ports,
+				    uint16_t num_ifs, unsigned int top)
+{
+	qsort(ports, num_ifs, sizeof(*ports), cmp_dpsw_ports);
+
+	printf("%4s", "port");
+	for (int c = 0; c < DPSW_NUM_COUNTERS; c++)
+		printf(" %9s", dpsw_counter_columns[c]);
+	printf(" %9s\n", "discards");
+
+	for (int i = 0; i < num_ifs && (!top || (unsigned int)i < top);
+	     i++) {
+		printf("%4u", ports[i].if_id);
+		for (int c = 0; c <= DPSW_NUM_COUNTERS; c++)
+			print_stat_value(ports[i].values[c]);
+		printf("\n");
+	}
+}
+
+/**
+ * Compute what is printed for each port: the counters themselves for the
+ * first sample, their rate per second since 'prev' for the next ones
+ */
+static void compute_dpsw_values(struct dpsw_port_stats *ports,
+				const struct dpsw_port_stats *prev,
+				uint16_t num_ifs, double secs)
+{
+	static const int discard_counters[] = {
+		DPSW_CNT_ING_FRAME_DISCARD,
+		DPSW_CNT_EGR_FRAME_DISCARD,
+		DPSW_CNT_EGR_STP_FRAME_DISCARD,
+		DPSW_CNT_ING_NO_BUFFER_DISCARD,
+	};
+
+	for (int i = 0; i < num_ifs; i++) {
+		struct dpsw_port_stats *port = &ports[i];
+
+		port->values[DPSW_SORT_DISCARDS] = 0;
+		for (int c = 0; c < DPSW_NUM_COUNTERS; c++) {
+			uint64_t cur = port->counters[c];
+			uint64_t old = prev ? prev[port->if_id].counters[c] : 0;
+
+			if (!prev)
+				port->values[c] = cur;
+			else
+				port->values[c] = cur >= old ?
+						  (cur - old) / secs : 0;
+		}
+
+		for (unsigned int d = 0; d < ARRAY_SIZE(discard_counters); d++)
+			port->values[DPSW_SORT_DISCARDS] +=
+				port->values[discard_counters[d]];
+	}
+}
+
+/**
+ * Print the counters of all the ports of a DPSW and, if repeat, their
+ * rates on every interval of the watch
+ */
+static int dpsw_stats(uint32_t dpsw_id, struct watch *watch, bool repeat,
+		      unsigned int top)
+{
+	struct dpsw_port_stats *ports = NULL, *prev = NULL, *shown = NULL;
+	struct dpsw_stats_task *tasks = NULL;
+	struct mc_sched *sched = NULL;
+	struct dpsw_attr_v10 dpsw_attr;
+	bool dpsw_opened = false;
+	uint16_t dpsw_handle;
+	int error, error2;
+
+	error = dpsw_open_v10(&restool.mc_io, 0, dpsw_id, &dpsw_handle);
+	if (error < 0) {
+		mc_status = flib_error_to_mc_status(error);
+		ERROR_PRINTF("MC error: %s (status %#x)\n",
+			     mc_status_to_string(mc_status), mc_status);
+		goto out;
+	}
+	dpsw_opened = true;
+	if (0 == dpsw_handle) {
+		DEBUG_PRINTF(
+			"dpsw_open() returned invalid handle (auth 0) for dpsw.%u\n",
+			dpsw_id);
+		error = -ENOENT;
+		goto out;
+	}
+
+	memset(&dpsw_attr, 0, sizeof(dpsw_attr));
+	error = dpsw_get_attributes_v10(&restool.mc_io, 0, dpsw_handle,
+					&dpsw_attr);
+	if (error < 0) {
+		mc_status = flib_error_to_mc_status(error);
+		ERROR_PRINTF("MC error: %s (status %#x)\n",
+			     mc_status_to_string(mc_status), mc_status);
+		goto out;
+	}
+
+	ports = calloc(dpsw_attr.num_ifs, sizeof(*ports));
+	prev = calloc(dpsw_attr.num_ifs, sizeof(*prev));
+	shown = calloc(dpsw_attr.num_ifs, sizeof(*shown));
+	tasks = calloc(dpsw_attr.num_ifs, sizeof(*tasks));
+	if (!ports || !prev || !shown || !tasks) {
+		error = -ENOMEM;
+		goto out;
+	}
+
+	for (int i = 0; i < dpsw_attr.num_ifs; i++) {
+		ports[i].if_id = i;
+		tasks[i].dpsw_id = dpsw_id;
+		tasks[i].port = &ports[i];
+	}
+
+	if (restool.num_jobs > 1 && dpsw_attr.num_ifs > 1) {
+		error = mc_sched_create(&sched, &restool.mc_io,
+					restool.device_file, restool.num_jobs,
+					restool.max_in_flight);
+		if (error < 0)
+			goto out;
+	}
+
+	watch_start(watch);
+	do {
+		error = read_dpsw_stats(sched, dpsw_handle, tasks, ports,
+					dpsw_attr.num_ifs);
+		if (error) {
+			mc_status = flib_error_to_mc_status(error);
+			ERROR_PRINTF("MC error: %s (status %#x)\n",
+				     mc_status_to_string(mc_status), mc_status);
+			break;
+		}
+
+		/* sorting must not reorder the samples the rates come from */
+		memcpy(shown, ports, dpsw_attr.num_ifs * sizeof(*shown));
+		if (watch->samples == 0) {
+			compute_dpsw_values(shown, NULL, dpsw_attr.num_ifs, 0);
+			printf("dpsw.%u counters:\n", dpsw_id);
+		} else {
+			double secs = timespec_elapsed(&watch->last, &watch->now);
+
+			compute_dpsw_values(shown, prev, dpsw_attr.num_ifs,
+					    secs);
+			printf("\ndpsw.%u rates per second over %.1f s:\n",
+			       dpsw_id, secs);
+		}
+
+		print_dpsw_stats_matrix(shown, dpsw_attr.num_ifs, top);
+		fflush(stdout);
+		memcpy(prev, ports, dpsw_attr.num_ifs * sizeof(*prev));
+	} while (repeat && watch_next(watch));
+
+	watch_stop(watch);
+out:
+	mc_sched_destroy(sched);
+	free(tasks);
+	free(shown);
+	free(prev);
+	free(ports);
+	if (dpsw_opened) {
+		error2 = dpsw_close_v10(&restool.mc_io, 0, dpsw_handle);
+		if (error2 < 0) {
+			mc_status = flib_error_to_mc_status(error2);
+			ERROR_PRINTF("MC error: %s (status %#x)\n",
+				     mc_status_to_string(mc_status), mc_status);
+			if (error == 0)
+				error = error2;
+		}
+	}
+
+	return error;
+}
+
+static int cmd_dpsw_stats_v10(void)
+{
+	static const char usage_msg[] =
+		"\n"
+		"Usage: restool dpsw stats <dpsw-object> [--watch=<ms>]\n"
+		"	[--count=<n>] [--duration=<seconds>] [--sort=<column>]\n"
+		"	[--top=<n>]\n"
+		"\n"
+		"  Prints all the counters of all the ports of a DPSW, one row\n"
+		"  per port, and a discards column summing the ing-disc,\n"
+		"  egr-disc, egr-stp and ing-nobuf columns. With --jobs, the\n"
+		"  ports are read in parallel on several MC portals.\n"
+		"\n"
+		"OPTIONS:\n"
+		"--watch=<ms>\n"
+		"   Samples the counters again every <ms> milliseconds and\n"
+		"   prints their rate per second, until interrupted\n"
+		"--count=<n>\n"
+		"   Stops after <n> intervals, of 1000 ms without --watch\n"
+		"--duration=<seconds>\n"
+		"   Stops after <seconds>\n"
+		"--sort=<column>\n"
+		"   Sorts the ports by this column, largest first: port, one\n"
+		"   of the counter columns, e.g. egr-disc, or discards\n"
+		"--top=<n>\n"
+		"   Only prints the first <n> ports, by discards unless --sort\n"
+		"   is given\n"
+		"\n"
+		"EXAMPLE:\n"
+		"Show the 4 ports with the most discards, every 2 seconds:\n"
+		"   $ restool dpsw stats dpsw.0 --watch=2000 --top=4\n"
+		"\n";
+
+	struct watch watch = { .interval_ms = 1000 };
+	unsigned int top = 0;
+	uint32_t dpsw_id;
+	int repeat;
+	long value;
+	int error;
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(STATS_OPT_HELP)) {
+		puts(usage_msg);
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(STATS_OPT_HELP);
+		return 0;
+	}
+
+	if (restool.obj_name == NULL) {
+		ERROR_PRINTF("<object> argument missing\n");
+		puts(usage_msg);
+		return -EINVAL;
+	}
+
+	error = parse_object_name(restool.obj_name, "dpsw", &dpsw_id);
+	if (error < 0)
+		return error;
+
+	dpsw_sort_key = DPSW_SORT_PORT;
+	if (restool.cmd_option_mask & ONE_BIT_MASK(STATS_OPT_TOP)) {
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(STATS_OPT_TOP);
+		error = get_option_value(STATS_OPT_TOP, &value,
+					 "Invalid number of ports", 1,
+					 UINT16_MAX);
+		if (error)
+			return -EINVAL;
+		top = (unsigned int)value;
+		dpsw_sort_key = DPSW_SORT_DISCARDS;
+	}
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(STATS_OPT_SORT)) {
+		const char *column = restool.cmd_option_args[STATS_OPT_SORT];
+
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(STATS_OPT_SORT);
+		if (strcmp(column, "port") == 0) {
+			dpsw_sort_key = DPSW_SORT_PORT;
+		} else if (strcmp(column, "discards") == 0) {
+			dpsw_sort_key = DPSW_SORT_DISCARDS;
+		} else {
+			int c;
+
+			for (c = 0; c < DPSW_NUM_COUNTERS; c++)
+				if (strcmp(column, dpsw_counter_columns[c]) == 0 ||
+				    strcmp(column, dpsw_counter_stats[c]) == 0)
+					break;
+
+			if (c == DPSW_NUM_COUNTERS) {
+				ERROR_PRINTF("Invalid column: %s\n", column);
+				puts(usage_msg);
+				return -EINVAL;
+			}
+			dpsw_sort_key = c;
+		}
+	}
+
+	repeat = get_watch_options(&watch, STATS_OPT_WATCH, STATS_OPT_COUNT,
+				   STATS_OPT_DURATION);
+	if (repeat < 0)
+		return repeat;
+
+	return dpsw_stats(dpsw_id, &watch, repeat, top);
+}
+
+/* traffic classes of each DPSW interface */
+#define DPSW_NUM_TCS	8
+
+static const char *const dpsw_taildrop_units[] = {
+	[DPSW_TAILDROP_DROP_UNIT_BYTE] = "BYTES",
+	[DPSW_TAILDROP_DROP_UNIT_FRAMES] = "FRAMES",
+	[DPSW_TAILDROP_DROP_UNIT_BUFFERS] = "BUFFERS",
+};
+
+/* the taildrop a profile asks for on one TC of one interface */
+struct dpsw_taildrop_entry {
+	bool set;
+	unsigned int line;
+	struct dpsw_taildrop_cfg cfg;
+};
+
+static const char *dpsw_taildrop_unit_str(enum dpsw_congestion_unit units)
+{
+	if ((unsigned int)units < ARRAY_SIZE(dpsw_taildrop_units))
+		return dpsw_taildrop_units[units];
+
+	return "?";
+}
+
+/**
+ * Parse '*', '<n>' or '<first>-<last>' into a range of [0, count)
+ */
+static int parse_dpsw_taildrop_range(const char *str, unsigned int count,
+				     unsigned int *first, unsigned int *last)
+{
+	unsigned long a, b;
+	char *end;
+
+	if (strcmp(str, "*") == 0) {
+		*first = 0;
+		*last = count - 1;
+		return 0;
+	}
+
+	if (!isdigit((unsigned char)str[0]))
+		return -EINVAL;
+	a = strtoul(str, &end, 10);
+	b = a;
+	if (*end == '-') {
+		if (!isdigit((unsigned char)end[1]))
+			return -EINVAL;
+		b = strtoul(end + 1, &end, 10);
+	}
+
+	if (*end != '\0' || a > b || b >= count)
+		return -EINVAL;
+
+	*first = a;
+	*last = b;
+	return 0;
+}
+
+/**
+ * Parse one line of a taildrop profile:
+ *	<port> <tc> <0|1> [<units> <threshold>]
+ * Later lines override the entries set by earlier ones.
+ */
+static int parse_dpsw_taildrop_line(char *line, unsigned int line_num,
+				    struct dpsw_taildrop_entry *entries,
+				    uint16_t num_ifs)
+{
+	struct dpsw_taildrop_cfg cfg = { 0 };
+	unsigned int if_first, if_last, tc_first, tc_last;
+	char *fields[6], *cursor, *end;
+	unsigned int n = 0;
+	unsigned long value;
+
+	cursor = strchr(line, '#');
+	if (cursor)
+		*cursor = '\0';
+
+	for (char *token = strtok_r(line, " \t\r\n", &cursor);
+	     token && n < ARRAY_SIZE(fields);
+	     token = strtok_r(NULL, " \t\r\n", &cursor))
+		fields[n++] = token;
+
+	if (n == 0)
+		return 0;
+
+	if (n != 3 && n != 5) {
+		ERROR_PRINTF("line %u: expected <port> <tc> <0|1> [<units> <threshold>]\n",
+			     line_num);
+		return -EINVAL;
+	}
+
+	if (parse_dpsw_taildrop_range(fields[0], num_ifs,
+				      &if_first, &if_last) < 0) {
+		ERROR_PRINTF("line %u: invalid port '%s', the DPSW has %u interfaces\n",
+			     line_num, fields[0], num_ifs);
+		return -EINVAL;
+	}
+
+	if (parse_dpsw_taildrop_range(fields[1], DPSW_NUM_TCS,
+				      &tc_first, &tc_last) < 0) {
+		ERROR_PRINTF("line %u: invalid traffic class '%s'\n",
+			     line_num, fields[1]);
+		return -EINVAL;
+	}
+
+	if (strcmp(fields[2], "0") != 0 && strcmp(fields[2], "1") != 0) {
+		ERROR_PRINTF("line %u: taildrop must be 0 or 1\n", line_num);
+		return -EINVAL;
+	}
+	cfg.enable = fields[2][0] == '1';
+
+	if (cfg.enable && n != 5) {
+		ERROR_PRINTF("line %u: enabling taildrop needs units and a threshold\n",
+			     line_num);
+		return -EINVAL;
+	}
+
+	if (n == 5) {
+		unsigned int u;
+
+		for (u = 0; u < ARRAY_SIZE(dpsw_taildrop_units); u++)
+			if (strcasecmp(fields[3], dpsw_taildrop_units[u]) == 0)
+				break;
+		if (u == ARRAY_SIZE(dpsw_taildrop_units)) {
+			ERROR_PRINTF("line %u: invalid units '%s'\n",
+				     line_num, fields[3]);
+			return -EINVAL;
+		}
+		cfg.units = u;
+
+		errno = 0;
+		value = strtoul(fields[4], &end, 0);
+		if (errno || *end != '\0' || !isdigit((unsigned char)fields[4][0]) ||
+		    value > UINT32_MAX) {
+			ERROR_PRINTF("line %u: invalid threshold '%s'\n",
+				     line_num, fields[4]);
+			return -EINVAL;
+		}
+		cfg.threshold = value;
+	}
+
+	for (unsigned int i = if_first; i <= if_last; i++) {
+		for (unsigned int tc = tc_first; tc <= tc_last; tc++) {
+			struct dpsw_taildrop_entry *entry =
+				&entries[i * DPSW_NUM_TCS + tc];
+
+			entry->set = true;
+			entry->line = line_num;
+			entry->cfg = cfg;
+		}
+	}
+
+	return 0;
+}
+
+static int load_dpsw_taildrop_profile(const char *path,
+				      struct dpsw_taildrop_entry *entries,
+				      uint16_t num_ifs)
+{
+	unsigned int line_num = 0;
+	size_t len = 0;
+	char *line = NULL;
+	FILE *fp;
+	int error = 0;
+
+	fp = fopen(path, "r");
+	if (!fp) {
+		error = -errno;
+		ERROR_PRINTF("cannot open %s: %s\n", path, strerror(errno));
+		return error;
+	}
+
+	while (getline(&line, &len, fp) != -1) {
+		error = parse_dpsw_taildrop_line(line, ++line_num, entries,
+						 num_ifs);
+		if (error < 0)
+			break;
+	}
+
+	free(line);
+	fclose(fp);
+	return error;
+}
+
+/* a disabled taildrop matches whatever units and threshold are left */
+static bool dpsw_taildrop_equal(const struct dpsw_taildrop_cfg *a,
+				const struct dpsw_taildrop_cfg *b)
+{
+	if (!a->enable != !b->enable)
+		return false;
+
+	return !a->enable ||
+	       (a->units == b->units && a->threshold == b->threshold);
+}
+
+/**
+ * Read back the taildrop of every TC the profile sets and print the ones
+ * which differ; returns the number of differences
+ */
+static int diff_dpsw_taildrop(uint16_t token,
+			      const struct dpsw_taildrop_entry *entries,
+			      uint16_t num_ifs, unsigned int *checked)
+{
+	struct dpsw_taildrop_cfg cfg;
+	int diffs = 0;
+	int error;
+
+	*checked = 0;
+	for (unsigned int i = 0; i < num_ifs; i++) {
+		for (unsigned int tc = 0; tc < DPSW_NUM_TCS; tc++) {
+			const struct dpsw_taildrop_entry *entry =
+				&entries[i * DPSW_NUM_TCS + tc];
+
+			if (!entry->set)
+				continue;
+
+			memset(&cfg, 0, sizeof(cfg));
+			error = dpsw_if_get_taildrop(&restool.mc_io, 0, token,
+						     i, tc, &cfg);
+			if (error)
+				return error;
+			(*checked)++;
+
+			if (dpsw_taildrop_equal(&entry->cfg, &cfg))
+				continue;
+
+			printf("port %u tc %u (line %u): want %d %s %u, got %d %s %u\n",
+			       i, tc, entry->line, !!entry->cfg.enable,
+			       dpsw_taildrop_unit_str(entry->cfg.units),
+			       entry->cfg.threshold, !!cfg.enable,
+			       dpsw_taildrop_unit_str(cfg.units),
+			       cfg.threshold);
+			diffs++;
+		}
+	}
+
+	return diffs;
+}
+
+/* print the taildrop of all the TCs, in the profile format */
+static int print_dpsw_taildrop(uint16_t token, uint16_t num_ifs)
+{
+	struct dpsw_taildrop_cfg cfg;
+	int error;
+
+	printf("# port\ttc\ttaildrop\tunits\tthreshold\n");
+	for (unsigned int i = 0; i < num_ifs; i++) {
+		for (unsigned int tc = 0; tc < DPSW_NUM_TCS; tc++) {
+			memset(&cfg, 0, sizeof(cfg));
+			error = dpsw_if_get_taildrop(&restool.mc_io, 0, token,
+						     i, tc, &cfg);
+			if (error)
+				return error;
+
+			printf("%u\t%u\t%d\t\t%s\t%u\n", i, tc, !!cfg.enable,
+			       dpsw_taildrop_unit_str(cfg.units),
+			       cfg.threshold);
+		}
+	}
+
+	return 0;
+}
+
+static int apply_dpsw_taildrop(uint16_t token,
+			       struct dpsw_taildrop_entry *entries,
+			       uint16_t num_ifs, unsigned int *applied)
+{
+	int error;
+
+	*applied = 0;
+	for (unsigned int i = 0; i < num_ifs; i++) {
+		for (unsigned int tc = 0; tc < DPSW_NUM_TCS; tc++) {
+			struct dpsw_taildrop_entry *entry =
+				&entries[i * DPSW_NUM_TCS + tc];
+
+			if (!entry->set)
+				continue;
+
+			error = dpsw_if_set_taildrop(&restool.mc_io, 0, token,
+						     i, tc, &entry->cfg);
+			if (error) {
+				ERROR_PRINTF("port %u tc %u (line %u) failed\n",
+					     i, tc, entry->line);
+				return error;
+			}
+			(*applied)++;
+		}
+	}
+
+	return 0;
+}
+
+static int dpsw_taildrop(uint32_t dpsw_id, const char *profile, bool check)
+{
+	struct dpsw_taildrop_entry *entries = NULL;
+	struct dpsw_attr_v10 dpsw_attr;
+	unsigned int applied, checked;
+	bool dpsw_opened = false;
+	uint16_t dpsw_handle;
+	int error, error2;
+	int diffs;
+
+	error = dpsw_open_v10(&restool.mc_io, 0, dpsw_id, &dpsw_handle);
+	if (error < 0)
+		goto out_mc;
+	dpsw_opened = true;
+	if (0 == dpsw_handle) {
+		DEBUG_PRINTF(
+			"dpsw_open() returned invalid handle (auth 0) for dpsw.%u\n",
+			dpsw_id);
+		error = -ENOENT;
+		goto out;
+	}
+
+	memset(&dpsw_attr, 0, sizeof(dpsw_attr));
+	error = dpsw_get_attributes_v10(&restool.mc_io, 0, dpsw_handle,
+					&dpsw_attr);
+	if (error < 0)
+		goto out_mc;
+
+	if (!profile) {
+		error = print_dpsw_taildrop(dpsw_handle, dpsw_attr.num_ifs);
+		if (error < 0)
+			goto out_mc;
+		goto out;
+	}
+
+	entries = calloc(dpsw_attr.num_ifs * DPSW_NUM_TCS, sizeof(*entries));
+	if (!entries) {
+		error = -ENOMEM;
+		goto out;
+	}
+
+	error = load_dpsw_taildrop_profile(profile, entries,
+					   dpsw_attr.num_ifs);
+	if (error < 0)
+		goto out;
+
+	if (!check) {
+		error = apply_dpsw_taildrop(dpsw_handle, entries,
+					    dpsw_attr.num_ifs, &applied);
+		if (error < 0)
+			goto out_mc;
+		printf("dpsw.%u: %u taildrop entries applied\n", dpsw_id,
+		       applied);
+	}
+
+	diffs = diff_dpsw_taildrop(dpsw_handle, entries, dpsw_attr.num_ifs,
+				   &checked);
+	if (diffs < 0) {
+		error = diffs;
+		goto out_mc;
+	}
+
+	printf("dpsw.%u: %u taildrop entries checked, %d differ\n", dpsw_id,
+	       checked, diffs);
+	if (diffs)
+		error = -EIO;
+	goto out;
+
+out_mc:
+	mc_status = flib_error_to_mc_status(error);
+	ERROR_PRINTF("MC error: %s (status %#x)\n",
+		     mc_status_to_string(mc_status), mc_status);
+out:
+	free(entries);
+	if (dpsw_opened) {
+		error2 = dpsw_close_v10(&restool.mc_io, 0, dpsw_handle);
+		if (error2 < 0) {
+			mc_status = flib_error_to_mc_status(error2);
+			ERROR_PRINTF("MC error: %s (status %#x)\n",
+				     mc_status_to_string(mc_status), mc_status);
+			if (error == 0)
+				error = error2;
+		}
+	}
+
+	return error;
+}
+
+static int cmd_dpsw_taildrop_v10(void)
+{
+	static const char usage_msg[] =
+		"\n"
+		"Usage: restool dpsw taildrop <dpsw-object> [--profile=<file>]\n"
+		"	[--check]\n"
+		"\n"
+		"  Without --profile, prints the taildrop of all the traffic\n"
+		"  classes of all the interfaces, in the profile format.\n"
+		"\n"
+		"OPTIONS:\n"
+		"--profile=<file>\n"
+		"   Applies the taildrop profile in <file>, then reads it back\n"
+		"   and prints the entries which differ. Each line of the file is\n"
+		"	<port> <tc> <0|1> [<units> <threshold>]\n"
+		"   where <port> and <tc> are a number, a range like 0-3 or *,\n"
+		"   and <units> is BYTES, FRAMES or BUFFERS. A line overrides\n"
+		"   the entries set by the lines before it, # starts a comment.\n"
+		"--check\n"
+		"   Only compares the DPSW with the profile, without applying it\n"
+		"\n"
+		"EXAMPLE:\n"
+		"Limit all the queues to 64KB, and TC 7 of ports 0-3 to 512 frames:\n"
+		"   $ cat td.profile\n"
+		"   *   *  1  BYTES   65536\n"
+		"   0-3 7  1  FRAMES  512\n"
+		"   $ restool dpsw taildrop dpsw.0 --profile=td.profile\n"
+		"\n";
+
+	const char *profile = NULL;
+	bool check = false;
+	uint32_t dpsw_id;
+	int error;
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(TAILDROP_OPT_HELP)) {
+		puts(usage_msg);
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(TAILDROP_OPT_HELP);
+		return 0;
+	}
+
+	if (restool.obj_name == NULL) {
+		ERROR_PRINTF("<object> argument missing\n");
+		puts(usage_msg);
+		return -EINVAL;
+	}
+
+	error = parse_object_name(restool.obj_name, "dpsw", &dpsw_id);
+	if (error < 0)
+		return error;
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(TAILDROP_OPT_PROFILE)) {
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(TAILDROP_OPT_PROFILE);
+		profile = restool.cmd_option_args[TAILDROP_OPT_PROFILE];
+	}
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(TAILDROP_OPT_CHECK)) {
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(TAILDROP_OPT_CHECK);
+		if (!profile) {
+			ERROR_PRINTF("--check needs --profile\n");
+			puts(usage_msg);
+			return -EINVAL;
+		}
+		check = true;
+	}
+
+	return dpsw_taildrop(dpsw_id, profile, check);
+}
+
 struct object_command dpsw_commands_v10[] = {
 	{ .cmd_name = "--help",
 	  .options = NULL,
@@ -1533,7 +2466,15 @@ struct object_command dpsw_commands_v10[] = {
 
 	{ .cmd_name = "update",
 	  .options = dpsw_update_options,
-	  .cmd_func = cmd_dpsw_update_v10 }, 
+	  .cmd_func = cmd_dpsw_update_v10 },
+
+	{ .cmd_name = "stats",
+	  .options = dpsw_stats_options,
+	  .cmd_func = cmd_dpsw_stats_v10 },
+
+	{ .cmd_name = "taildrop",
+	  .options = dpsw_taildrop_options,
+	  .cmd_func = cmd_dpsw_taildrop_v10 },
 
 	{ .cmd_name = NULL },
 };
@@ -0,0 +1,798 @@
+/* Copyright 2026 NXP
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * * Neither the name of the above-listed copyright holders nor the
+ * names of any contributors may be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ *
+ * ALTERNATIVELY, this software may be distributed under the terms of the
+ * GNU General Public License ("GPL") as published by the Free Software
+ * Foundation, either version 2 of that License or (at your option) any
+ * later version.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * librestool: reentrant access to the MC for applications embedding restool.
+ *
+ * Unlike the restool command line tool, nothing in here uses the global
+ * restool state: everything needed to talk to the MC is carried by an
+ * explicit struct restool_ctx. The tool runs its container, label and
+ * connection commands through a context attached to its own MC session.
+ *
+ * The container operations go through the dprc API, which is driven the
+ * same way on MC firmware 9.x and 10.x; the object operations use the
+ * 10.x object APIs and fail with -EOPNOTSUPP on 9.x.
+ */
+#include <dirent.h>
+#include <endian.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include "restool.h"
+#include "utils.h"
+#include "librestool.h"
+#include "mc_v10/fsl_dpni.h"
+
+C_ASSERT(RESTOOL_DPNI_STATS_CNT == DPNI_STATISTICS_CNT);
+C_ASSERT(RESTOOL_OBJ_TYPE_SIZE == sizeof(((struct dprc_obj_desc *)0)->type));
+C_ASSERT(RESTOOL_OBJ_LABEL_SIZE ==
+	 sizeof(((struct dprc_obj_desc *)0)->label));
+
+struct dprc_handle_entry {
+	uint32_t dprc_id;
+	uint16_t token;
+};
+
+struct restool_ctx {
+	/**
+	 * MC portal used by this context: own_mc_io, or the portal of the
+	 * session the context is attached to
+	 */
+	struct fsl_mc_io *mc_io;
+	struct fsl_mc_io own_mc_io;
+
+	/**
+	 * the MC portal and the root container handle belong to the
+	 * session the context is attached to, and are not closed with it
+	 */
+	bool attached;
+
+	/**
+	 * serializes the calls made on this context
+	 */
+	pthread_mutex_t lock;
+
+	/**
+	 * MC firmware version, read once when the context is opened
+	 */
+	struct mc_version mc_fw_version;
+
+	/**
+	 * Id and handle of the root container
+	 */
+	uint32_t root_dprc_id;
+	uint16_t root_dprc_handle;
+
+	/**
+	 * Handles of the other containers opened so far, kept open until
+	 * the context is closed
+	 */
+	struct dprc_handle_entry *dprc_handles;
+	unsigned int num_dprc_handles;
+};
+
+enum mc_cmd_status flib_error_to_mc_status(int error)
+{
+	switch (error) {
+	case 0:
+		return MC_CMD_STATUS_OK;
+	case -EACCES:
+		return MC_CMD_STATUS_AUTH_ERR;
+	case -EPERM:
+		return MC_CMD_STATUS_NO_PRIVILEGE;
+	case -EIO:
+		return MC_CMD_STATUS_DMA_ERR;
+	case -ENXIO:
+		return MC_CMD_STATUS_CONFIG_ERR;
+	case -ETIMEDOUT:
+		return MC_CMD_STATUS_TIMEOUT;
+	case -ENAVAIL:
+		return MC_CMD_STATUS_NO_RESOURCE;
+	case -ENOMEM:
+		return MC_CMD_STATUS_NO_MEMORY;
+	case -EBUSY:
+		return MC_CMD_STATUS_BUSY;
+	case -524:
+		/* #define ENOTSUPP 524 in Linux, no ENOTSUPP in user space */
+		return MC_CMD_STATUS_UNSUPPORTED_OP;
+	case -ENODEV:
+		return MC_CMD_STATUS_INVALID_STATE;
+	default:
+		break;
+	}
+
+	/* Not expected to reach here */
+	return error;	/* 1000 == 0x3e8 */
+}
+
+const char *mc_status_to_string(enum mc_cmd_status status)
+{
+	static const char *const status_strings[] = {
+		[MC_CMD_STATUS_OK] = "Command completed successfully",
+		[MC_CMD_STATUS_READY] = "Command ready to be processed",
+		[MC_CMD_STATUS_AUTH_ERR] = "Authentication error",
+		[MC_CMD_STATUS_NO_PRIVILEGE] = "No privilege",
+		[MC_CMD_STATUS_DMA_ERR] = "DMA or I/O error",
+		[MC_CMD_STATUS_CONFIG_ERR] = "Configuration error",
+		[MC_CMD_STATUS_TIMEOUT] = "Operation timed out",
+		[MC_CMD_STATUS_NO_RESOURCE] = "No resources",
+		[MC_CMD_STATUS_NO_MEMORY] = "No memory available",
+		[MC_CMD_STATUS_BUSY] = "Device is busy",
+		[MC_CMD_STATUS_UNSUPPORTED_OP] = "Unsupported operation",
+		[MC_CMD_STATUS_INVALID_STATE] = "Invalid state"
+	};
+
+	if ((unsigned int)status >= ARRAY_SIZE(status_strings))
+		return "Unknown MC error";
+
+	return status_strings[status];
+}
+
+const char *restool_strerror(int error)
+{
+	int mc_status = flib_error_to_mc_status(error);
+
+	if (mc_status < 0)
+		return strerror(-error);
+
+	return mc_status_to_string(mc_status);
+}
+
+/**
+ * Find the device file of the root container, the same way the
+ * restool command line tool does
+ */
+static int ctx_find_device_file(const char *root_dprc,
+				char *device_file, size_t size)
+{
+	struct dirent *dir;
+	int num_dev_files = 0;
+	int n = 0;
+	DIR *d;
+
+	if (root_dprc != NULL) {
+		if (strncmp(root_dprc, "dprc.", 5) != 0)
+			return -EINVAL;
+		n = snprintf(device_file, size, "/dev/%s", root_dprc);
+	} else if (access("/dev/mc_restool", F_OK) == 0) {
+		n = snprintf(device_file, size, "/dev/mc_restool");
+	} else {
+		d = opendir("/dev");
+		if (!d)
+			return -errno;
+
+		while ((dir = readdir(d)) != NULL) {
+			if (strncmp(dir->d_name, "dprc.", 5) != 0)
+				continue;
+			if (num_dev_files++ == 0)
+				n = snprintf(device_file, size, "/dev/%s",
+					     dir->d_name);
+		}
+		closedir(d);
+
+		if (num_dev_files != 1)
+			return num_dev_files == 0 ? -ENODEV : -EEXIST;
+	}
+
+	if (n < 0 || (size_t)n >= size)
+		return -ENAMETOOLONG;
+
+	if (access(device_file, F_OK) != 0)
+		return -errno;
+
+	return 0;
+}
+
+static int ctx_get_root_dprc_id(struct restool_ctx *ctx,
+				const char *device_file)
+{
+	int error;
+
+	if (ctx->mc_io->legacy) {
+		error = ioctl(ctx->mc_io->fd, RESTOOL_GET_ROOT_DPRC_INFO,
+			      &ctx->root_dprc_id);
+		return error == -1 ? -errno : 0;
+	}
+
+	if (sscanf(device_file, "/dev/dprc.%u", &ctx->root_dprc_id) != 1)
+		return -EINVAL;
+
+	return 0;
+}
+
+/**
+ * MC firmware 9.x is only little-endian, and older versions are not
+ * supported by restool at all
+ */
+static int ctx_check_mc_version(const struct mc_version *mc_fw_version)
+{
+	if (mc_fw_version->major < MC_FW_VERSION_9)
+		return -EOPNOTSUPP;
+
+#if __BYTE_ORDER == __BIG_ENDIAN
+	if (mc_fw_version->major == MC_FW_VERSION_9)
+		return -EOPNOTSUPP;
+#endif
+
+	return 0;
+}
+
+int restool_ctx_open(struct restool_ctx **ctx_out, const char *root_dprc)
+{
+	char device_file[DEV_FILE_SIZE];
+	struct restool_ctx *ctx;
+	int error;
+
+	error = ctx_find_device_file(root_dprc, device_file,
+				     sizeof(device_file));
+	if (error < 0)
+		return error;
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (!ctx)
+		return -ENOMEM;
+
+	ctx->mc_io = &ctx->own_mc_io;
+	error = mc_io_init(ctx->mc_io, device_file);
+	if (error < 0)
+		goto err_free;
+
+	error = mc_get_version(ctx->mc_io, 0, &ctx->mc_fw_version);
+	if (error < 0)
+		goto err_cleanup;
+
+	error = ctx_check_mc_version(&ctx->mc_fw_version);
+	if (error < 0)
+		goto err_cleanup;
+
+	error = ctx_get_root_dprc_id(ctx, device_file);
+	if (error < 0)
+		goto err_cleanup;
+
+	error = dprc_open(ctx->mc_io, 0, ctx->root_dprc_id,
+			  &ctx->root_dprc_handle);
+	if (error < 0)
+		goto err_cleanup;
+
+	pthread_mutex_init(&ctx->lock, NULL);
+	*ctx_out = ctx;
+	return 0;
+
+err_cleanup:
+	mc_io_cleanup(ctx->mc_io);
+err_free:
+	free(ctx);
+	return error;
+}
+
+int restool_ctx_attach(struct restool_ctx **ctx_out,
+		       struct fsl_mc_io *mc_io,
+		       const struct mc_version *mc_fw_version,
+		       uint32_t root_dprc_id,
+		       uint16_t root_dprc_handle)
+{
+	struct restool_ctx *ctx;
+	int error;
+
+	error = ctx_check_mc_version(mc_fw_version);
+	if (error < 0)
+		return error;
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (!ctx)
+		return -ENOMEM;
+
+	ctx->mc_io = mc_io;
+	ctx->attached = true;
+	ctx->mc_fw_version = *mc_fw_version;
+	ctx->root_dprc_id = root_dprc_id;
+	ctx->root_dprc_handle = root_dprc_handle;
+	pthread_mutex_init(&ctx->lock, NULL);
+	*ctx_out = ctx;
+	return 0;
+}
+
+void restool_ctx_close(struct restool_ctx *ctx)
+{
+	if (ctx == NULL)
+		return;
+
+	for (unsigned int i = 0; i < ctx->num_dprc_handles; i++)
+		(void)dprc_close(ctx->mc_io, 0, ctx->dprc_handles[i].token);
+
+	if (!ctx->attached) {
+		(void)dprc_close(ctx->mc_io, 0, ctx->root_dprc_handle);
+		mc_io_cleanup(ctx->mc_io);
+	}
+	pthread_mutex_destroy(&ctx->lock);
+	free(ctx->dprc_handles);
+	free(ctx);
+}
+
+void restool_ctx_get_mc_version(struct restool_ctx *ctx, uint32_t *major,
+				uint32_t *minor, uint32_t *revision)
+{
+	*major = ctx->mc_fw_version.major;
+	*minor = ctx->mc_fw_version.minor;
+	*revision = ctx->mc_fw_version.revision;
+}
+
+uint32_t restool_ctx_get_root_dprc_id(struct restool_ctx *ctx)
+{
+	return ctx->root_dprc_id;
+}
+
+/**
+ * Get a handle for container 'dprc_id', opening it on first use.
+ * Must be called with the context lock held.
+ */
+static int ctx_get_dprc(struct restool_ctx *ctx, uint32_t dprc_id,
+			uint16_t *token)
+{
+	struct dprc_handle_entry *handles;
+	int error;
+
+	if (dprc_id == ctx->root_dprc_id) {
+		*token = ctx->root_dprc_handle;
+		return 0;
+	}
+
+	for (unsigned int i = 0; i < ctx->num_dprc_handles; i++) {
+		if (ctx->dprc_handles[i].dprc_id == dprc_id) {
+			*token = ctx->dprc_handles[i].token;
+			return 0;
+		}
+	}
+
+	handles = realloc(ctx->dprc_handles,
+			  (ctx->num_dprc_handles + 1) * sizeof(*handles));
+	if (!handles)
+		return -ENOMEM;
+	ctx->dprc_handles = handles;
+
+	error = dprc_open(ctx->mc_io, 0, dprc_id, token);
+	if (error < 0)
+		return error;
+
+	handles[ctx->num_dprc_handles].dprc_id = dprc_id;
+	handles[ctx->num_dprc_handles].token = *token;
+	ctx->num_dprc_handles++;
+	return 0;
+}
+
+/**
+ * Close and forget the cached handle of a container about to be destroyed.
+ * Must be called with the context lock held.
+ */
+static void ctx_put_dprc(struct restool_ctx *ctx, uint32_t dprc_id)
+{
+	for (unsigned int i = 0; i < ctx->num_dprc_handles; i++) {
+		if (ctx->dprc_handles[i].dprc_id != dprc_id)
+			continue;
+
+		(void)dprc_close(ctx->mc_io, 0, ctx->dprc_handles[i].token);
+		ctx->dprc_handles[i] =
+			ctx->dprc_handles[--ctx->num_dprc_handles];
+		return;
+	}
+}
+
+static void obj_from_desc(struct restool_obj *obj,
+			  const struct dprc_obj_desc *desc,
+			  uint32_t parent_dprc_id)
+{
+	memset(obj, 0, sizeof(*obj));
+	memcpy(obj->type, desc->type, RESTOOL_OBJ_TYPE_SIZE - 1);
+	memcpy(obj->label, desc->label, RESTOOL_OBJ_LABEL_SIZE - 1);
+	obj->id = desc->id;
+	obj->parent_dprc_id = parent_dprc_id;
+	obj->ver_major = desc->ver_major;
+	obj->ver_minor = desc->ver_minor;
+	obj->irq_count = desc->irq_count;
+	obj->region_count = desc->region_count;
+	obj->state = desc->state;
+}
+
+static int ctx_walk(struct restool_ctx *ctx, uint32_t dprc_id,
+		    int nesting_level, bool recursive,
+		    restool_obj_cb_t *cb, void *arg)
+{
+	struct dprc_obj_desc desc;
+	struct restool_obj obj;
+	int num_child_devices;
+	uint16_t token;
+	int error;
+
+	if (nesting_level > MAX_DPRC_NESTING)
+		return -ELOOP;
+
+	error = ctx_get_dprc(ctx, dprc_id, &token);
+	if (error < 0)
+		return error;
+
+	error = dprc_get_obj_count(ctx->mc_io, 0, token, &num_child_devices);
+	if (error < 0)
+		return error;
+
+	for (int i = 0; i < num_child_devices; i++) {
+		memset(&desc, 0, sizeof(desc));
+		error = dprc_get_obj(ctx->mc_io, 0, token, i, &desc);
+		if (error < 0)
+			return error;
+
+		obj_from_desc(&obj, &desc, dprc_id);
+		error = cb(&obj, arg);
+		if (error != 0)
+			return error;
+
+		if (recursive && strcmp(desc.type, "dprc") == 0) {
+			error = ctx_walk(ctx, desc.id, nesting_level + 1,
+					 true, cb, arg);
+			if (error != 0)
+				return error;
+		}
+	}
+
+	return 0;
+}
+
+int restool_obj_list(struct restool_ctx *ctx, uint32_t dprc_id,
+		     bool recursive, restool_obj_cb_t *cb, void *arg)
+{
+	int error;
+
+	pthread_mutex_lock(&ctx->lock);
+	error = ctx_walk(ctx, dprc_id, 0, recursive, cb, arg);
+	pthread_mutex_unlock(&ctx->lock);
+
+	return error;
+}
+
+struct find_arg {
+	const char *type;
+	int id;
+	struct restool_obj *obj;
+};
+
+/* positive value stopping the walk once the object is found */
+#define OBJ_FOUND	1
+
+static int find_cb(const struct restool_obj *obj, void *arg)
+{
+	struct find_arg *find = arg;
+
+	if (obj->id != find->id || strcmp(obj->type, find->type) != 0)
+		return 0;
+
+	*find->obj = *obj;
+	return OBJ_FOUND;
+}
+
+/**
+ * Must be called with the context lock held
+ */
+static int ctx_find(struct restool_ctx *ctx, const char *type, int id,
+		    struct restool_obj *obj)
+{
+	struct find_arg find = { .type = type, .id = id, .obj = obj };
+	int error;
+
+	if (strcmp(type, "dprc") == 0 && (uint32_t)id == ctx->root_dprc_id) {
+		memset(obj, 0, sizeof(*obj));
+		strcpy(obj->type, "dprc");
+		obj->id = id;
+		obj->parent_dprc_id = ctx->root_dprc_id;
+		return 0;
+	}
+
+	error = ctx_walk(ctx, ctx->root_dprc_id, 0, true, find_cb, &find);
+	if (error == OBJ_FOUND)
+		return 0;
+
+	return error < 0 ? error : -ENOENT;
+}
+
+int restool_obj_info(struct restool_ctx *ctx, const char *type, int id,
+		     struct restool_obj *obj)
+{
+	int error;
+
+	pthread_mutex_lock(&ctx->lock);
+	error = ctx_find(ctx, type, id, obj);
+	pthread_mutex_unlock(&ctx->lock);
+
+	return error;
+}
+
+int restool_obj_set_label(struct restool_ctx *ctx, const char *type, int id,
+			  const char *label)
+{
+	char obj_type[RESTOOL_OBJ_TYPE_SIZE] = { 0 };
+	char obj_label[RESTOOL_OBJ_LABEL_SIZE] = { 0 };
+	struct restool_obj obj;
+	uint16_t token;
+	int error;
+
+	if (strlen(type) >= sizeof(obj_type) ||
+	    strlen(label) >= sizeof(obj_label))
+		return -EINVAL;
+
+	strcpy(obj_type, type);
+	strcpy(obj_label, label);
+
+	pthread_mutex_lock(&ctx->lock);
+	error = ctx_find(ctx, type, id, &obj);
+	if (error < 0)
+		goto out;
+
+	error = ctx_get_dprc(ctx, obj.parent_dprc_id, &token);
+	if (error < 0)
+		goto out;
+
+	error = dprc_set_obj_label(ctx->mc_io, 0, token, obj_type, id,
+				   obj_label);
+out:
+	pthread_mutex_unlock(&ctx->lock);
+	return error;
+}
+
+static int ctx_assign_or_unassign(struct restool_ctx *ctx,
+				  uint32_t parent_dprc_id,
+				  uint32_t child_dprc_id,
+				  const char *type, int id,
+				  uint32_t options, bool do_assign)
+{
+	struct dprc_res_req res_req;
+	uint16_t token;
+	int error;
+
+	memset(&res_req, 0, sizeof(res_req));
+	if (strlen(type) >= sizeof(res_req.type) || strcmp(type, "dprc") == 0)
+		return -EINVAL;
+
+	strcpy(res_req.type, type);
+	res_req.num = 1;
+	res_req.options = DPRC_RES_REQ_OPT_EXPLICIT | options;
+	res_req.id_base_align = id;
+
+	pthread_mutex_lock(&ctx->lock);
+	error = ctx_get_dprc(ctx, parent_dprc_id, &token);
+	if (error < 0)
+		goto out;
+
+	if (do_assign)
+		error = dprc_assign(ctx->mc_io, 0, token, child_dprc_id,
+				    &res_req);
+	else
+		error = dprc_unassign(ctx->mc_io, 0, token, child_dprc_id,
+				      &res_req);
+out:
+	pthread_mutex_unlock(&ctx->lock);
+	return error;
+}
+
+int restool_obj_assign(struct restool_ctx *ctx, uint32_t parent_dprc_id,
+		       uint32_t child_dprc_id, const char *type, int id,
+		       bool plugged)
+{
+	return ctx_assign_or_unassign(ctx, parent_dprc_id, child_dprc_id,
+				      type, id,
+				      plugged ? DPRC_RES_REQ_OPT_PLUGGED : 0,
+				      true);
+}
+
+int restool_obj_unassign(struct restool_ctx *ctx, uint32_t parent_dprc_id,
+			 uint32_t child_dprc_id, const char *type, int id)
+{
+	return ctx_assign_or_unassign(ctx, parent_dprc_id, child_dprc_id,
+				      type, id, 0, false);
+}
+
+int restool_dprc_create(struct restool_ctx *ctx, uint32_t parent_dprc_id,
+			uint64_t options, const char *label,
+			uint32_t *child_dprc_id)
+{
+	uint64_t mc_portal_offset;
+	struct dprc_cfg cfg;
+	int child_id;
+	uint16_t token;
+	int error;
+
+	memset(&cfg, 0, sizeof(cfg));
+	if (label != NULL) {
+		if (strlen(label) > MC_OBJ_LABEL_MAX_LENGTH)
+			return -EINVAL;
+		strcpy(cfg.label, label);
+	}
+	cfg.icid = DPRC_GET_ICID_FROM_POOL;
+	cfg.portal_id = DPRC_GET_PORTAL_ID_FROM_POOL;
+	cfg.options = options;
+
+	pthread_mutex_lock(&ctx->lock);
+	error = ctx_get_dprc(ctx, parent_dprc_id, &token);
+	if (error < 0)
+		goto out;
+
+	error = dprc_create_container(ctx->mc_io, 0, token, &cfg,
+				      &child_id, &mc_portal_offset);
+	if (error < 0)
+		goto out;
+
+	*child_dprc_id = child_id;
+out:
+	pthread_mutex_unlock(&ctx->lock);
+	return error;
+}
+
+int restool_dprc_destroy(struct restool_ctx *ctx, uint32_t child_dprc_id)
+{
+	struct restool_obj obj;
+	uint16_t token;
+	int error;
+
+	if (child_dprc_id == ctx->root_dprc_id)
+		return -EINVAL;
+
+	pthread_mutex_lock(&ctx->lock);
+	error = ctx_find(ctx, "dprc", child_dprc_id, &obj);
+	if (error < 0)
+		goto out;
+
+	ctx_put_dprc(ctx, child_dprc_id);
+	error = ctx_get_dprc(ctx, obj.parent_dprc_id, &token);
+	if (error < 0)
+		goto out;
+
+	error = dprc_destroy_container(ctx->mc_io, 0, token, child_dprc_id);
+out:
+	pthread_mutex_unlock(&ctx->lock);
+	return error;
+}
+
+static int endpoint_to_dprc(struct dprc_endpoint *dprc_ep,
+			    const struct restool_endpoint *ep)
+{
+	memset(dprc_ep, 0, sizeof(*dprc_ep));
+	if (strlen(ep->type) >= sizeof(dprc_ep->type))
+		return -EINVAL;
+
+	strcpy(dprc_ep->type, ep->type);
+	dprc_ep->id = ep->id;
+	dprc_ep->if_id = ep->if_id;
+	return 0;
+}
+
+int restool_connect(struct restool_ctx *ctx, uint32_t dprc_id,
+		    const struct restool_endpoint *endpoint1,
+		    const struct restool_endpoint *endpoint2,
+		    uint32_t committed_rate, uint32_t max_rate)
+{
+	struct dprc_connection_cfg cfg = {
+		.committed_rate = committed_rate,
+		.max_rate = max_rate,
+	};
+	struct dprc_endpoint ep1, ep2;
+	uint16_t token;
+	int error;
+
+	if (endpoint_to_dprc(&ep1, endpoint1) < 0 ||
+	    endpoint_to_dprc(&ep2, endpoint2) < 0)
+		return -EINVAL;
+
+	pthread_mutex_lock(&ctx->lock);
+	error = ctx_get_dprc(ctx, dprc_id, &token);
+	if (error == 0)
+		error = dprc_connect(ctx->mc_io, 0, token, &ep1, &ep2, &cfg);
+	pthread_mutex_unlock(&ctx->lock);
+
+	return error;
+}
+
+int restool_disconnect(struct restool_ctx *ctx, uint32_t dprc_id,
+		       const struct restool_endpoint *endpoint)
+{
+	struct dprc_endpoint ep;
+	uint16_t token;
+	int error;
+
+	if (endpoint_to_dprc(&ep, endpoint) < 0)
+		return -EINVAL;
+
+	pthread_mutex_lock(&ctx->lock);
+	error = ctx_get_dprc(ctx, dprc_id, &token);
+	if (error == 0)
+		error = dprc_disconnect(ctx->mc_io, 0, token, &ep);
+	pthread_mutex_unlock(&ctx->lock);
+
+	return error;
+}
+
+int restool_get_connection(struct restool_ctx *ctx, uint32_t dprc_id,
+			   const struct restool_endpoint *endpoint,
+			   struct restool_endpoint *peer, int *state)
+{
+	struct dprc_endpoint ep1, ep2;
+	uint16_t token;
+	int error;
+
+	if (endpoint_to_dprc(&ep1, endpoint) < 0)
+		return -EINVAL;
+
+	memset(&ep2, 0, sizeof(ep2));
+	pthread_mutex_lock(&ctx->lock);
+	error = ctx_get_dprc(ctx, dprc_id, &token);
+	if (error == 0)
+		error = dprc_get_connection(ctx->mc_io, PRI, token, &ep1, &ep2,
+					    state);
+	pthread_mutex_unlock(&ctx->lock);
+	if (error < 0)
+		return error;
+
+	memset(peer, 0, sizeof(*peer));
+	memcpy(peer->type, ep2.type, RESTOOL_OBJ_TYPE_SIZE - 1);
+	peer->id = ep2.id;
+	peer->if_id = ep2.if_id;
+	return 0;
+}
+
+int restool_dpni_get_stats(struct restool_ctx *ctx, int dpni_id,
+			   uint8_t page, uint16_t param,
+			   uint64_t counters[RESTOOL_DPNI_STATS_CNT])
+{
+	union dpni_statistics_v10 stats;
+	uint16_t token;
+	int error, error2;
+
+	if (ctx->mc_fw_version.major < MC_FW_VERSION_10)
+		return -EOPNOTSUPP;
+
+	pthread_mutex_lock(&ctx->lock);
+	error = dpni_open_v10(ctx->mc_io, 0, dpni_id, &token);
+	if (error < 0)
+		goto out;
+
+	memset(&stats, 0, sizeof(stats));
+	error = dpni_get_statistics_v10(ctx->mc_io, PRI, token, page, param,
+					&stats);
+	error2 = dpni_close_v10(ctx->mc_io, 0, token);
+	if (error == 0)
+		error = error2;
+	if (error == 0)
+		memcpy(counters, stats.raw.counter, sizeof(stats.raw.counter));
+out:
+	pthread_mutex_unlock(&ctx->lock);
+	return error;
+}
@@ -0,0 +1,199 @@
+/* Copyright 2026 NXP
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * * Neither the name of the above-listed copyright holders nor the
+ * names of any contributors may be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ *
+ * ALTERNATIVELY, this software may be distributed under the terms of the
+ * GNU General Public License ("GPL") as published by the Free Software
+ * Foundation, either version 2 of that License or (at your option) any
+ * later version.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _LIBRESTOOL_H_
+#define _LIBRESTOOL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define RESTOOL_API	__attribute__((visibility("default")))
+
+/**
+ * Size of the object type and label strings, including the null terminator
+ */
+#define RESTOOL_OBJ_TYPE_SIZE	16
+#define RESTOOL_OBJ_LABEL_SIZE	16
+
+/**
+ * Object state flags, see struct restool_obj
+ */
+#define RESTOOL_OBJ_STATE_OPEN		0x00000001
+#define RESTOOL_OBJ_STATE_PLUGGED	0x00000002
+
+/**
+ * Number of counters returned for each DPNI statistics page
+ */
+#define RESTOOL_DPNI_STATS_CNT	7
+
+/**
+ * struct restool_ctx - MC session
+ *
+ * Opaque handle holding the MC portal, the MC firmware version and the
+ * container handles opened on behalf of the caller. Every context owns
+ * its own MC portal, so independent contexts can be used concurrently;
+ * calls made on the same context from several threads are serialized.
+ */
+struct restool_ctx;
+
+/**
+ * struct restool_obj - MC object descriptor
+ * @type: object type (e.g. "dpni")
+ * @id: object id
+ * @label: object label, empty when not set
+ * @parent_dprc_id: id of the container holding the object
+ * @ver_major: object API major version
+ * @ver_minor: object API minor version
+ * @irq_count: number of interrupts of the object
+ * @region_count: number of mappable regions of the object
+ * @state: combination of RESTOOL_OBJ_STATE_ flags
+ */
+struct restool_obj {
+	char type[RESTOOL_OBJ_TYPE_SIZE];
+	int id;
+	char label[RESTOOL_OBJ_LABEL_SIZE];
+	uint32_t parent_dprc_id;
+	uint16_t ver_major;
+	uint16_t ver_minor;
+	uint8_t irq_count;
+	uint8_t region_count;
+	uint32_t state;
+};
+
+/**
+ * struct restool_endpoint - Connection endpoint
+ * @type: object type
+ * @id: object id
+ * @if_id: interface id, only meaningful for multi-port objects
+ *	   (dpsw, dpdmux); 0 otherwise
+ */
+struct restool_endpoint {
+	char type[RESTOOL_OBJ_TYPE_SIZE];
+	int id;
+	uint16_t if_id;
+};
+
+/**
+ * Callback invoked for each object by restool_obj_list(); a non-zero
+ * return value stops the walk and is returned to the caller.
+ */
+typedef int restool_obj_cb_t(const struct restool_obj *obj, void *arg);
+
+/*
+ * All functions returning int return 0 on success or a negative errno
+ * value on failure; use restool_strerror() to describe it.
+ */
+
+/*
+ * session handling: restool_ctx_open() fails with -EOPNOTSUPP on MC
+ * firmware older than 9.x, and on 9.x on big-endian hosts
+ */
+RESTOOL_API int restool_ctx_open(struct restool_ctx **ctx,
+				 const char *root_dprc);
+
+RESTOOL_API void restool_ctx_close(struct restool_ctx *ctx);
+
+RESTOOL_API void restool_ctx_get_mc_version(struct restool_ctx *ctx,
+					    uint32_t *major,
+					    uint32_t *minor,
+					    uint32_t *revision);
+
+RESTOOL_API uint32_t restool_ctx_get_root_dprc_id(struct restool_ctx *ctx);
+
+RESTOOL_API const char *restool_strerror(int error);
+
+/* objects */
+RESTOOL_API int restool_obj_list(struct restool_ctx *ctx,
+				 uint32_t dprc_id,
+				 bool recursive,
+				 restool_obj_cb_t *cb,
+				 void *arg);
+
+RESTOOL_API int restool_obj_info(struct restool_ctx *ctx,
+				 const char *type,
+				 int id,
+				 struct restool_obj *obj);
+
+RESTOOL_API int restool_obj_set_label(struct restool_ctx *ctx,
+				      const char *type,
+				      int id,
+				      const char *label);
+
+RESTOOL_API int restool_obj_assign(struct restool_ctx *ctx,
+				   uint32_t parent_dprc_id,
+				   uint32_t child_dprc_id,
+				   const char *type,
+				   int id,
+				   bool plugged);
+
+RESTOOL_API int restool_obj_unassign(struct restool_ctx *ctx,
+				     uint32_t parent_dprc_id,
+				     uint32_t child_dprc_id,
+				     const char *type,
+				     int id);
+
+/* containers */
+RESTOOL_API int restool_dprc_create(struct restool_ctx *ctx,
+				    uint32_t parent_dprc_id,
+				    uint64_t options,
+				    const char *label,
+				    uint32_t *child_dprc_id);
+
+RESTOOL_API int restool_dprc_destroy(struct restool_ctx *ctx,
+				     uint32_t child_dprc_id);
+
+/* connections */
+RESTOOL_API int restool_connect(struct restool_ctx *ctx,
+				uint32_t dprc_id,
+				const struct restool_endpoint *endpoint1,
+				const struct restool_endpoint *endpoint2,
+				uint32_t committed_rate,
+				uint32_t max_rate);
+
+RESTOOL_API int restool_disconnect(struct restool_ctx *ctx,
+				   uint32_t dprc_id,
+				   const struct restool_endpoint *endpoint);
+
+RESTOOL_API int restool_get_connection(struct restool_ctx *ctx,
+				       uint32_t dprc_id,
+				       const struct restool_endpoint *endpoint,
+				       struct restool_endpoint *peer,
+				       int *state);
+
+/* statistics: need MC firmware 10.x, fail with -EOPNOTSUPP on 9.x */
+RESTOOL_API int restool_dpni_get_stats(struct restool_ctx *ctx,
+				       int dpni_id,
+				       uint8_t page,
+				       uint16_t param,
+				       uint64_t counters[RESTOOL_DPNI_STATS_CNT]);
+
+#endif /* _LIBRESTOOL_H_ */
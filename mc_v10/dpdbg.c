@@ -355,11 +355,9 @@ int dpdbg_set_ctlu_profiling_counters(struct fsl_mc_io *mc_io,
 	struct mc_command cmd = {0};
 	struct dpdbg_cmd_set_ctlu_profiling_counters *cmd_params;
 
-	(void)(cmd_flags);
-
 	/* prepare command */
 	cmd.header = mc_encode_cmd_header(DPDBG_CMDID_SET_CTLU_PROFILING,
-					  0,
+					  cmd_flags,
 					  token);
 	cmd_params =
 		(struct dpdbg_cmd_set_ctlu_profiling_counters *) cmd.params;
@@ -397,11 +395,9 @@ int dpdbg_get_ctlu_profiling_counters(struct fsl_mc_io *mc_io,
 	struct dpdbg_rsp_get_ctlu_profiling_counters *rsp_params;
 	int err = 0;
 
-	(void)(cmd_flags);
-
 	/* prepare command */
-	cmd.header = mc_encode_cmd_header(DPDBG_CMDID_SET_CTLU_PROFILING,
-					  0,
+	cmd.header = mc_encode_cmd_header(DPDBG_CMDID_GET_CTLU_PROFILING,
+					  cmd_flags,
 					  token);
 	cmd_params =
 		(struct dpdbg_cmd_get_ctlu_profiling_counters *) cmd.params;
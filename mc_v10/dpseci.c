@@ -319,6 +319,54 @@ int dpseci_get_attributes_v10(struct fsl_mc_io *mc_io,
 	return 0;
 }
 
+/**
+ * dpseci_get_rx_queue_v10() - Retrieve Rx (to GPP) queue attributes.
+ * @mc_io:	Pointer to MC portal's I/O object
+ * @cmd_flags:	Command flags; one or more of 'MC_CMD_FLAG_'
+ * @token:	Token of DPSECI object
+ * @queue:	Select the queue relative to number of
+ *		priorities configured at DPSECI creation
+ * @attr:	Returned Rx queue attributes
+ *
+ * Return:	'0' on Success; Error code otherwise.
+ */
+int dpseci_get_rx_queue_v10(struct fsl_mc_io *mc_io,
+			    uint32_t cmd_flags,
+			    uint16_t token,
+			    uint8_t queue,
+			    struct dpseci_rx_queue_attr_v10 *attr)
+{
+	struct dpseci_rsp_get_rx_queue *rsp_params;
+	struct dpseci_cmd_get_queue *cmd_params;
+	struct mc_command cmd = { 0 };
+	int err;
+
+	/* prepare command */
+	cmd.header = mc_encode_cmd_header(DPSECI_CMDID_GET_RX_QUEUE,
+					  cmd_flags,
+					  token);
+	cmd_params = (struct dpseci_cmd_get_queue *)cmd.params;
+	cmd_params->queue = queue;
+
+	/* send command to mc*/
+	err = mc_send_command(mc_io, &cmd);
+	if (err)
+		return err;
+
+	/* retrieve response parameters */
+	rsp_params = (struct dpseci_rsp_get_rx_queue *)cmd.params;
+	attr->dest_id = le32_to_cpu(rsp_params->dest_id);
+	attr->dest_priority = rsp_params->dest_priority;
+	attr->dest_type = dpseci_get_field(rsp_params->dest_type, DEST_TYPE);
+	attr->user_ctx = le64_to_cpu(rsp_params->user_ctx);
+	attr->fqid = le32_to_cpu(rsp_params->fqid);
+	attr->order_preservation_en =
+		dpseci_get_field(rsp_params->order_preservation_en,
+				 ORDER_PRESERVATION);
+
+	return 0;
+}
+
 /**
  * dpseci_get_tx_queue_v10() - Retrieve Tx queue attributes.
  * @mc_io:	Pointer to MC portal's I/O object
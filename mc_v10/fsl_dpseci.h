@@ -134,6 +134,51 @@ int dpseci_get_attributes_v10(struct fsl_mc_io *mc_io,
 			      uint32_t cmd_flags,
 			      uint16_t token,
 			      struct dpseci_attr_v10 *attr);
+/**
+ * enum dpseci_dest - DPSECI destination types
+ * @DPSECI_DEST_NONE: Unassigned destination; The queue is set in parked mode
+ *		and does not generate FQDAN notifications; user is expected to
+ *		dequeue from the queue based on polling or other user-defined
+ *		method
+ * @DPSECI_DEST_DPIO: The queue is set in schedule mode and generates FQDAN
+ *		notifications to the specified DPIO; user is expected to dequeue
+ *		from the queue only after notification is received
+ * @DPSECI_DEST_DPCON: The queue is set in schedule mode and does not generate
+ *		FQDAN notifications, but is connected to the specified DPCON
+ *		object; user is expected to dequeue from the DPCON channel
+ */
+enum dpseci_dest {
+	DPSECI_DEST_NONE = 0,
+	DPSECI_DEST_DPIO,
+	DPSECI_DEST_DPCON,
+};
+
+/**
+ * struct dpseci_rx_queue_attr_v10 - Structure representing attributes of Rx queues
+ * @user_ctx: User context value provided in the frame descriptor of each
+ *	dequeued frame
+ * @order_preservation_en: Status of the strict order preservation configured
+ *	on the queue
+ * @dest_type: Destination type
+ * @dest_id: Either DPIO ID or DPCON ID, depending on the destination type
+ * @dest_priority: Priority selection within the DPIO or DPCON channel
+ * @fqid: Virtual FQID value to be used for dequeue operations
+ */
+struct dpseci_rx_queue_attr_v10 {
+	uint64_t user_ctx;
+	int order_preservation_en;
+	enum dpseci_dest dest_type;
+	int dest_id;
+	uint8_t dest_priority;
+	uint32_t fqid;
+};
+
+int dpseci_get_rx_queue_v10(struct fsl_mc_io *mc_io,
+			    uint32_t cmd_flags,
+			    uint16_t token,
+			    uint8_t queue,
+			    struct dpseci_rx_queue_attr_v10 *attr);
+
 /**
  * struct dpseci_tx_queue_attr_v10 - Structure representing attributes of Tx queues
  * @fqid: Virtual FQID to be used for sending frames to SEC hardware
@@ -56,6 +56,7 @@
 #define DPSECI_CMDID_GET_ATTR		DPSECI_CMD_V1(0x004)
 #define DPSECI_CMDID_GET_IRQ_MASK	DPSECI_CMD_V1(0x015)
 #define DPSECI_CMDID_GET_IRQ_STATUS	DPSECI_CMD_V1(0x016)
+#define DPSECI_CMDID_GET_RX_QUEUE	DPSECI_CMD_V1(0x196)
 #define DPSECI_CMDID_GET_TX_QUEUE	DPSECI_CMD_V1(0x197)
 
 /* Macros for accessing command fields smaller than 1byte */
@@ -67,6 +68,11 @@
 #define dpseci_get_field(var, field)      \
 	(((var) & DPSECI_MASK(field)) >> DPSECI_##field##_SHIFT)
 
+#define DPSECI_DEST_TYPE_SHIFT		0
+#define DPSECI_DEST_TYPE_SIZE		4
+#define DPSECI_ORDER_PRESERVATION_SHIFT	0
+#define DPSECI_ORDER_PRESERVATION_SIZE	1
+
 #pragma pack(push, 1)
 struct dpseci_cmd_open {
 	uint32_t dpseci_id;
@@ -118,6 +124,17 @@ struct dpseci_cmd_get_queue {
 	uint8_t queue;
 };
 
+struct dpseci_rsp_get_rx_queue {
+	uint32_t dest_id;
+	uint8_t dest_priority;
+	uint8_t pad;
+	uint8_t dest_type;
+	uint8_t pad1;
+	uint64_t user_ctx;
+	uint32_t fqid;
+	uint8_t order_preservation_en;
+};
+
 struct dpseci_rsp_get_tx_queue {
 	uint32_t pad;
 	uint32_t fqid;
@@ -106,8 +106,6 @@ enum mc_cmd_status {
 /* Command completion flag */
 #define MC_CMD_FLAG_INTR_DIS	0x01
 
-#define MC_CMD_HDR_FLAGS_MASK	0xFF00FF00
-
 static inline uint64_t mc_encode_cmd_header(uint16_t cmd_id,
 					    uint32_t cmd_flags,
 					    uint16_t token)
@@ -118,7 +116,10 @@ static inline uint64_t mc_encode_cmd_header(uint16_t cmd_id,
 	hdr->cmd_id = cpu_to_le16(cmd_id);
 	hdr->token = cpu_to_le16(token);
 	hdr->status = MC_CMD_STATUS_READY;
-	hdr->word[0] |= cpu_to_le32(cmd_flags & MC_CMD_HDR_FLAGS_MASK);
+	if (cmd_flags & MC_CMD_FLAG_PRI)
+		hdr->flags_hw = MC_CMD_FLAG_PRI;
+	if (cmd_flags & MC_CMD_FLAG_INTR_DIS)
+		hdr->flags_sw = MC_CMD_FLAG_INTR_DIS;
 
 	return header;
 }
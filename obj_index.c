@@ -0,0 +1,592 @@
+/* Copyright 2026 NXP
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * * Neither the name of the above-listed copyright holders nor the
+ * names of any contributors may be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ *
+ * ALTERNATIVELY, this software may be distributed under the terms of the
+ * GNU General Public License ("GPL") as published by the Free Software
+ * Foundation, either version 2 of that License or (at your option) any
+ * later version.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include "restool.h"
+#include "utils.h"
+#include "obj_index.h"
+
+#define OBJ_INDEX_MAGIC		"restool-obj-index"
+#define OBJ_INDEX_VERSION	1
+
+/*
+ * Completion uses an index checked less than this many seconds ago as is.
+ * restool drops the index whenever it changes the objects, so this only
+ * delays noticing the changes made by other MC users.
+ */
+#define OBJ_INDEX_TRUSTED_SECS	10
+
+static int get_index_dir(char *dir, size_t size)
+{
+	const char *env;
+	int len;
+
+	env = getenv("RESTOOL_CACHE_DIR");
+	if (env != NULL && env[0] != '\0') {
+		len = snprintf(dir, size, "%s", env);
+		goto out;
+	}
+
+	env = getenv("XDG_CACHE_HOME");
+	if (env != NULL && env[0] != '\0') {
+		len = snprintf(dir, size, "%s/restool", env);
+		goto out;
+	}
+
+	env = getenv("HOME");
+	if (env != NULL && env[0] != '\0')
+		len = snprintf(dir, size, "%s/.cache/restool", env);
+	else
+		len = snprintf(dir, size, "/tmp/restool-%u",
+			       (unsigned int)getuid());
+out:
+	return (len < 0 || (size_t)len >= size) ? -ENAMETOOLONG : 0;
+}
+
+/* one index per root container the user may select with --root */
+static int get_index_path(char *path, size_t size)
+{
+	char dir[PATH_MAX];
+	int error;
+	int len;
+
+	error = get_index_dir(dir, sizeof(dir));
+	if (error < 0)
+		return error;
+
+	len = snprintf(path, size, "%s/objects-%s", dir,
+		       restool.specified_dev_file[0] != '\0' ?
+		       restool.specified_dev_file : "default");
+
+	return (len < 0 || (size_t)len >= size) ? -ENAMETOOLONG : 0;
+}
+
+static int make_dirs(char *dir)
+{
+	for (char *p = dir + 1; ; p++) {
+		if (*p != '/' && *p != '\0')
+			continue;
+
+		char c = *p;
+
+		*p = '\0';
+		if (mkdir(dir, 0700) < 0 && errno != EEXIST) {
+			*p = c;
+			return -errno;
+		}
+
+		*p = c;
+		if (c == '\0')
+			break;
+	}
+
+	return 0;
+}
+
+static int add_entry(struct obj_index *index, const char *type,
+		     uint32_t id, uint32_t parent_id, const char *label)
+{
+	struct obj_index_entry *entry;
+
+	if (index->num_entries == index->max_entries) {
+		unsigned int max_entries = index->max_entries ?
+					   index->max_entries * 2 : 64;
+
+		entry = realloc(index->entries, max_entries * sizeof(*entry));
+		if (entry == NULL)
+			return -ENOMEM;
+
+		index->entries = entry;
+		index->max_entries = max_entries;
+	}
+
+	entry = &index->entries[index->num_entries++];
+	memset(entry, 0, sizeof(*entry));
+	strncpy(entry->type, type, sizeof(entry->type) - 1);
+	entry->id = id;
+	entry->parent_id = parent_id;
+	entry->obj_count = -1;
+	strncpy(entry->label, label, sizeof(entry->label) - 1);
+
+	return 0;
+}
+
+void obj_index_free(struct obj_index *index)
+{
+	free(index->entries);
+	memset(index, 0, sizeof(*index));
+}
+
+int obj_index_load(struct obj_index *index)
+{
+	char path[PATH_MAX];
+	char line[128];
+	unsigned int version;
+	int error;
+	FILE *f;
+
+	memset(index, 0, sizeof(*index));
+	error = get_index_path(path, sizeof(path));
+	if (error < 0)
+		return error;
+
+	f = fopen(path, "r");
+	if (f == NULL)
+		return -errno;
+
+	if (fgets(line, sizeof(line), f) == NULL ||
+	    sscanf(line, OBJ_INDEX_MAGIC " %u %u", &version,
+		   &index->root_dprc_id) != 2 ||
+	    version != OBJ_INDEX_VERSION) {
+		DEBUG_PRINTF("ignoring invalid object index %s\n", path);
+		error = -EINVAL;
+		goto out;
+	}
+
+	while (fgets(line, sizeof(line), f) != NULL) {
+		struct obj_index_entry entry = { 0 };
+		int n;
+
+		n = sscanf(line, "%15s %u %u %d %15[^\n]", entry.type,
+			   &entry.id, &entry.parent_id, &entry.obj_count,
+			   entry.label);
+		if (n < 4) {
+			error = -EINVAL;
+			goto out;
+		}
+
+		error = add_entry(index, entry.type, entry.id,
+				  entry.parent_id, entry.label);
+		if (error < 0)
+			goto out;
+
+		index->entries[index->num_entries - 1].obj_count =
+			entry.obj_count;
+	}
+
+out:
+	fclose(f);
+	if (error < 0)
+		obj_index_free(index);
+
+	return error;
+}
+
+int obj_index_save(const struct obj_index *index)
+{
+	char path[PATH_MAX];
+	char tmp_path[PATH_MAX + 16];
+	char *slash;
+	int error;
+	FILE *f;
+
+	error = get_index_path(path, sizeof(path));
+	if (error < 0)
+		return error;
+
+	slash = strrchr(path, '/');
+	*slash = '\0';
+	error = make_dirs(path);
+	*slash = '/';
+	if (error < 0)
+		return error;
+
+	/* readers never see a partially written index */
+	snprintf(tmp_path, sizeof(tmp_path), "%s.%d", path, (int)getpid());
+	f = fopen(tmp_path, "w");
+	if (f == NULL)
+		return -errno;
+
+	fprintf(f, OBJ_INDEX_MAGIC " %u %u\n", OBJ_INDEX_VERSION,
+		index->root_dprc_id);
+	for (unsigned int i = 0; i < index->num_entries; i++) {
+		const struct obj_index_entry *entry = &index->entries[i];
+
+		fprintf(f, "%s %u %u %d", entry->type, entry->id,
+			entry->parent_id, entry->obj_count);
+		if (entry->label[0] != '\0' &&
+		    strchr(entry->label, '\n') == NULL)
+			fprintf(f, " %s", entry->label);
+		fputc('\n', f);
+	}
+
+	if (fclose(f) != 0) {
+		error = -errno;
+		goto err;
+	}
+
+	if (rename(tmp_path, path) < 0) {
+		error = -errno;
+		goto err;
+	}
+
+	return 0;
+err:
+	unlink(tmp_path);
+	return error;
+}
+
+static int index_container(struct obj_index *index, unsigned int dprc_idx,
+			   uint16_t dprc_handle)
+{
+	static enum mc_cmd_status mc_status;
+	uint32_t dprc_id = index->entries[dprc_idx].id;
+	int num_objs;
+	int error;
+
+	error = dprc_get_obj_count(&restool.mc_io, 0, dprc_handle, &num_objs);
+	if (error < 0) {
+		mc_status = flib_error_to_mc_status(error);
+		ERROR_PRINTF("MC error: %s (status %#x)\n",
+			     mc_status_to_string(mc_status), mc_status);
+		return error;
+	}
+
+	index->entries[dprc_idx].obj_count = num_objs;
+	for (int i = 0; i < num_objs; i++) {
+		struct dprc_obj_desc obj_desc = { 0 };
+		uint16_t child_handle;
+		int error2;
+
+		error = dprc_get_obj(&restool.mc_io, 0, dprc_handle, i,
+				     &obj_desc);
+		if (error < 0) {
+			mc_status = flib_error_to_mc_status(error);
+			ERROR_PRINTF("MC error: %s (status %#x)\n",
+				     mc_status_to_string(mc_status), mc_status);
+			return error;
+		}
+
+		obj_desc.label[sizeof(obj_desc.label) - 1] = '\0';
+		error = add_entry(index, obj_desc.type, obj_desc.id, dprc_id,
+				  obj_desc.label);
+		if (error < 0)
+			return error;
+
+		if (strcmp(obj_desc.type, "dprc") != 0)
+			continue;
+
+		error = open_dprc(obj_desc.id, &child_handle);
+		if (error < 0)
+			return error;
+
+		error = index_container(index, index->num_entries - 1,
+					child_handle);
+
+		error2 = dprc_close(&restool.mc_io, 0, child_handle);
+		if (error2 < 0) {
+			mc_status = flib_error_to_mc_status(error2);
+			ERROR_PRINTF("MC error: %s (status %#x)\n",
+				     mc_status_to_string(mc_status), mc_status);
+			if (error == 0)
+				error = error2;
+		}
+
+		if (error < 0)
+			return error;
+	}
+
+	return 0;
+}
+
+int obj_index_build(struct obj_index *index)
+{
+	int error;
+
+	memset(index, 0, sizeof(*index));
+	error = ensure_mc_session();
+	if (error < 0)
+		return error;
+
+	index->root_dprc_id = restool.root_dprc_id;
+	error = add_entry(index, "dprc", restool.root_dprc_id,
+			  OBJ_INDEX_NO_PARENT, "");
+	if (error < 0)
+		goto out;
+
+	error = index_container(index, 0, restool.root_dprc_handle);
+out:
+	if (error < 0)
+		obj_index_free(index);
+
+	return error;
+}
+
+bool obj_index_is_current(const struct obj_index *index)
+{
+	if (index->num_entries == 0 ||
+	    index->root_dprc_id != restool.root_dprc_id)
+		return false;
+
+	for (unsigned int i = 0; i < index->num_entries; i++) {
+		const struct obj_index_entry *entry = &index->entries[i];
+		uint16_t dprc_handle;
+		int num_objs;
+		int error;
+
+		if (entry->obj_count < 0)
+			continue;
+
+		if (entry->id == restool.root_dprc_id) {
+			dprc_handle = restool.root_dprc_handle;
+		} else {
+			/* not open_dprc(): a stale container is not an error */
+			error = dprc_open(&restool.mc_io, 0, entry->id,
+					  &dprc_handle);
+			if (error < 0 || dprc_handle == 0)
+				return false;
+		}
+
+		error = dprc_get_obj_count(&restool.mc_io, 0, dprc_handle,
+					   &num_objs);
+		if (dprc_handle != restool.root_dprc_handle)
+			(void)dprc_close(&restool.mc_io, 0, dprc_handle);
+
+		if (error < 0 || num_objs != entry->obj_count)
+			return false;
+	}
+
+	return true;
+}
+
+/* whether the index on disk was built or checked a short while ago */
+static bool index_is_recent(void)
+{
+	char path[PATH_MAX];
+	struct stat st;
+	time_t now;
+
+	if (get_index_path(path, sizeof(path)) < 0 || stat(path, &st) < 0)
+		return false;
+
+	now = time(NULL);
+	return st.st_mtime <= now &&
+	       now - st.st_mtime < OBJ_INDEX_TRUSTED_SECS;
+}
+
+static void index_touch(void)
+{
+	char path[PATH_MAX];
+
+	if (get_index_path(path, sizeof(path)) == 0)
+		(void)utimes(path, NULL);
+}
+
+static int index_get(struct obj_index *index, bool trust_recent)
+{
+	int error;
+
+	error = obj_index_load(index);
+	if (error == 0 && trust_recent && index_is_recent())
+		return 0;
+
+	if (ensure_mc_session() < 0) {
+		/* a possibly stale index is better than none */
+		DEBUG_PRINTF("MC not available, using the index on disk\n");
+		return error;
+	}
+
+	if (error == 0 && obj_index_is_current(index)) {
+		index_touch();
+		return 0;
+	}
+
+	DEBUG_PRINTF("rebuilding the object index\n");
+	obj_index_free(index);
+	error = obj_index_build(index);
+	if (error < 0)
+		return error;
+
+	if (obj_index_save(index) < 0)
+		DEBUG_PRINTF("could not save the object index\n");
+
+	return 0;
+}
+
+int obj_index_get(struct obj_index *index)
+{
+	return index_get(index, false);
+}
+
+int obj_index_get_recent(struct obj_index *index)
+{
+	return index_get(index, true);
+}
+
+const struct obj_index_entry *obj_index_find(const struct obj_index *index,
+					     const char *type, uint32_t id)
+{
+	for (unsigned int i = 0; i < index->num_entries; i++) {
+		const struct obj_index_entry *entry = &index->entries[i];
+
+		if (entry->id == id && strcmp(entry->type, type) == 0)
+			return entry;
+	}
+
+	return NULL;
+}
+
+bool obj_index_in_container(const struct obj_index *index,
+			    const struct obj_index_entry *entry,
+			    uint32_t dprc_id)
+{
+	for (int level = 0; entry != NULL && level <= MAX_DPRC_NESTING;
+	     level++) {
+		if (entry->parent_id == dprc_id)
+			return true;
+
+		if (entry->parent_id == OBJ_INDEX_NO_PARENT)
+			break;
+
+		entry = obj_index_find(index, "dprc", entry->parent_id);
+	}
+
+	return false;
+}
+
+/* check that the object is still in its container, with the same label */
+static bool entry_is_current(const struct obj_index_entry *entry)
+{
+	struct dprc_obj_desc obj_desc;
+	uint16_t dprc_handle;
+	bool current = false;
+	int num_objs;
+	int error;
+
+	if (entry->parent_id == OBJ_INDEX_NO_PARENT)
+		return false;
+
+	if (entry->parent_id == restool.root_dprc_id) {
+		dprc_handle = restool.root_dprc_handle;
+	} else {
+		error = dprc_open(&restool.mc_io, 0, entry->parent_id,
+				  &dprc_handle);
+		if (error < 0 || dprc_handle == 0)
+			return false;
+	}
+
+	/* one container only: cheap next to rebuilding the whole index */
+	error = dprc_get_obj_count(&restool.mc_io, 0, dprc_handle, &num_objs);
+	for (int i = 0; error == 0 && i < num_objs; i++) {
+		memset(&obj_desc, 0, sizeof(obj_desc));
+		error = dprc_get_obj(&restool.mc_io, 0, dprc_handle, i,
+				     &obj_desc);
+		if (error < 0 || (uint32_t)obj_desc.id != entry->id ||
+		    strcmp(obj_desc.type, entry->type) != 0)
+			continue;
+
+		obj_desc.label[sizeof(obj_desc.label) - 1] = '\0';
+		current = strcmp(obj_desc.label, entry->label) == 0;
+		break;
+	}
+
+	if (dprc_handle != restool.root_dprc_handle)
+		(void)dprc_close(&restool.mc_io, 0, dprc_handle);
+
+	return current;
+}
+
+int obj_index_resolve_label(const char *label, char *name, size_t size)
+{
+	const struct obj_index_entry *found = NULL;
+	struct obj_index index;
+	unsigned int num_found;
+	int error;
+
+	error = obj_index_get(&index);
+	if (error < 0)
+		return error;
+
+	for (int attempt = 0; ; attempt++) {
+		num_found = 0;
+		for (unsigned int i = 0; i < index.num_entries; i++) {
+			if (strcmp(index.entries[i].label, label) != 0)
+				continue;
+
+			found = &index.entries[i];
+			num_found++;
+		}
+
+		/* a freshly built index is trusted as is */
+		if (attempt > 0 ||
+		    (num_found == 1 && entry_is_current(found)))
+			break;
+
+		DEBUG_PRINTF("index stale for label %s, rebuilding it\n",
+			     label);
+		obj_index_free(&index);
+		error = obj_index_build(&index);
+		if (error < 0)
+			return error;
+
+		if (obj_index_save(&index) < 0)
+			DEBUG_PRINTF("could not save the object index\n");
+	}
+
+	if (num_found == 0) {
+		ERROR_PRINTF("No object labeled \'%s\'\n", label);
+		error = -ENOENT;
+	} else if (num_found > 1) {
+		ERROR_PRINTF("Label \'%s\' is not unique:", label);
+		for (unsigned int i = 0; i < index.num_entries; i++) {
+			if (strcmp(index.entries[i].label, label) == 0)
+				fprintf(stderr, " %s.%u", index.entries[i].type,
+					index.entries[i].id);
+		}
+		fputc('\n', stderr);
+		error = -EINVAL;
+	} else {
+		snprintf(name, size, "%s.%u", found->type, found->id);
+		DEBUG_PRINTF("label %s resolved to %s\n", label, name);
+	}
+
+	obj_index_free(&index);
+	return error;
+}
+
+void obj_index_invalidate(void)
+{
+	char path[PATH_MAX];
+
+	if (get_index_path(path, sizeof(path)) < 0)
+		return;
+
+	if (unlink(path) < 0 && errno != ENOENT)
+		DEBUG_PRINTF("could not remove the object index %s\n", path);
+}
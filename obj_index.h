@@ -0,0 +1,120 @@
+/* Copyright 2026 NXP
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * * Neither the name of the above-listed copyright holders nor the
+ * names of any contributors may be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ *
+ * ALTERNATIVELY, this software may be distributed under the terms of the
+ * GNU General Public License ("GPL") as published by the Free Software
+ * Foundation, either version 2 of that License or (at your option) any
+ * later version.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _OBJ_INDEX_H
+#define _OBJ_INDEX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* parent_id of the root container, whose parent is not visible */
+#define OBJ_INDEX_NO_PARENT	UINT32_MAX
+
+struct obj_index_entry {
+	char type[16];
+	uint32_t id;
+	/* container the object is in */
+	uint32_t parent_id;
+	/* number of objects in the container, -1 for non-containers */
+	int obj_count;
+	char label[16];
+};
+
+/**
+ * Names, labels and containers of all the objects visible from the root
+ * container, kept on disk so that shell completion and name lookups do
+ * not have to walk the container tree on every invocation
+ */
+struct obj_index {
+	uint32_t root_dprc_id;
+	unsigned int num_entries;
+	unsigned int max_entries;
+	struct obj_index_entry *entries;
+};
+
+/* read the index from disk, without talking to the MC */
+int obj_index_load(struct obj_index *index);
+
+/* walk the container tree from the root container */
+int obj_index_build(struct obj_index *index);
+
+int obj_index_save(const struct obj_index *index);
+
+/**
+ * Check the object count of each indexed container against the MC, which
+ * is much cheaper than rebuilding the index
+ */
+bool obj_index_is_current(const struct obj_index *index);
+
+/**
+ * Get an up to date index: the one on disk if it is still current, else
+ * a newly built (and saved) one. If the MC cannot be reached, the index
+ * on disk is returned as is.
+ */
+int obj_index_get(struct obj_index *index);
+
+/**
+ * Same as obj_index_get(), except that an index built or checked a few
+ * seconds ago is returned without talking to the MC. Meant for shell
+ * completion, which runs on every TAB press.
+ */
+int obj_index_get_recent(struct obj_index *index);
+
+/* the entry of object <type>.<id>, or NULL if not in the index */
+const struct obj_index_entry *obj_index_find(const struct obj_index *index,
+					     const char *type, uint32_t id);
+
+/* whether the object is in container 'dprc_id' or in one of its children */
+bool obj_index_in_container(const struct obj_index *index,
+			    const struct obj_index_entry *entry,
+			    uint32_t dprc_id);
+
+/* object names given as label:<label> are looked up in the index */
+#define OBJ_LABEL_PREFIX	"label:"
+
+/**
+ * Resolve 'label' to the name (<type>.<id>) of the one object having it.
+ * The object found in the index is checked against the MC, the index
+ * being rebuilt if it turns out to be stale.
+ */
+int obj_index_resolve_label(const char *label, char *name, size_t size);
+
+/**
+ * Drop the index on disk after a command changed the objects. It is
+ * rebuilt by the next command which needs it.
+ */
+void obj_index_invalidate(void);
+
+void obj_index_free(struct obj_index *index);
+
+#endif /* _OBJ_INDEX_H */
@@ -38,9 +38,14 @@
 #include <errno.h>
 #include <assert.h>
 #include <getopt.h>
+#include <fcntl.h>
 #include <sys/ioctl.h>
 #include "restool.h"
 #include "utils.h"
+#include "mc_sched.h"
+#include "mc_trace.h"
+#include "librestool.h"
+#include "obj_index.h"
 
 static struct option global_options[] = {
 	[GLOBAL_OPT_HELP] = {
@@ -79,6 +84,30 @@ static struct option global_options[] = {
 		.val = 'e',
 	},
 
+	[GLOBAL_OPT_JOBS] = {
+		.name = "jobs",
+		.val = 'j',
+		.has_arg = required_argument,
+	},
+
+	[GLOBAL_OPT_MAX_IN_FLIGHT] = {
+		.name = "max-in-flight",
+		.val = 'f',
+		.has_arg = required_argument,
+	},
+
+	[GLOBAL_OPT_HIGH_PRIORITY] = {
+		.name = "high-priority",
+		.val = 'p',
+		.has_arg = required_argument,
+	},
+
+	[GLOBAL_OPT_TRACE] = {
+		.name = "trace",
+		.val = 't',
+		.has_arg = optional_argument,
+	},
+
 	{ 0 },
 };
 
@@ -295,63 +324,6 @@ struct lut_entry version_lut[] = {
 
 struct restool restool;
 
-enum mc_cmd_status flib_error_to_mc_status(int error)
-{
-	switch (error) {
-	case 0:
-		return MC_CMD_STATUS_OK;
-	case -EACCES:
-		return MC_CMD_STATUS_AUTH_ERR;
-	case -EPERM:
-		return MC_CMD_STATUS_NO_PRIVILEGE;
-	case -EIO:
-		return MC_CMD_STATUS_DMA_ERR;
-	case -ENXIO:
-		return MC_CMD_STATUS_CONFIG_ERR;
-	case -ETIMEDOUT:
-		return MC_CMD_STATUS_TIMEOUT;
-	case -ENAVAIL:
-		return MC_CMD_STATUS_NO_RESOURCE;
-	case -ENOMEM:
-		return MC_CMD_STATUS_NO_MEMORY;
-	case -EBUSY:
-		return MC_CMD_STATUS_BUSY;
-	case -524:
-		/* #define ENOTSUPP 524 in Linux, no ENOTSUPP in user space */
-		return MC_CMD_STATUS_UNSUPPORTED_OP;
-	case -ENODEV:
-		return MC_CMD_STATUS_INVALID_STATE;
-	default:
-		break;
-	}
-
-	/* Not expected to reach here */
-	return error;	/* 1000 == 0x3e8 */
-}
-
-const char *mc_status_to_string(enum mc_cmd_status status)
-{
-	static const char *const status_strings[] = {
-		[MC_CMD_STATUS_OK] = "Command completed successfully",
-		[MC_CMD_STATUS_READY] = "Command ready to be processed",
-		[MC_CMD_STATUS_AUTH_ERR] = "Authentication error",
-		[MC_CMD_STATUS_NO_PRIVILEGE] = "No privilege",
-		[MC_CMD_STATUS_DMA_ERR] = "DMA or I/O error",
-		[MC_CMD_STATUS_CONFIG_ERR] = "Configuration error",
-		[MC_CMD_STATUS_TIMEOUT] = "Operation timed out",
-		[MC_CMD_STATUS_NO_RESOURCE] = "No resources",
-		[MC_CMD_STATUS_NO_MEMORY] = "No memory available",
-		[MC_CMD_STATUS_BUSY] = "Device is busy",
-		[MC_CMD_STATUS_UNSUPPORTED_OP] = "Unsupported operation",
-		[MC_CMD_STATUS_INVALID_STATE] = "Invalid state"
-	};
-
-	if ((unsigned int)status >= ARRAY_SIZE(status_strings))
-		return "Unknown MC error";
-
-	return status_strings[status];
-}
-
 int find_target_obj_desc(uint32_t dprc_id, uint16_t dprc_handle,
 			int nesting_level,
 			uint32_t target_id, char *target_type,
@@ -614,8 +586,79 @@ bool in_use(const char *obj, const char *situation)
 	return false;
 }
 
+static int write_rescan_attr(const char *path)
+{
+	ssize_t n;
+	int error = 0;
+	int fd;
+
+	fd = open(path, O_WRONLY);
+	if (fd < 0)
+		return -errno;
+
+	n = write(fd, "1", 1);
+	if (n != 1)
+		error = n < 0 ? -errno : -EIO;
+
+	(void)close(fd);
+	return error;
+}
+
+/**
+ * Record that the objects of container 'dprc_id' need to be rescanned.
+ * Requests are coalesced: a single container is rescanned on its own,
+ * requests for different containers turn into one rescan of the whole bus.
+ */
+void request_rescan(uint32_t dprc_id)
+{
+	if (restool.rescan_pending && restool.rescan_dprc_id != dprc_id)
+		dprc_id = RESCAN_ALL_CONTAINERS;
+
+	restool.rescan_dprc_id = dprc_id;
+	restool.rescan_pending = true;
+}
+
+/**
+ * Issue the rescan recorded by request_rescan(), if any
+ */
+int flush_rescan(void)
+{
+	char path[PATH_MAX];
+	int error;
+
+	if (!restool.rescan_pending)
+		return 0;
+
+	restool.rescan_pending = false;
+	if (restool.rescan_dprc_id != RESCAN_ALL_CONTAINERS) {
+		snprintf(path, sizeof(path), FSL_MC_DPRC_RESCAN_FMT,
+			 restool.rescan_dprc_id);
+		error = write_rescan_attr(path);
+		DEBUG_PRINTF("rescan of dprc.%u returned %d\n",
+			     restool.rescan_dprc_id, error);
+		if (error == 0)
+			return 0;
+		/* fall back to the bus attribute on older fsl-mc bus drivers */
+	}
+
+	error = write_rescan_attr(FSL_MC_BUS_RESCAN);
+	if (error < 0)
+		ERROR_PRINTF("fsl-mc bus rescan failed: %s\n", strerror(-error));
+
+	return error;
+}
+
 void print_new_obj(char *type, int id, const char *parent)
 {
+	uint32_t parent_id = restool.root_dprc_id;
+
+	/* a new object only changes its parent container */
+	if (restool.rescan) {
+		if (parent != NULL && sscanf(parent, "dprc.%u", &parent_id) != 1)
+			parent_id = RESCAN_ALL_CONTAINERS;
+		request_rescan(parent_id);
+	}
+
 	if (restool.script) {
 		printf("%s.%d\n", type, id);
 		return;
@@ -698,6 +741,7 @@ static void print_usage(void)
 		"SYNOPSIS\n"
 		"\n"
 		"  restool [<global-opts>] <object-type> <command> <object-name> [ARGS...]\n"
+		"  restool [<global-opts>] <command> [ARGS...]\n"
 		"\n"
 		"OPTIONS\n"
 		"\n"
@@ -707,7 +751,17 @@ static void print_usage(void)
 		"   -h,-?,--help     Displays general help info\n"
 		"   -s, --script     Display script friendly output\n"
 		"   --rescan         Issues a rescan of fsl-mc bus before exiting\n"
+		"                    (only of the affected container when known)\n"
 		"   --root=[dprc]    Specifies root container name\n"
+		"   --jobs=<n>       Use up to <n> MC portals for bulk operations\n"
+		"   --max-in-flight=<n>\n"
+		"                    Run at most <n> MC operations at the same time\n"
+		"   --high-priority=<families>\n"
+		"                    Send these comma separated command families in the\n"
+		"                    MC high priority lane: link, connection, counters\n"
+		"                    (default), or none\n"
+		"   --trace[=<file>] Log every MC command and its response to <file>\n"
+		"                    or to stderr\n"
 		"\n"
 		"  Valid <object-type> values: <dprc|dpni|dpio|dpsw|dpbp|dpci|dpcon|dpseci|dpdmux|\n"
 		"                               dpmcp|dpmac|dpdcei|dpaiop|dpdmai>\n"
@@ -719,7 +773,16 @@ static void print_usage(void)
 		"    create\n"
 		"    destroy\n"
 		"\n"
-		"  <object-name> is a string containing object type and ID (e.g. dpni.7)\n"
+		"  <object-name> is a string containing object type and ID (e.g. dpni.7),\n"
+		"  or label:<label> to name the object having this label\n"
+		"\n"
+		"  Commands not bound to an object type:\n"
+		"    complete    Prints the object names starting with a prefix\n"
+		"    plan        Checks that the objects of a batch file or DPL fit\n"
+		"                in the free resources of a container\n"
+		"    plan-cpus   Lays out a DPIO and a DPCON per core, by CPU cluster\n"
+		"    link        'link monitor' polls the links of the DPNIs, DPCIs\n"
+		"                and DPMACs and reports their transitions and flaps\n"
 		"\n";
 
 	puts(usage_msg);
@@ -743,6 +806,7 @@ static void print_usage_v9(void)
 		"SYNOPSIS\n"
 		"\n"
 		"  restool [<global-opts>] <object-type> <command> <object-name> [ARGS...]\n"
+		"  restool [<global-opts>] <command> [ARGS...]\n"
 		"\n"
 		"OPTIONS\n"
 		"\n"
@@ -752,7 +816,17 @@ static void print_usage_v9(void)
 		"   -h,-?,--help     Displays general help info\n"
 		"   -s, --script     Display script friendly output\n"
 		"   --rescan         Issues a rescan of fsl-mc bus before exiting\n"
+		"                    (only of the affected container when known)\n"
 		"   --root=[dprc]    Specifies root container name\n"
+		"   --jobs=<n>       Use up to <n> MC portals for bulk operations\n"
+		"   --max-in-flight=<n>\n"
+		"                    Run at most <n> MC operations at the same time\n"
+		"   --high-priority=<families>\n"
+		"                    Send these comma separated command families in the\n"
+		"                    MC high priority lane: link, connection, counters\n"
+		"                    (default), or none\n"
+		"   --trace[=<file>] Log every MC command and its response to <file>\n"
+		"                    or to stderr\n"
 		"\n"
 		"  Valid <object-type> values: <dprc|dpni|dpio|dpsw|dpbp|dpci|dpcon|dpseci|dpdmux|\n"
 		"                               dpmcp|dpmac|dpdcei|dpaiop|dprtc|dpdmai>\n"
@@ -764,7 +838,16 @@ static void print_usage_v9(void)
 		"    create\n"
 		"    destroy\n"
 		"\n"
-		"  <object-name> is a string containing object type and ID (e.g. dpni.7)\n"
+		"  <object-name> is a string containing object type and ID (e.g. dpni.7),\n"
+		"  or label:<label> to name the object having this label\n"
+		"\n"
+		"  Commands not bound to an object type:\n"
+		"    complete    Prints the object names starting with a prefix\n"
+		"    plan        Checks that the objects of a batch file or DPL fit\n"
+		"                in the free resources of a container\n"
+		"    plan-cpus   Lays out a DPIO and a DPCON per core, by CPU cluster\n"
+		"    link        'link monitor' polls the links of the DPNIs, DPCIs\n"
+		"                and DPMACs and reports their transitions and flaps\n"
 		"\n";
 
 	puts(usage_msg);
@@ -862,6 +945,78 @@ static int check_arg(char *optarg)
 	return str_len;
 }
 
+static int parse_count_arg(const char *arg, const char *opt_name,
+			   long min, long max, unsigned int *value)
+{
+	char *endptr;
+	long val;
+
+	errno = 0;
+	val = strtol(arg, &endptr, 0);
+	if (STRTOL_ERROR(arg, endptr, val, errno) || val < min || val > max) {
+		ERROR_PRINTF("Invalid Argument: %s must be between %ld and %ld\n",
+			     opt_name, min, max);
+		return -EINVAL;
+	}
+
+	*value = val;
+	return 0;
+}
+
+static const char *const mc_cmd_family_names[] = {
+	[MC_CMD_FAMILY_LINK_STATE] = "link",
+	[MC_CMD_FAMILY_CONNECTION] = "connection",
+	[MC_CMD_FAMILY_COUNTERS] = "counters",
+};
+
+C_ASSERT(ARRAY_SIZE(mc_cmd_family_names) == MC_CMD_FAMILY_NUM);
+
+/**
+ * Parse a comma separated list of command families, or "none"
+ */
+static int parse_cmd_families(const char *arg, uint32_t *families)
+{
+	char list[64];
+	char *name, *saveptr;
+	unsigned int i;
+
+	if (strlen(arg) >= sizeof(list))
+		goto err;
+
+	*families = 0;
+	if (strcmp(arg, "none") == 0)
+		return 0;
+
+	strcpy(list, arg);
+	for (name = strtok_r(list, ",", &saveptr); name != NULL;
+	     name = strtok_r(NULL, ",", &saveptr)) {
+		for (i = 0; i < ARRAY_SIZE(mc_cmd_family_names); i++)
+			if (strcmp(name, mc_cmd_family_names[i]) == 0)
+				break;
+		if (i == ARRAY_SIZE(mc_cmd_family_names))
+			goto err;
+
+		*families |= ONE_BIT_MASK(i);
+	}
+
+	return 0;
+err:
+	ERROR_PRINTF("Invalid Argument: high-priority must be \"none\" or a comma separated list of: link, connection, counters\n");
+	return -EINVAL;
+}
+
+uint32_t mc_cmd_lane_flags(enum mc_cmd_family family)
+{
+	if (!(restool.high_prio_families & ONE_BIT_MASK(family)))
+		return 0;
+
+	/* the v9 flib encodes the command flags differently */
+	if (restool.mc_fw_version.major == MC_FW_VERSION_9)
+		return PRI_V9;
+
+	return PRI;
+}
+
 static int parse_global_options(int argc, char *argv[],
 				int *next_argv_index)
 {
@@ -931,6 +1086,27 @@ static int parse_global_options(int argc, char *argv[],
 		case 'e':
 			opt_index = GLOBAL_OPT_RESCAN;
 			break;
+		case 'j':
+			opt_index = GLOBAL_OPT_JOBS;
+			if (parse_count_arg(optarg, "jobs", 1, MC_SCHED_MAX_WORKERS,
+					    &restool.num_jobs) < 0)
+				return -EINVAL;
+			break;
+		case 'f':
+			opt_index = GLOBAL_OPT_MAX_IN_FLIGHT;
+			if (parse_count_arg(optarg, "max-in-flight", 1, UINT16_MAX,
+					    &restool.max_in_flight) < 0)
+				return -EINVAL;
+			break;
+		case 't':
+			opt_index = GLOBAL_OPT_TRACE;
+			break;
+		case 'p':
+			opt_index = GLOBAL_OPT_HIGH_PRIORITY;
+			if (parse_cmd_families(optarg,
+					       &restool.high_prio_families) < 0)
+				return -EINVAL;
+			break;
 		default:
 			DEBUG_PRINTF("\n");
 			assert(false);
@@ -1118,25 +1294,99 @@ out:
 	return obj_cmd;
 }
 
-static int parse_obj_command(const char *obj_type,
-			     const char *cmd_name,
-			     int argc,
-			     char *argv[])
+static struct object_command *get_toplevel_cmd(const char *cmd_name)
+{
+	for (struct object_command *cmd = toplevel_commands;
+	     cmd->cmd_name != NULL; cmd++) {
+		if (strcmp(cmd->cmd_name, cmd_name) == 0)
+			return cmd;
+	}
+
+	return NULL;
+}
+
+/* commands after which the object name index is out of date */
+static bool is_index_mutating_cmd(const char *cmd_name)
+{
+	static const char *const mutating_cmds[] = {
+		"create", "destroy", "assign", "unassign", "set-label",
+		"connect", "disconnect",
+	};
+
+	for (unsigned int i = 0; i < ARRAY_SIZE(mutating_cmds); i++) {
+		if (strcmp(mutating_cmds[i], cmd_name) == 0)
+			return true;
+	}
+
+	return false;
+}
+
+/**
+ * Replace the object name and the option arguments given as
+ * label:<label> with the name of the object having this label
+ */
+static int resolve_obj_labels(const struct option *options)
+{
+	static char obj_name[OBJ_TYPE_MAX_LENGTH + 16];
+	static char option_names[MAX_NUM_CMD_LINE_OPTIONS][
+						OBJ_TYPE_MAX_LENGTH + 16];
+	const size_t prefix_len = strlen(OBJ_LABEL_PREFIX);
+	int error;
+
+	/* <option>_OPT_HELP is always 0 */
+	if (restool.cmd_option_mask & ONE_BIT_MASK(0))
+		return 0;
+
+	if (restool.obj_name != NULL &&
+	    strncmp(restool.obj_name, OBJ_LABEL_PREFIX, prefix_len) == 0) {
+		error = obj_index_resolve_label(restool.obj_name + prefix_len,
+						obj_name, sizeof(obj_name));
+		if (error < 0)
+			return error;
+
+		restool.obj_name = obj_name;
+	}
+
+	if (options == NULL)
+		return 0;
+
+	for (int i = 0; options[i].name != NULL; i++) {
+		char *arg = restool.cmd_option_args[i];
+
+		/* --label=<label> is the label itself, not an object */
+		if (!(restool.cmd_option_mask & ONE_BIT_MASK(i)) ||
+		    arg == NULL || strcmp(options[i].name, "label") == 0 ||
+		    strncmp(arg, OBJ_LABEL_PREFIX, prefix_len) != 0)
+			continue;
+
+		error = obj_index_resolve_label(arg + prefix_len,
+						option_names[i],
+						sizeof(option_names[i]));
+		if (error < 0)
+			return error;
+
+		restool.cmd_option_args[i] = option_names[i];
+	}
+
+	return 0;
+}
+
+/**
+ * Parse the options of an object-level or a top-level command and run it.
+ * argv[0] is the command name, optionally followed by the object name.
+ */
+static int run_obj_command(struct object_command *obj_cmd,
+			   int argc,
+			   char *argv[],
+			   bool resolve_labels)
 {
 	int error;
 	int next_argv_index;
-	struct object_command *obj_cmd = NULL;
 	struct timespec start_time = { 0 };
 	struct timespec end_time = { 0 };
 	struct timespec latency = { 0 };
 
-	assert(argv[0] == cmd_name);
-	obj_cmd = get_obj_cmd(obj_type, cmd_name);
 	restool.obj_cmd = obj_cmd;
-	if (restool.obj_cmd == NULL) {
-		error = -EINVAL;
-		goto out;
-	}
 	if (argc >= 2 && argv[1][0] != '-') {
 		restool.obj_name = argv[1];
 		argv++;
@@ -1171,6 +1421,12 @@ static int parse_obj_command(const char *obj_type,
 		}
 	}
 
+	if (resolve_labels) {
+		error = resolve_obj_labels(obj_cmd->options);
+		if (error < 0)
+			goto out;
+	}
+
 	/*
 	 * Execute object-level command:
 	 */
@@ -1194,6 +1450,23 @@ out:
 	return error;
 }
 
+static int parse_obj_command(const char *obj_type,
+			     const char *cmd_name,
+			     int argc,
+			     char *argv[])
+{
+	struct object_command *obj_cmd;
+
+	assert(argv[0] == cmd_name);
+	obj_cmd = get_obj_cmd(obj_type, cmd_name);
+	if (obj_cmd == NULL) {
+		restool.obj_cmd = NULL;
+		return -EINVAL;
+	}
+
+	return run_obj_command(obj_cmd, argc, argv, true);
+}
+
 static int get_device_file(void)
 {
 	int num_dev_files = 0;
@@ -1321,39 +1594,46 @@ static int get_endianness(void)
 	return BIG_ENDIAN;
 }
 
-int main(int argc, char *argv[])
+static bool mc_session_opened;
+static bool root_dprc_opened;
+
+/**
+ * Set up the MC session: find the device file, open the MC portal and
+ * read the MC firmware version. Only done for the commands which need
+ * the MC, so that the offline ones (help, version) work without it.
+ */
+static int open_mc_session(void)
 {
-	int error;
-	int next_argv_index;
-	const char *obj_type;
-	const char *cmd_name;
-	bool mc_io_initialized = false;
-	bool root_dprc_opened = false;
 	static enum mc_cmd_status mc_status;
-	bool talk_to_mc = true;
-
-	#ifdef DEBUG
-	restool.debug = true;
-	#endif
-
-	memset(restool.specified_dev_file, '\0', USR_DEV_FILE_SIZE);
-
-	error = parse_global_options(argc, argv, &next_argv_index);
-	if (error < 0)
-		goto out;
+	int error;
 
 	error = get_device_file();
 	if (error < 0)
 		goto out;
 
 	DEBUG_PRINTF("restool built on " __DATE__ " " __TIME__ "\n");
-	error = mc_io_init(&restool.mc_io);
-	if (error != 0)
+	error = mc_io_init(&restool.mc_io, restool.device_file);
+	if (error != 0) {
+		ERROR_PRINTF("open(%s) failed: %s\n", restool.device_file,
+			     strerror(-error));
 		goto out;
+	}
 
-	mc_io_initialized = true;
+	mc_session_opened = true;
+	restool.mc_io.debug = restool.debug;
 	DEBUG_PRINTF("restool.mc_io.fd: %d\n", restool.mc_io.fd);
 
+	if (restool.global_option_mask & ONE_BIT_MASK(GLOBAL_OPT_TRACE)) {
+		error = mc_trace_start(&restool.mc_io,
+			restool.global_option_args[GLOBAL_OPT_TRACE]);
+		if (error < 0) {
+			ERROR_PRINTF("cannot open trace file %s: %s\n",
+				     restool.global_option_args[GLOBAL_OPT_TRACE],
+				     strerror(-error));
+			goto out;
+		}
+	}
+
 	error = mc_get_version(&restool.mc_io, 0,
 				&restool.mc_fw_version);
 	if (error != 0) {
@@ -1367,6 +1647,7 @@ int main(int argc, char *argv[])
 		ERROR_PRINTF("This version of restool does no longer support MC\
 			     firmware versions lower than v9. \
 			     Please use restool v1.5\n");
+		error = -ENOTSUP;
 		goto out;
 	}
 
@@ -1382,6 +1663,110 @@ int main(int argc, char *argv[])
 		     restool.mc_fw_version.minor,
 		     restool.mc_fw_version.revision);
 
+out:
+	return error;
+}
+
+/**
+ * Open the MC session and the root container, unless already done.
+ * Commands which only need the MC in some cases (e.g. to revalidate a
+ * cache) call this themselves.
+ */
+int ensure_mc_session(void)
+{
+	static int session_error;
+	int error;
+
+	if (session_error < 0)
+		return session_error;
+
+	if (root_dprc_opened)
+		return 0;
+
+	if (!mc_session_opened) {
+		error = open_mc_session();
+		if (error < 0)
+			goto out;
+	}
+
+	error = open_root_container();
+	if (error < 0)
+		goto out;
+
+	DEBUG_PRINTF("newly opened restool's root_dprc_handle: %#x\n",
+		     restool.root_dprc_handle);
+	root_dprc_opened = true;
+
+	error = restool_ctx_attach(&restool.ctx, &restool.mc_io,
+				   &restool.mc_fw_version,
+				   restool.root_dprc_id,
+				   restool.root_dprc_handle);
+	if (error < 0)
+		ERROR_PRINTF("MC firmware %u.%u.%u is not supported\n",
+			     restool.mc_fw_version.major,
+			     restool.mc_fw_version.minor,
+			     restool.mc_fw_version.revision);
+out:
+	session_error = error;
+	return error;
+}
+
+static int close_mc_session(void)
+{
+	static enum mc_cmd_status mc_status;
+	int error = 0;
+
+	restool_ctx_close(restool.ctx);
+	restool.ctx = NULL;
+
+	if (root_dprc_opened) {
+		error = dprc_close(&restool.mc_io, 0,
+				   restool.root_dprc_handle);
+		if (error < 0) {
+			mc_status = flib_error_to_mc_status(error);
+			ERROR_PRINTF("MC error: %s (status %#x)\n",
+				mc_status_to_string(mc_status), mc_status);
+		}
+		root_dprc_opened = false;
+	}
+
+	if (mc_session_opened) {
+		mc_trace_stop(&restool.mc_io);
+		mc_io_cleanup(&restool.mc_io);
+		mc_session_opened = false;
+	}
+
+	return error;
+}
+
+int main(int argc, char *argv[])
+{
+	int error;
+	int next_argv_index;
+	const char *obj_type;
+	const char *cmd_name;
+	struct object_command *obj_cmd;
+	int error2;
+	bool talk_to_mc = true;
+
+	#ifdef DEBUG
+	restool.debug = true;
+	#endif
+
+	memset(restool.specified_dev_file, '\0', USR_DEV_FILE_SIZE);
+	restool.high_prio_families = MC_CMD_FAMILIES_HIGH_PRIO_DEFAULT;
+
+	error = parse_global_options(argc, argv, &next_argv_index);
+	if (error < 0)
+		goto out;
+
+	/* only global options: nothing to do with a container */
+	if (next_argv_index == argc)
+		talk_to_mc = false;
+	/* top-level commands open the MC session only if they need it */
+	else if (get_toplevel_cmd(argv[next_argv_index]) != NULL)
+		talk_to_mc = false;
+
 	for (int i = 0; i < argc; i++) {
 		if (strcmp(argv[i], "-v") == 0 ||
 			strcmp(argv[i], "--version") == 0 ||
@@ -1397,20 +1782,23 @@ int main(int argc, char *argv[])
 
 	DEBUG_PRINTF("talk_to_mc = %d\n", talk_to_mc);
 	if (talk_to_mc) {
-
-		error = open_root_container();
-
+		error = ensure_mc_session();
 		if (error < 0)
 			goto out;
-
-		DEBUG_PRINTF("newly opened restool's root_dprc_handle: %#x\n",
-			     restool.root_dprc_handle);
-		root_dprc_opened = true;
+	} else if (restool.global_option_mask &
+		   ONE_BIT_MASK(GLOBAL_OPT_MC_VERSION)) {
+		error = open_mc_session();
+		if (error < 0)
+			goto out;
+	} else {
+		/*
+		 * Offline command: nothing is sent to the MC, show the help
+		 * of the latest MC firmware version supported
+		 */
+		DEBUG_PRINTF("offline, no MC session\n");
+		restool.mc_fw_version.major = MC_FW_VERSION_10;
 	}
 
-	if (error < 0)
-		goto out;
-
 	if (next_argv_index == argc) {
 		if (restool.global_option_mask == 0) {
 			ERROR_PRINTF("Incomplete command line\n");
@@ -1467,6 +1855,7 @@ int main(int argc, char *argv[])
 			restool.global_option_mask &=
 				~ONE_BIT_MASK(GLOBAL_OPT_DEBUG);
 			restool.debug = true;
+			restool.mc_io.debug = true;
 		}
 
 		if (restool.global_option_mask &
@@ -1489,6 +1878,12 @@ int main(int argc, char *argv[])
 			restool.rescan = true;
 		}
 
+		restool.global_option_mask &=
+			~(ONE_BIT_MASK(GLOBAL_OPT_JOBS) |
+			  ONE_BIT_MASK(GLOBAL_OPT_MAX_IN_FLIGHT) |
+			  ONE_BIT_MASK(GLOBAL_OPT_HIGH_PRIORITY) |
+			  ONE_BIT_MASK(GLOBAL_OPT_TRACE));
+
 		int num_remaining_args;
 
 		assert(next_argv_index < argc);
@@ -1502,6 +1897,16 @@ int main(int argc, char *argv[])
 		}
 
 		num_remaining_args = argc - next_argv_index;
+		obj_cmd = get_toplevel_cmd(argv[next_argv_index]);
+		if (obj_cmd != NULL) {
+			error = run_obj_command(obj_cmd, num_remaining_args,
+						&argv[next_argv_index], false);
+			if (error < 0)
+				goto out;
+
+			goto rescan;
+		}
+
 		if (num_remaining_args < 2) {
 			ERROR_PRINTF("Incomplete command line\n");
 			print_try_help();
@@ -1517,34 +1922,23 @@ int main(int argc, char *argv[])
 					  &argv[next_argv_index + 1]);
 		if (error < 0)
 			goto out;
-	}
 
-	if (restool.rescan) {
-		error = system("echo 1 > /sys/bus/fsl-mc/rescan");
-		if (error == -1) {
-			error = -errno;
-			DEBUG_PRINTF(
-				"fsl-mc bus rescan failed (error %d)\n", error);
-			goto out;
-		}
+		if (is_index_mutating_cmd(cmd_name))
+			obj_index_invalidate();
 	}
 
-out:
-	if (root_dprc_opened) {
-		int error2;
+rescan:
+	if (restool.rescan && !restool.rescan_pending)
+		request_rescan(RESCAN_ALL_CONTAINERS);
 
-		error2 = dprc_close(&restool.mc_io, 0,
-					restool.root_dprc_handle);
-		if (error2 < 0) {
-			mc_status = flib_error_to_mc_status(error2);
-			ERROR_PRINTF("MC error: %s (status %#x)\n",
-				mc_status_to_string(mc_status), mc_status);
-			if (error == 0)
-				error = error2;
-		}
-	}
-	if (mc_io_initialized)
-		mc_io_cleanup(&restool.mc_io);
+	error = flush_rescan();
+	if (error < 0)
+		goto out;
+
+out:
+	error2 = close_mc_session();
+	if (error == 0)
+		error = error2;
 
 	return error;
 }
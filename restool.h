@@ -104,7 +104,29 @@
  * original definition is too long
  * to be an appropriate pass-in parameter for each flib API
  */
-#define PRINTR (MC_CMD_FLAG_PRI | INTR MC_CMD_FLAG_INTR_DIS)
+#define PRINTR (MC_CMD_FLAG_PRI | MC_CMD_FLAG_INTR_DIS)
+
+/**
+ * MC command high priority flag as encoded by the MC v9 flib
+ */
+#define PRI_V9 0x00008000
+
+/**
+ * Families of latency-critical MC queries which can be sent in the
+ * high priority lane (MC_CMD_FLAG_PRI). Bulk operations such as
+ * create/destroy and DPL generation always use the normal lane.
+ */
+enum mc_cmd_family {
+	MC_CMD_FAMILY_LINK_STATE = 0,
+	MC_CMD_FAMILY_CONNECTION,
+	MC_CMD_FAMILY_COUNTERS,
+	MC_CMD_FAMILY_NUM,
+};
+
+#define MC_CMD_FAMILIES_HIGH_PRIO_DEFAULT (		\
+	ONE_BIT_MASK(MC_CMD_FAMILY_LINK_STATE) |	\
+	ONE_BIT_MASK(MC_CMD_FAMILY_CONNECTION) |	\
+	ONE_BIT_MASK(MC_CMD_FAMILY_COUNTERS))
 
 /*
  * TODO: Obtain the following constants from the fsl-mc bus driver via an ioctl
@@ -117,7 +139,19 @@
 #define MC_PORTAL_OFFSET_TO_PORTAL_ID(_portal_offset) \
 	((_portal_offset) / MC_PORTAL_STRIDE)
 
+/**
+ * fsl-mc bus sysfs attributes used to resynchronize the bus with the MC
+ */
+#define FSL_MC_BUS_RESCAN	"/sys/bus/fsl-mc/rescan"
+#define FSL_MC_DPRC_RESCAN_FMT	"/sys/bus/fsl-mc/devices/dprc.%u/rescan"
+
+/**
+ * Pseudo container id requesting a rescan of the entire fsl-mc bus
+ */
+#define RESCAN_ALL_CONTAINERS	UINT32_MAX
+
 struct restool;
+struct restool_ctx;
 
 typedef int restool_cmd_func_t(void);
 
@@ -243,6 +277,12 @@ struct restool {
 	 */
 	struct mc_version mc_fw_version;
 
+	/**
+	 * librestool context attached to the MC session, which the
+	 * container, label and connection commands go through
+	 */
+	struct restool_ctx *ctx;
+
 	/**
 	 * Id for the root DPRC in the system
 	 */
@@ -272,6 +312,35 @@ struct restool {
 	 */
 	bool rescan;
 
+	/**
+	 * a rescan was requested while running the command; it is
+	 * deferred and issued only once, before exiting
+	 */
+	bool rescan_pending;
+
+	/**
+	 * scope of the pending rescan: the id of the only container
+	 * affected so far or RESCAN_ALL_CONTAINERS
+	 */
+	uint32_t rescan_dprc_id;
+
+	/**
+	 * number of MC portals bulk operations may use concurrently
+	 */
+	unsigned int num_jobs;
+
+	/**
+	 * maximum number of MC operations of a bulk operation in flight at
+	 * the same time, 0 for no limit beyond the number of jobs
+	 */
+	unsigned int max_in_flight;
+
+	/**
+	 * bit mask of the enum mc_cmd_family families sent in the high
+	 * priority lane
+	 */
+	uint32_t high_prio_families;
+
 	/**
 	 * device file used by restool
 	 */
@@ -295,6 +364,10 @@ enum global_options {
 	GLOBAL_OPT_SCRIPT,
 	GLOBAL_OPT_ROOT,
 	GLOBAL_OPT_RESCAN,
+	GLOBAL_OPT_JOBS,
+	GLOBAL_OPT_MAX_IN_FLIGHT,
+	GLOBAL_OPT_HIGH_PRIORITY,
+	GLOBAL_OPT_TRACE,
 };
 
 /* object option map entry */
@@ -398,6 +471,64 @@ bool in_use(const char *obj, const char *situation);
 int get_parent_dprc_id(uint32_t obj_id, char *obj_type,
 		       uint32_t *parent_dprc_id);
 
+/* MC command flags of the lane the given family of commands is sent in */
+uint32_t mc_cmd_lane_flags(enum mc_cmd_family family);
+
+/**
+ * Lane flags of each command family, shortened to be passed in to the
+ * flib APIs like PRI and INTR
+ */
+#define LINK_LANE mc_cmd_lane_flags(MC_CMD_FAMILY_LINK_STATE)
+#define CONN_LANE mc_cmd_lane_flags(MC_CMD_FAMILY_CONNECTION)
+#define CNT_LANE mc_cmd_lane_flags(MC_CMD_FAMILY_COUNTERS)
+
+/* functions used to keep the fsl-mc bus in sync with the MC */
+void request_rescan(uint32_t dprc_id);
+
+int flush_rescan(void);
+
+/* open the MC session and the root container if not already done */
+int ensure_mc_session(void);
+
+/*
+ * librestool context sharing the MC portal and the root container handle
+ * of a session, which stay owned by the session; restool_ctx_close()
+ * only closes the containers the context opened itself
+ */
+int restool_ctx_attach(struct restool_ctx **ctx,
+		       struct fsl_mc_io *mc_io,
+		       const struct mc_version *mc_fw_version,
+		       uint32_t root_dprc_id,
+		       uint16_t root_dprc_handle);
+
+/* a free block of a memory partition */
+struct mem_extent {
+	uint32_t offset;
+	uint32_t size;
+};
+
+/* free block sizes are counted in power of two classes: [2^i, 2^(i+1)) */
+#define MEM_HIST_BUCKETS	32
+
+struct mem_stats {
+	uint64_t total_free;
+	uint32_t largest_free;
+	unsigned int num_blocks;
+	/* 1 - largest / total: 0 when all the free memory is one block */
+	double frag_index;
+	unsigned int hist[MEM_HIST_BUCKETS];
+};
+
+/* functions used to read the free memory of a container */
+int read_mem_extents(uint16_t dprc_handle, uint8_t partition_id, bool dump,
+		     struct mem_extent **extents, unsigned int *num_extents);
+
+void get_mem_stats(const struct mem_extent *extents,
+		   unsigned int num_extents, struct mem_stats *stats);
+
+/* format a byte count with a binary unit, e.g. 1.5M */
+const char *mem_size_str(uint64_t size, char *buf, size_t len);
+
 extern struct restool restool;
 
 /* command maps for all MC objects */
@@ -447,4 +578,7 @@ extern struct object_command dpsw_commands_v9[];
 extern struct object_command dpsw_commands_v10[];
 extern struct object_command dpdbg_commands[];
 
+/* commands not bound to an object type: restool <command> [<arg>] */
+extern struct object_command toplevel_commands[];
+
 #endif /* _RESTOOL_H_ */
@@ -33,15 +33,24 @@
 
 restool_completion()
 {
+	# COMP_WORDS splits label:<name> at the ':' (COMP_WORDBREAKS), so
+	# split the line up to the cursor on blanks only
+	local line=${COMP_LINE:0:$COMP_POINT}
+	local words
+	read -ra words <<< "$line"
+	if [[ -z "$line" || "$line" == *[[:blank:]] ]]; then
+		words+=("")
+	fi
+
 	local dpaa2_objects=$(restool --help\
 			      | grep "Valid <object-type> values: " -A1\
-			      | grep -o dp[a-z]*)
-	local dpaa2_object=${COMP_WORDS[1]}
+			      | grep -o "dp[a-z]*")
+	local dpaa2_object=${words[1]}
 
-	case ${#COMP_WORDS[@]} in
+	case ${#words[@]} in
 		2)
 			COMPREPLY=($(compgen -W "$dpaa2_objects"\
-				     "${COMP_WORDS[1]}"))
+				     "${words[1]}"))
 			;;
 		3)
 			local commands=$(restool $dpaa2_object --help\
@@ -50,16 +59,22 @@ restool_completion()
 			if [ "$dpaa2_object" == "dpni" ]; then
 				commands+="	update"
 			fi
-			COMPREPLY=($(compgen -W "$commands" "${COMP_WORDS[2]}"))
+			COMPREPLY=($(compgen -W "$commands" "${words[2]}"))
 			;;
 		4)
-			if [[ "${COMP_WORDS[2]}" != "info" ]]; then
+			if [[ "${words[2]}" == "create" ]]; then
 				return
 			fi
-			instances=$(ls /sys/bus/fsl-mc/devices\
-				    | grep $dpaa2_object)
-			COMPREPLY=($(compgen -W "$instances"\
-				     "${COMP_WORDS[3]}"))
+			local cur=${words[3]}
+			# the partial name goes before the options
+			instances=$(restool complete "$cur"\
+				    --type=$dpaa2_object 2>/dev/null)
+			COMPREPLY=($(compgen -W "$instances" "$cur"))
+			# bash only replaces what follows the last ':'
+			if [[ "$cur" == *:* ]]; then
+				local colon_prefix=${cur%"${cur##*:}"}
+				COMPREPLY=("${COMPREPLY[@]#"$colon_prefix"}")
+			fi
 			;;
 		*)
 			return
@@ -0,0 +1,102 @@
+#!/bin/bash
+
+# Copyright 2021 NXP
+
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+# * Redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer.
+# * Redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution.
+# * Neither the name of the above-listed copyright holders nor the
+# names of any contributors may be used to endorse or promote products
+# derived from this software without specific prior written permission.
+
+
+# ALTERNATIVELY, this software may be distributed under the terms of the
+# GNU General Public License ("GPL") as published by the Free Software
+# Foundation, either version 2 of that License or (at your option) any
+# later version.
+
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+
+# Runs restool_completion against the restool built in the source tree and
+# an object index on disk, so no MC is needed:
+#	tests/restool_completion_test.sh [<restool-binary>]
+
+top_dir=$(cd "$(dirname "$0")/.." && pwd)
+restool_bin=${1:-$top_dir/restool}
+failures=0
+
+export RESTOOL_CACHE_DIR=$(mktemp -d)
+trap 'rm -rf "$RESTOOL_CACHE_DIR"' EXIT
+
+cat > "$RESTOOL_CACHE_DIR/objects-default" <<INDEX
+restool-obj-index 1 1
+dprc 1 4294967295 5
+dpni 0 1 0 eth0
+dpni 1 1 0
+dpni 12 1 0
+dpmac 3 1 0 lnk
+INDEX
+
+restool()
+{
+	"$restool_bin" "$@"
+}
+
+. "$top_dir/scripts/restool_completion.sh"
+
+# check_completion <expected> <command line>
+#
+# Splits the line the way bash does with the default COMP_WORDBREAKS, where
+# ':' is a word of its own, so label:<name> comes as three words.
+check_completion()
+{
+	local expected=$1
+
+	COMP_LINE=$2
+	COMP_POINT=${#COMP_LINE}
+	read -ra COMP_WORDS <<< "${COMP_LINE//:/ : }"
+	if [[ -z "$COMP_LINE" || "$COMP_LINE" == *[[:blank:]] ]]; then
+		COMP_WORDS+=("")
+	fi
+	COMP_CWORD=$((${#COMP_WORDS[@]} - 1))
+	COMPREPLY=()
+	restool_completion
+
+	if [ "${COMPREPLY[*]}" != "$expected" ]; then
+		echo "FAIL: $COMP_LINE<TAB>: got '${COMPREPLY[*]}'," \
+		     "expected '$expected'"
+		failures=$((failures + 1))
+	fi
+}
+
+check_completion "dpdmux dpdcei dpdmai" "restool dpd"
+check_completion "info" "restool dpni in"
+check_completion "dpni.0 label:eth0 dpni.1 dpni.12" "restool dpni info "
+check_completion "dpni.1 dpni.12" "restool dpni info dpni.1"
+check_completion "dpmac.3" "restool dpmac info dpm"
+check_completion "" "restool dpni create "
+check_completion "label:eth0" "restool dpni info lab"
+check_completion "eth0" "restool dpni info label:et"
+check_completion "eth0" "restool dpni info label:"
+check_completion "lnk" "restool dpmac info label:l"
+
+if [ $failures -ne 0 ]; then
+	echo "$failures completion test(s) failed"
+	exit 1
+fi
+
+echo "completion tests passed"
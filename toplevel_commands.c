@@ -0,0 +1,1851 @@
+/* Copyright 2026 NXP
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ * * Neither the name of the above-listed copyright holders nor the
+ * names of any contributors may be used to endorse or promote products
+ * derived from this software without specific prior written permission.
+ *
+ *
+ * ALTERNATIVELY, this software may be distributed under the terms of the
+ * GNU General Public License ("GPL") as published by the Free Software
+ * Foundation, either version 2 of that License or (at your option) any
+ * later version.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <ctype.h>
+#include <getopt.h>
+#include <math.h>
+#include <time.h>
+#include "restool.h"
+#include "utils.h"
+#include "mc_v10/fsl_dpni.h"
+#include "mc_v10/fsl_dpci.h"
+#include "mc_v10/fsl_dpcon.h"
+#include "mc_v10/fsl_dpio.h"
+#include "obj_index.h"
+
+static enum mc_cmd_status mc_status;
+
+/**
+ * The commands which send object commands only have the MC v10 encodings
+ */
+static int check_mc_v10(const char *cmd)
+{
+	if (restool.mc_fw_version.major >= MC_FW_VERSION_10)
+		return 0;
+
+	ERROR_PRINTF("restool %s needs MC firmware version 10 or later, "
+		     "found %u.%u.%u\n", cmd,
+		     restool.mc_fw_version.major,
+		     restool.mc_fw_version.minor,
+		     restool.mc_fw_version.revision);
+	return -ENOTSUP;
+}
+
+/**
+ * complete command options
+ */
+enum complete_options {
+	COMPLETE_OPT_HELP = 0,
+	COMPLETE_OPT_TYPE,
+};
+
+static struct option complete_options[] = {
+	[COMPLETE_OPT_HELP] = {
+		.name = "help",
+		.has_arg = 0,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[COMPLETE_OPT_TYPE] = {
+		.name = "type",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	{ 0 },
+};
+
+C_ASSERT(ARRAY_SIZE(complete_options) <= MAX_NUM_CMD_LINE_OPTIONS + 1);
+
+static int cmd_complete(void)
+{
+	static const char usage_msg[] =
+		"\n"
+		"Usage: restool complete [<partial-name>] [OPTIONS]\n"
+		"   Prints the names of the objects starting with\n"
+		"   <partial-name>, one per line, for shell completion.\n"
+		"   A <partial-name> starting with label: only completes\n"
+		"   labels, an empty one completes objects and labels.\n"
+		"   The names come from an index cached on disk which is\n"
+		"   only rebuilt when the objects changed.\n"
+		"\n"
+		"OPTIONS:\n"
+		"--type=<object-type>\n"
+		"   Only print objects of this type, e.g. dpni.\n"
+		"\n";
+	const char *partial = restool.obj_name ? restool.obj_name : "";
+	const size_t prefix_len = strlen(OBJ_LABEL_PREFIX);
+	const char *type = NULL;
+	struct obj_index index;
+	bool labels, objects;
+	size_t partial_len;
+	char name[32];
+	int error;
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(COMPLETE_OPT_HELP)) {
+		puts(usage_msg);
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(COMPLETE_OPT_HELP);
+		return 0;
+	}
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(COMPLETE_OPT_TYPE)) {
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(COMPLETE_OPT_TYPE);
+		type = restool.cmd_option_args[COMPLETE_OPT_TYPE];
+	}
+
+	error = obj_index_get_recent(&index);
+	if (error < 0) {
+		ERROR_PRINTF("no object index available: %s\n",
+			     strerror(-error));
+		return error;
+	}
+
+	/*
+	 * label:<prefix> only completes labels, a partial which may still
+	 * become label: (e.g. "" or "la") completes both
+	 */
+	partial_len = strlen(partial);
+	objects = partial_len < prefix_len ||
+		  strncmp(partial, OBJ_LABEL_PREFIX, prefix_len) != 0;
+	labels = strncmp(partial, OBJ_LABEL_PREFIX,
+			 partial_len < prefix_len ? partial_len : prefix_len) == 0;
+	for (unsigned int i = 0; i < index.num_entries; i++) {
+		const struct obj_index_entry *entry = &index.entries[i];
+
+		if (type != NULL && strcmp(entry->type, type) != 0)
+			continue;
+
+		if (objects) {
+			snprintf(name, sizeof(name), "%s.%u", entry->type,
+				 entry->id);
+			if (strncmp(name, partial, partial_len) == 0)
+				printf("%s\n", name);
+		}
+
+		if (labels && entry->label[0] != '\0') {
+			snprintf(name, sizeof(name), OBJ_LABEL_PREFIX "%s",
+				 entry->label);
+			if (strncmp(name, partial, partial_len) == 0)
+				printf("%s\n", name);
+		}
+	}
+
+	obj_index_free(&index);
+	return 0;
+}
+
+/**
+ * plan command options
+ */
+enum plan_options {
+	PLAN_OPT_HELP = 0,
+	PLAN_OPT_CONTAINER,
+	PLAN_OPT_VERBOSE,
+};
+
+static struct option plan_options[] = {
+	[PLAN_OPT_HELP] = {
+		.name = "help",
+		.has_arg = 0,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[PLAN_OPT_CONTAINER] = {
+		.name = "container",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[PLAN_OPT_VERBOSE] = {
+		.name = "verbose",
+		.has_arg = 0,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	{ 0 },
+};
+
+C_ASSERT(ARRAY_SIZE(plan_options) <= MAX_NUM_CMD_LINE_OPTIONS + 1);
+
+/* the resource pools the objects of a plan are drawn from */
+enum plan_res {
+	PLAN_RES_FQ = 0,
+	PLAN_RES_QPR,
+	PLAN_RES_QD,
+	PLAN_RES_CG,
+	PLAN_RES_BP,
+	PLAN_RES_SWP,
+	PLAN_RES_SWPCH,
+	PLAN_RES_MCP,
+	PLAN_NUM_RES,
+};
+
+static const char * const plan_res_types[] = {
+	[PLAN_RES_FQ] = "fq",
+	[PLAN_RES_QPR] = "qpr",
+	[PLAN_RES_QD] = "qd",
+	[PLAN_RES_CG] = "cg",
+	[PLAN_RES_BP] = "bp",
+	[PLAN_RES_SWP] = "swp",
+	[PLAN_RES_SWPCH] = "swpch",
+	[PLAN_RES_MCP] = "mcp",
+};
+
+C_ASSERT(ARRAY_SIZE(plan_res_types) == PLAN_NUM_RES);
+
+#define PLAN_MAX_PARAMS		32
+
+/* one numeric attribute of an object, e.g. num_queues = <8> */
+struct plan_param {
+	char name[32];
+	long value;
+	/* number of values of a list, e.g. priorities = <1 2 3> */
+	unsigned int num_values;
+};
+
+/* an object the plan creates, with what it draws from the container */
+struct plan_obj {
+	char type[OBJ_TYPE_MAX_LENGTH + 1];
+	unsigned int line;
+	unsigned int num_params;
+	struct plan_param params[PLAN_MAX_PARAMS];
+	uint64_t res[PLAN_NUM_RES];
+	uint64_t peb;
+};
+
+struct plan {
+	unsigned int num_objs;
+	unsigned int max_objs;
+	struct plan_obj *objs;
+};
+
+/* create options and DPL properties which name the same attribute */
+static const struct {
+	const char *alias;
+	const char *name;
+} plan_param_aliases[] = {
+	{ "mac_entries", "mac_filter_entries" },
+	{ "vlan_entries", "vlan_filter_entries" },
+	{ "max_fdb_entries", "num_fdb_entries" },
+	{ "num_of_priorities", "num_priorities" },
+};
+
+static void plan_add_param(struct plan_obj *obj, const char *name,
+			   const char *value)
+{
+	struct plan_param *param;
+	char *endptr;
+	long val;
+
+	if (obj->num_params == PLAN_MAX_PARAMS)
+		return;
+
+	errno = 0;
+	val = strtol(value, &endptr, 0);
+	if (errno != 0 || endptr == value)
+		return;
+
+	param = &obj->params[obj->num_params++];
+	snprintf(param->name, sizeof(param->name), "%s", name);
+	for (char *p = param->name; *p != '\0'; p++)
+		if (*p == '-')
+			*p = '_';
+
+	for (unsigned int i = 0; i < ARRAY_SIZE(plan_param_aliases); i++)
+		if (strcmp(param->name, plan_param_aliases[i].alias) == 0)
+			snprintf(param->name, sizeof(param->name), "%s",
+				 plan_param_aliases[i].name);
+
+	param->value = val;
+	param->num_values = 0;
+	for (const char *p = value; strtol(p, &endptr, 0), endptr != p;) {
+		param->num_values++;
+		p = endptr + strspn(endptr, ", ");
+	}
+}
+
+static const struct plan_param *plan_find_param(const struct plan_obj *obj,
+						const char *name)
+{
+	for (unsigned int i = 0; i < obj->num_params; i++)
+		if (strcmp(obj->params[i].name, name) == 0)
+			return &obj->params[i];
+
+	return NULL;
+}
+
+/* value of an attribute, or the MC default when it is missing or 0 */
+static uint64_t plan_param(const struct plan_obj *obj, const char *name,
+			   uint64_t def)
+{
+	const struct plan_param *param = plan_find_param(obj, name);
+
+	return param && param->value > 0 ? (uint64_t)param->value : def;
+}
+
+/* bytes of PEB memory taken by one table entry of a DPNI or a DPSW */
+#define PLAN_DPNI_ENTRY_SIZE	64
+#define PLAN_DPSW_FDB_ENTRY_SIZE	32
+#define PLAN_DPSW_VLAN_ENTRY_SIZE	16
+
+/**
+ * Estimate what an object draws from its container from its create
+ * parameters. The counts follow how the MC lays the objects out: a DPNI
+ * has a Rx frame queue per queue and traffic class, a Tx and a Tx
+ * confirmation queue per traffic class, and its classification tables
+ * (FS, QoS, MAC and VLAN filters) in PEB memory; a DPSW has a queuing
+ * destination per interface and its FDBs and VLAN tables in PEB memory.
+ */
+static int plan_obj_cost(struct plan_obj *obj)
+{
+	uint64_t num_queues, num_tcs, num_ifs, num_prios;
+	const struct plan_param *prios;
+
+	if (strcmp(obj->type, "dpni") == 0) {
+		num_queues = plan_param(obj, "num_queues", 1);
+		num_tcs = plan_param(obj, "num_tcs", 1);
+		obj->res[PLAN_RES_FQ] = num_queues * num_tcs + 2 * num_tcs;
+		obj->res[PLAN_RES_QPR] = num_tcs;
+		obj->res[PLAN_RES_QD] = 1;
+		obj->res[PLAN_RES_CG] = plan_param(obj, "num_cgs", 0);
+		obj->peb = PLAN_DPNI_ENTRY_SIZE *
+			   (plan_param(obj, "fs_entries", 64) * num_tcs +
+			    plan_param(obj, "qos_entries", 0) +
+			    plan_param(obj, "mac_filter_entries", 16) +
+			    plan_param(obj, "vlan_filter_entries", 0));
+	} else if (strcmp(obj->type, "dpsw") == 0) {
+		num_ifs = plan_param(obj, "num_ifs", 1);
+		obj->res[PLAN_RES_FQ] = num_ifs;
+		obj->res[PLAN_RES_QD] = num_ifs;
+		obj->peb = plan_param(obj, "mem_size", 0);
+		if (obj->peb == 0)
+			obj->peb = PLAN_DPSW_FDB_ENTRY_SIZE *
+				   plan_param(obj, "max_fdbs", 1) *
+				   plan_param(obj, "num_fdb_entries", 1024) +
+				   PLAN_DPSW_VLAN_ENTRY_SIZE * num_ifs *
+				   plan_param(obj, "max_vlans", 16);
+	} else if (strcmp(obj->type, "dpseci") == 0 ||
+		   strcmp(obj->type, "dpdmai") == 0) {
+		prios = plan_find_param(obj, "priorities");
+		num_queues = plan_param(obj, "num_queues",
+					prios ? prios->num_values : 1);
+		obj->res[PLAN_RES_FQ] = 2 * num_queues;
+	} else if (strcmp(obj->type, "dpci") == 0) {
+		num_prios = plan_param(obj, "num_priorities", 1);
+		obj->res[PLAN_RES_FQ] = 2 * num_prios;
+	} else if (strcmp(obj->type, "dpcon") == 0) {
+		obj->res[PLAN_RES_SWPCH] = 1;
+	} else if (strcmp(obj->type, "dpio") == 0) {
+		obj->res[PLAN_RES_SWP] = 1;
+	} else if (strcmp(obj->type, "dpbp") == 0) {
+		obj->res[PLAN_RES_BP] = 1;
+	} else if (strcmp(obj->type, "dpmcp") == 0) {
+		obj->res[PLAN_RES_MCP] = 1;
+	} else if (strcmp(obj->type, "dprc") != 0 &&
+		   strcmp(obj->type, "dpmac") != 0 &&
+		   strcmp(obj->type, "dpdmux") != 0 &&
+		   strcmp(obj->type, "dprtc") != 0 &&
+		   strcmp(obj->type, "dpaiop") != 0 &&
+		   strcmp(obj->type, "dpdcei") != 0) {
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static struct plan_obj *plan_new_obj(struct plan *plan, const char *type,
+				     unsigned int line)
+{
+	struct plan_obj *obj;
+
+	if (plan->num_objs == plan->max_objs) {
+		unsigned int max = plan->max_objs ? 2 * plan->max_objs : 32;
+
+		obj = realloc(plan->objs, max * sizeof(*obj));
+		if (!obj)
+			return NULL;
+
+		plan->objs = obj;
+		plan->max_objs = max;
+	}
+
+	obj = &plan->objs[plan->num_objs++];
+	memset(obj, 0, sizeof(*obj));
+	snprintf(obj->type, sizeof(obj->type), "%s", type);
+	obj->line = line;
+	return obj;
+}
+
+/**
+ * Parse one line of a batch file: a restool command line, with or without
+ * the leading 'restool'. Only the create commands draw resources, the
+ * other commands are skipped.
+ */
+static int plan_parse_cmd_line(struct plan *plan, char *line,
+			       unsigned int line_num)
+{
+	char *cursor, *token, *type = NULL;
+	struct plan_obj *obj;
+	char *comment;
+
+	comment = strchr(line, '#');
+	if (comment)
+		*comment = '\0';
+
+	token = strtok_r(line, " \t\r\n", &cursor);
+	if (token && strcmp(token, "restool") == 0)
+		token = strtok_r(NULL, " \t\r\n", &cursor);
+	/* global options, e.g. --script */
+	while (token && token[0] == '-')
+		token = strtok_r(NULL, " \t\r\n", &cursor);
+	if (!token)
+		return 0;
+
+	type = token;
+	token = strtok_r(NULL, " \t\r\n", &cursor);
+	if (!token || strcmp(token, "create") != 0)
+		return 0;
+
+	obj = plan_new_obj(plan, type, line_num);
+	if (!obj)
+		return -ENOMEM;
+
+	while ((token = strtok_r(NULL, " \t\r\n", &cursor)) != NULL) {
+		char *value;
+
+		if (strncmp(token, "--", 2) != 0)
+			continue;
+
+		token += 2;
+		value = strchr(token, '=');
+		if (value)
+			*value++ = '\0';
+		else
+			value = strtok_r(NULL, " \t\r\n", &cursor);
+
+		if (value)
+			plan_add_param(obj, token, value);
+	}
+
+	return 0;
+}
+
+/**
+ * Parse one line of a DPL source, as written by dprc generate-dpl: each
+ * 'dpxx@<id> {' node is an object, its '<name> = <value>;' properties are
+ * its attributes. The nesting depth tells where a node ends.
+ */
+static int plan_parse_dpl_line(struct plan *plan, char *line,
+			       unsigned int line_num, int *depth,
+			       int *obj_depth)
+{
+	char name[OBJ_TYPE_MAX_LENGTH + 1];
+	char key[32], value[64];
+	unsigned int id;
+	char brace;
+
+	if (*obj_depth >= 0 && *depth == *obj_depth + 1 &&
+	    sscanf(line, " %31[a-z0-9_-] = %63[^;]", key, value) == 2 &&
+	    value[0] == '<')
+		plan_add_param(&plan->objs[plan->num_objs - 1], key, value + 1);
+
+	if (sscanf(line, " %16[a-z]@%u %c", name, &id, &brace) == 3 &&
+	    brace == '{' && strncmp(name, "dp", 2) == 0 &&
+	    strcmp(name, "dprc") != 0) {
+		if (!plan_new_obj(plan, name, line_num))
+			return -ENOMEM;
+		*obj_depth = *depth;
+	}
+
+	for (const char *p = line; *p != '\0'; p++) {
+		if (*p == '{') {
+			(*depth)++;
+		} else if (*p == '}') {
+			(*depth)--;
+			if (*depth == *obj_depth)
+				*obj_depth = -1;
+		}
+	}
+
+	return 0;
+}
+
+static int plan_load(const char *path, struct plan *plan)
+{
+	unsigned int line_num = 0;
+	int depth = 0, obj_depth = -1;
+	bool dpl = false;
+	size_t len = 0;
+	char *line = NULL;
+	FILE *fp;
+	int error = 0;
+
+	fp = fopen(path, "r");
+	if (!fp) {
+		error = -errno;
+		ERROR_PRINTF("cannot open %s: %s\n", path, strerror(errno));
+		return error;
+	}
+
+	while (getline(&line, &len, fp) != -1) {
+		line_num++;
+		if (line_num == 1 && strstr(line, "/dts-v1/"))
+			dpl = true;
+
+		if (dpl)
+			error = plan_parse_dpl_line(plan, line, line_num,
+						    &depth, &obj_depth);
+		else
+			error = plan_parse_cmd_line(plan, line, line_num);
+		if (error < 0)
+			break;
+	}
+
+	free(line);
+	fclose(fp);
+	if (error < 0)
+		return error;
+
+	for (unsigned int i = 0; i < plan->num_objs; i++) {
+		error = plan_obj_cost(&plan->objs[i]);
+		if (error < 0) {
+			ERROR_PRINTF("%s:%u: unknown object type '%s'\n",
+				     path, plan->objs[i].line,
+				     plan->objs[i].type);
+			return error;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Place the PEB memory of each object, in plan order, in the first free
+ * block it fits in, like the MC does. Returns the first object which
+ * finds no block, or NULL when all of them fit.
+ */
+static const struct plan_obj *plan_place_peb(const struct plan *plan,
+					     struct mem_extent *extents,
+					     unsigned int num_extents)
+{
+	for (unsigned int i = 0; i < plan->num_objs; i++) {
+		const struct plan_obj *obj = &plan->objs[i];
+		unsigned int j;
+
+		if (obj->peb == 0)
+			continue;
+
+		for (j = 0; j < num_extents; j++)
+			if (extents[j].size >= obj->peb)
+				break;
+
+		if (j == num_extents)
+			return obj;
+
+		extents[j].offset += obj->peb;
+		extents[j].size -= obj->peb;
+	}
+
+	return NULL;
+}
+
+static void plan_print_objs(const struct plan *plan)
+{
+	for (unsigned int i = 0; i < plan->num_objs; i++) {
+		const struct plan_obj *obj = &plan->objs[i];
+		char size[16];
+
+		printf("line %u: %s", obj->line, obj->type);
+		for (int r = 0; r < PLAN_NUM_RES; r++)
+			if (obj->res[r])
+				printf(" %s=%llu", plan_res_types[r],
+				       (unsigned long long)obj->res[r]);
+		if (obj->peb)
+			printf(" peb=%s", mem_size_str(obj->peb, size,
+						       sizeof(size)));
+		printf("\n");
+	}
+	printf("\n");
+}
+
+static int cmd_plan(void)
+{
+	static const char usage_msg[] =
+		"\n"
+		"Usage: restool plan <file> [OPTIONS]\n"
+		"   Checks whether the objects a batch file or a DPL would\n"
+		"   create fit in the free resources and the free PEB memory\n"
+		"   of a container, and reports what is short, without\n"
+		"   creating anything.\n"
+		"   <file> is either a list of restool command lines, of\n"
+		"   which the create commands are counted, or a DPL source\n"
+		"   (.dts) as written by 'restool dprc generate-dpl'.\n"
+		"\n"
+		"OPTIONS:\n"
+		"--container=<container>\n"
+		"   Container the objects are created in. Defaults to the\n"
+		"   root container.\n"
+		"--verbose\n"
+		"   Also prints what each object needs.\n"
+		"\n";
+	uint64_t needed[PLAN_NUM_RES] = { 0 };
+	const struct plan_obj *no_block;
+	struct mem_extent *extents = NULL;
+	unsigned int num_extents = 0;
+	uint32_t dprc_id;
+	uint16_t dprc_handle;
+	bool dprc_opened = false;
+	const char *dprc_name = NULL;
+	struct mem_stats stats;
+	struct plan plan = { 0 };
+	uint64_t peb_needed = 0;
+	bool fits = true;
+	char buf1[16], buf2[16];
+	int error;
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(PLAN_OPT_HELP)) {
+		puts(usage_msg);
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(PLAN_OPT_HELP);
+		return 0;
+	}
+
+	if (restool.obj_name == NULL) {
+		ERROR_PRINTF("<file> argument missing\n");
+		puts(usage_msg);
+		return -EINVAL;
+	}
+
+	error = plan_load(restool.obj_name, &plan);
+	if (error < 0)
+		goto out;
+
+	error = ensure_mc_session();
+	if (error < 0)
+		goto out;
+
+	dprc_id = restool.root_dprc_id;
+	if (restool.cmd_option_mask & ONE_BIT_MASK(PLAN_OPT_CONTAINER)) {
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(PLAN_OPT_CONTAINER);
+		dprc_name = restool.cmd_option_args[PLAN_OPT_CONTAINER];
+		error = parse_object_name(dprc_name, "dprc", &dprc_id);
+		if (error < 0)
+			goto out;
+	}
+
+	if (dprc_id == restool.root_dprc_id) {
+		dprc_handle = restool.root_dprc_handle;
+	} else {
+		error = open_dprc(dprc_id, &dprc_handle);
+		if (error < 0)
+			goto out;
+		dprc_opened = true;
+	}
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(PLAN_OPT_VERBOSE)) {
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(PLAN_OPT_VERBOSE);
+		plan_print_objs(&plan);
+	}
+
+	for (unsigned int i = 0; i < plan.num_objs; i++) {
+		for (int r = 0; r < PLAN_NUM_RES; r++)
+			needed[r] += plan.objs[i].res[r];
+		peb_needed += plan.objs[i].peb;
+	}
+
+	printf("%u object(s) to create in dprc.%u\n\n", plan.num_objs,
+	       dprc_id);
+	printf("%-10s %10s %10s\n", "resource", "needed", "free");
+	for (int r = 0; r < PLAN_NUM_RES; r++) {
+		char type[RES_TYPE_MAX_LENGTH + 1];
+		int free_count;
+
+		if (needed[r] == 0)
+			continue;
+
+		snprintf(type, sizeof(type), "%s", plan_res_types[r]);
+		error = dprc_get_res_count(&restool.mc_io, 0, dprc_handle,
+					   type, &free_count);
+		if (error < 0) {
+			mc_status = flib_error_to_mc_status(error);
+			ERROR_PRINTF("%s: MC error: %s (status %#x)\n", type,
+				     mc_status_to_string(mc_status),
+				     mc_status);
+			goto out;
+		}
+
+		printf("%-10s %10llu %10d", type,
+		       (unsigned long long)needed[r], free_count);
+		if (needed[r] > (uint64_t)free_count) {
+			printf("  short by %llu",
+			       (unsigned long long)(needed[r] - free_count));
+			fits = false;
+		}
+		printf("\n");
+	}
+
+	if (peb_needed) {
+		error = read_mem_extents(dprc_handle, MEM_PART_PEB, false,
+					 &extents, &num_extents);
+		if (error < 0)
+			goto out;
+
+		get_mem_stats(extents, num_extents, &stats);
+		printf("%-10s %10s %10s",  "peb",
+		       mem_size_str(peb_needed, buf1, sizeof(buf1)),
+		       mem_size_str(stats.total_free, buf2, sizeof(buf2)));
+		no_block = plan_place_peb(&plan, extents, num_extents);
+		if (peb_needed > stats.total_free) {
+			printf("  short by %s",
+			       mem_size_str(peb_needed - stats.total_free,
+					    buf1, sizeof(buf1)));
+			fits = false;
+		} else if (no_block) {
+			printf("  fragmented: no free block for the %s of line %u (%s)",
+			       no_block->type, no_block->line,
+			       mem_size_str(no_block->peb, buf1,
+					    sizeof(buf1)));
+			fits = false;
+		}
+		printf("\n");
+	}
+
+	printf("\n%s\n", fits ? "The plan fits." : "The plan does not fit.");
+	if (!fits)
+		error = -ENOSPC;
+out:
+	if (dprc_opened) {
+		int error2;
+
+		error2 = dprc_close(&restool.mc_io, 0, dprc_handle);
+		if (error2 < 0) {
+			mc_status = flib_error_to_mc_status(error2);
+			ERROR_PRINTF("MC error: %s (status %#x)\n",
+				     mc_status_to_string(mc_status), mc_status);
+			if (error == 0)
+				error = error2;
+		}
+	}
+
+	free(extents);
+	free(plan.objs);
+	return error;
+}
+
+/**
+ * plan-cpus command options
+ */
+enum plan_cpus_options {
+	PLAN_CPUS_OPT_HELP = 0,
+	PLAN_CPUS_OPT_CORES,
+	PLAN_CPUS_OPT_CONTAINER,
+	PLAN_CPUS_OPT_DPIO_PRIORITIES,
+	PLAN_CPUS_OPT_DPCON_PRIORITIES,
+	PLAN_CPUS_OPT_APPLY,
+};
+
+static struct option plan_cpus_options[] = {
+	[PLAN_CPUS_OPT_HELP] = {
+		.name = "help",
+		.has_arg = 0,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[PLAN_CPUS_OPT_CORES] = {
+		.name = "cores",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[PLAN_CPUS_OPT_CONTAINER] = {
+		.name = "container",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[PLAN_CPUS_OPT_DPIO_PRIORITIES] = {
+		.name = "dpio-priorities",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[PLAN_CPUS_OPT_DPCON_PRIORITIES] = {
+		.name = "dpcon-priorities",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[PLAN_CPUS_OPT_APPLY] = {
+		.name = "apply",
+		.has_arg = 0,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	{ 0 },
+};
+
+C_ASSERT(ARRAY_SIZE(plan_cpus_options) <= MAX_NUM_CMD_LINE_OPTIONS + 1);
+
+#define CPU_SYSFS_DIR	"/sys/devices/system/cpu"
+#define CPU_MAX		1024
+
+/* the per core objects: a DPIO for its portal, a DPCON for its channel */
+enum cpu_obj {
+	CPU_OBJ_DPIO,
+	CPU_OBJ_DPCON,
+	CPU_NUM_OBJS,
+};
+
+static const char * const cpu_obj_types[] = {
+	[CPU_OBJ_DPIO] = "dpio",
+	[CPU_OBJ_DPCON] = "dpcon",
+};
+
+C_ASSERT(ARRAY_SIZE(cpu_obj_types) == CPU_NUM_OBJS);
+
+/* a DPIO or DPCON of the container, as read from the MC */
+struct cpu_obj_desc {
+	uint32_t id;
+	char label[MC_OBJ_LABEL_MAX_LENGTH + 1];
+	/* the portal of a DPIO, the channel of a DPCON */
+	uint16_t hw_id;
+	uint8_t num_priorities;
+	/* a DPIO without a local channel cannot serve a core */
+	bool usable;
+	int cpu;
+};
+
+struct cpu_layout {
+	unsigned int num_cpus;
+	unsigned int cpus[CPU_MAX];
+	int cluster[CPU_MAX];
+	/* per core, index of its object of each type, or -1 */
+	int objs[CPU_MAX][CPU_NUM_OBJS];
+	struct cpu_obj_desc *descs[CPU_NUM_OBJS];
+	unsigned int num_descs[CPU_NUM_OBJS];
+};
+
+/**
+ * Parse a CPU list like 0-3,8,10-15, as in sysfs, into a sorted list
+ */
+static int parse_cpu_list(const char *str, struct cpu_layout *layout)
+{
+	bool cpus[CPU_MAX] = { false };
+	const char *p = str;
+	unsigned long a, b;
+	char *end;
+
+	while (*p != '\0' && *p != '\n') {
+		if (!isdigit((unsigned char)*p))
+			return -EINVAL;
+		a = strtoul(p, &end, 10);
+		b = a;
+		if (*end == '-') {
+			if (!isdigit((unsigned char)end[1]))
+				return -EINVAL;
+			b = strtoul(end + 1, &end, 10);
+		}
+		if (a > b || b >= CPU_MAX)
+			return -EINVAL;
+
+		for (unsigned long c = a; c <= b; c++)
+			cpus[c] = true;
+
+		p = end;
+		if (*p == ',')
+			p++;
+		else if (*p != '\0' && *p != '\n')
+			return -EINVAL;
+	}
+
+	layout->num_cpus = 0;
+	for (unsigned int c = 0; c < CPU_MAX; c++)
+		if (cpus[c])
+			layout->cpus[layout->num_cpus++] = c;
+
+	return layout->num_cpus ? 0 : -EINVAL;
+}
+
+static int read_sysfs_line(const char *path, char *buf, size_t size)
+{
+	FILE *fp = fopen(path, "r");
+	int error = 0;
+
+	if (!fp)
+		return -errno;
+
+	if (!fgets(buf, size, fp))
+		error = -EIO;
+	fclose(fp);
+	return error;
+}
+
+/**
+ * The cluster of a core, from its cluster_id when the kernel exports one,
+ * else from its package
+ */
+static int read_cpu_cluster(unsigned int cpu)
+{
+	static const char * const files[] = {
+		"cluster_id", "physical_package_id",
+	};
+	char path[PATH_MAX];
+	char buf[32];
+
+	for (unsigned int f = 0; f < ARRAY_SIZE(files); f++) {
+		snprintf(path, sizeof(path), CPU_SYSFS_DIR "/cpu%u/topology/%s",
+			 cpu, files[f]);
+		if (read_sysfs_line(path, buf, sizeof(buf)) == 0)
+			return atoi(buf) < 0 ? 0 : atoi(buf);
+	}
+
+	return 0;
+}
+
+static int read_cpu_obj_desc(enum cpu_obj type, uint32_t id,
+			     struct cpu_obj_desc *desc)
+{
+	struct dpcon_attr_v10 dpcon_attr;
+	struct dpio_attr_v10 dpio_attr;
+	uint16_t token;
+	int error, error2;
+
+	desc->id = id;
+	desc->cpu = -1;
+
+	if (type == CPU_OBJ_DPIO) {
+		error = dpio_open_v10(&restool.mc_io, 0, id, &token);
+		if (error < 0)
+			return error;
+
+		memset(&dpio_attr, 0, sizeof(dpio_attr));
+		error = dpio_get_attributes_v10(&restool.mc_io, 0, token,
+						&dpio_attr);
+		desc->hw_id = dpio_attr.qbman_portal_id;
+		desc->num_priorities = dpio_attr.num_priorities;
+		desc->usable = dpio_attr.channel_mode == DPIO_LOCAL_CHANNEL;
+		error2 = dpio_close_v10(&restool.mc_io, 0, token);
+	} else {
+		error = dpcon_open_v10(&restool.mc_io, 0, id, &token);
+		if (error < 0)
+			return error;
+
+		memset(&dpcon_attr, 0, sizeof(dpcon_attr));
+		error = dpcon_get_attributes_v10(&restool.mc_io, 0, token,
+						 &dpcon_attr);
+		desc->hw_id = dpcon_attr.qbman_ch_id;
+		desc->num_priorities = dpcon_attr.num_priorities;
+		desc->usable = true;
+		error2 = dpcon_close_v10(&restool.mc_io, 0, token);
+	}
+
+	return error ? error : error2;
+}
+
+/**
+ * Read the DPIOs and DPCONs of the container, from the object index for
+ * their ids and labels and from the MC for their attributes
+ */
+static int read_cpu_objs(uint32_t dprc_id, struct cpu_layout *layout)
+{
+	struct obj_index index;
+	int error;
+
+	error = obj_index_get(&index);
+	if (error < 0)
+		return error;
+
+	for (int t = 0; t < CPU_NUM_OBJS; t++) {
+		layout->descs[t] = calloc(index.num_entries,
+					  sizeof(*layout->descs[t]));
+		if (!layout->descs[t]) {
+			error = -ENOMEM;
+			goto out;
+		}
+	}
+
+	for (unsigned int i = 0; i < index.num_entries; i++) {
+		const struct obj_index_entry *entry = &index.entries[i];
+		struct cpu_obj_desc *desc;
+		int t;
+
+		if (entry->parent_id != dprc_id)
+			continue;
+		for (t = 0; t < CPU_NUM_OBJS; t++)
+			if (strcmp(entry->type, cpu_obj_types[t]) == 0)
+				break;
+		if (t == CPU_NUM_OBJS)
+			continue;
+
+		desc = &layout->descs[t][layout->num_descs[t]];
+		error = read_cpu_obj_desc(t, entry->id, desc);
+		if (error < 0) {
+			mc_status = flib_error_to_mc_status(error);
+			ERROR_PRINTF("%s.%u: MC error: %s (status %#x)\n",
+				     entry->type, entry->id,
+				     mc_status_to_string(mc_status), mc_status);
+			goto out;
+		}
+		snprintf(desc->label, sizeof(desc->label), "%s", entry->label);
+		layout->num_descs[t]++;
+	}
+
+out:
+	obj_index_free(&index);
+	return error;
+}
+
+/**
+ * Give each core a DPIO and a DPCON: first the objects already labelled
+ * for it, then the unlabelled ones, handing them out to the clusters in
+ * turn so that when there are too few every cluster gets its share
+ */
+static void assign_cpu_objs(struct cpu_layout *layout)
+{
+	unsigned int order[CPU_MAX], num = 0;
+	int max_cluster = 0;
+
+	for (unsigned int i = 0; i < layout->num_cpus; i++) {
+		layout->objs[i][CPU_OBJ_DPIO] = -1;
+		layout->objs[i][CPU_OBJ_DPCON] = -1;
+		if (layout->cluster[i] > max_cluster)
+			max_cluster = layout->cluster[i];
+	}
+
+	/* the first core of each cluster, then the second one... */
+	for (unsigned int rank = 0; num < layout->num_cpus; rank++) {
+		for (int cluster = 0; cluster <= max_cluster; cluster++) {
+			unsigned int seen = 0;
+
+			for (unsigned int i = 0; i < layout->num_cpus; i++) {
+				if (layout->cluster[i] != cluster)
+					continue;
+				if (seen++ == rank) {
+					order[num++] = i;
+					break;
+				}
+			}
+		}
+	}
+
+	for (int t = 0; t < CPU_NUM_OBJS; t++) {
+		for (unsigned int d = 0; d < layout->num_descs[t]; d++) {
+			struct cpu_obj_desc *desc = &layout->descs[t][d];
+			unsigned int cpu;
+
+			if (!desc->usable ||
+			    sscanf(desc->label, "cpu%u", &cpu) != 1)
+				continue;
+
+			for (unsigned int i = 0; i < layout->num_cpus; i++) {
+				if (layout->cpus[i] == cpu &&
+				    layout->objs[i][t] < 0) {
+					layout->objs[i][t] = d;
+					desc->cpu = cpu;
+					break;
+				}
+			}
+		}
+
+		for (unsigned int d = 0, o = 0; d < layout->num_descs[t]; d++) {
+			struct cpu_obj_desc *desc = &layout->descs[t][d];
+
+			if (!desc->usable || desc->label[0] != '\0')
+				continue;
+
+			while (o < num && layout->objs[order[o]][t] >= 0)
+				o++;
+			if (o == num)
+				break;
+
+			layout->objs[order[o]][t] = d;
+			desc->cpu = layout->cpus[order[o]];
+		}
+	}
+}
+
+static void print_cpu_obj(const struct cpu_layout *layout, unsigned int i,
+			  enum cpu_obj t)
+{
+	const struct cpu_obj_desc *desc;
+	char buf[48];
+
+	if (layout->objs[i][t] < 0) {
+		snprintf(buf, sizeof(buf), "(to create)");
+	} else {
+		desc = &layout->descs[t][layout->objs[i][t]];
+		snprintf(buf, sizeof(buf), "%s.%u %s %#x, %u prio%s",
+			 cpu_obj_types[t], desc->id,
+			 t == CPU_OBJ_DPIO ? "portal" : "channel", desc->hw_id,
+			 desc->num_priorities, desc->label[0] ? "" : " *");
+	}
+
+	if (t == CPU_NUM_OBJS - 1)
+		printf("  %s", buf);
+	else
+		printf("  %-30s", buf);
+}
+
+static void print_cpu_layout(const struct cpu_layout *layout)
+{
+	unsigned int missing[CPU_NUM_OBJS] = { 0 };
+	unsigned int unlabelled = 0;
+	int cluster = -1;
+
+	for (unsigned int i = 0; i < layout->num_cpus; i++) {
+		if (layout->cluster[i] != cluster) {
+			cluster = layout->cluster[i];
+			printf("cluster %d:\n", cluster);
+		}
+
+		printf("  cpu%-4u", layout->cpus[i]);
+		for (int t = 0; t < CPU_NUM_OBJS; t++) {
+			print_cpu_obj(layout, i, t);
+			if (layout->objs[i][t] < 0)
+				missing[t]++;
+		}
+		printf("\n");
+	}
+
+	for (int t = 0; t < CPU_NUM_OBJS; t++) {
+		for (unsigned int d = 0; d < layout->num_descs[t]; d++) {
+			const struct cpu_obj_desc *desc = &layout->descs[t][d];
+
+			if (desc->cpu >= 0) {
+				unlabelled += desc->label[0] == '\0';
+				continue;
+			}
+			printf("not assigned: %s.%u", cpu_obj_types[t],
+			       desc->id);
+			if (!desc->usable)
+				printf(" (no local channel)");
+			else if (desc->label[0] != '\0')
+				printf(" (label %s)", desc->label);
+			printf("\n");
+		}
+	}
+
+	printf("to create: %u dpio, %u dpcon; to label (*): %u\n",
+	       missing[CPU_OBJ_DPIO], missing[CPU_OBJ_DPCON], unlabelled);
+}
+
+/**
+ * Create the missing DPIOs and DPCONs in the container and label every
+ * per core object cpu<N>
+ */
+static int apply_cpu_layout(struct cpu_layout *layout, uint16_t dprc_handle,
+			    uint8_t dpio_prios, uint8_t dpcon_prios)
+{
+	struct dpio_cfg_v10 dpio_cfg = {
+		.channel_mode = DPIO_LOCAL_CHANNEL,
+		.num_priorities = dpio_prios,
+	};
+	struct dpcon_cfg_v10 dpcon_cfg = {
+		.num_priorities = dpcon_prios,
+	};
+	char label[MC_OBJ_LABEL_MAX_LENGTH + 1];
+	uint32_t id;
+	int error;
+
+	for (unsigned int i = 0; i < layout->num_cpus; i++) {
+		snprintf(label, sizeof(label), "cpu%u", layout->cpus[i]);
+
+		for (int t = 0; t < CPU_NUM_OBJS; t++) {
+			int d = layout->objs[i][t];
+
+			if (d >= 0 &&
+			    strcmp(layout->descs[t][d].label, label) == 0)
+				continue;
+
+			if (d >= 0) {
+				id = layout->descs[t][d].id;
+			} else if (t == CPU_OBJ_DPIO) {
+				error = dpio_create_v10(&restool.mc_io,
+							dprc_handle, 0,
+							&dpio_cfg, &id);
+				if (error < 0)
+					return error;
+			} else {
+				error = dpcon_create_v10(&restool.mc_io,
+							 dprc_handle, 0,
+							 &dpcon_cfg, &id);
+				if (error < 0)
+					return error;
+			}
+
+			error = dprc_set_obj_label(&restool.mc_io, 0,
+						   dprc_handle,
+						   (char *)cpu_obj_types[t],
+						   id, label);
+			if (error < 0)
+				return error;
+
+			printf("%s %s.%u for %s\n",
+			       d >= 0 ? "labelled" : "created",
+			       cpu_obj_types[t], id, label);
+		}
+	}
+
+	return 0;
+}
+
+static int cmd_plan_cpus(void)
+{
+	static const char usage_msg[] =
+		"\n"
+		"Usage: restool plan-cpus [OPTIONS]\n"
+		"   Lays out one DPIO (software portal) and one DPCON (channel)\n"
+		"   per core of a container, grouped by CPU cluster as read from\n"
+		"   " CPU_SYSFS_DIR ". The objects labelled cpu<N> are kept\n"
+		"   for core N, the unlabelled ones are handed out to the\n"
+		"   clusters in turn, and the missing ones are listed.\n"
+		"   Objects marked * are not labelled yet.\n"
+		"\n"
+		"OPTIONS:\n"
+		"--cores=<list>\n"
+		"   Cores to lay out, e.g. 0-7,12. Defaults to the online cores.\n"
+		"--container=<container>\n"
+		"   Container of the objects. Defaults to the root container.\n"
+		"--dpio-priorities=<n>\n"
+		"   Priorities of the DPIOs to create, 1-8. Default is 8.\n"
+		"--dpcon-priorities=<n>\n"
+		"   Priorities of the DPCONs to create, 1-8. Default is 2.\n"
+		"--apply\n"
+		"   Creates the missing DPIOs and DPCONs and labels all the\n"
+		"   objects of the layout cpu<N>. The new objects are left\n"
+		"   unplugged, see 'dprc assign --plugged'.\n"
+		"\n";
+	uint8_t dpio_prios = 8, dpcon_prios = 2;
+	uint32_t dprc_id;
+	struct cpu_layout *layout;
+	const char *dprc_name = NULL;
+	bool dprc_opened = false;
+	uint16_t dprc_handle;
+	bool apply = false;
+	char buf[4096];
+	long value;
+	int error;
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(PLAN_CPUS_OPT_HELP)) {
+		puts(usage_msg);
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(PLAN_CPUS_OPT_HELP);
+		return 0;
+	}
+
+	layout = calloc(1, sizeof(*layout));
+	if (!layout)
+		return -ENOMEM;
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(PLAN_CPUS_OPT_CORES)) {
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(PLAN_CPUS_OPT_CORES);
+		snprintf(buf, sizeof(buf), "%s",
+			 restool.cmd_option_args[PLAN_CPUS_OPT_CORES]);
+	} else {
+		error = read_sysfs_line(CPU_SYSFS_DIR "/online", buf,
+					sizeof(buf));
+		if (error < 0) {
+			ERROR_PRINTF("cannot read the online cores: %s\n",
+				     strerror(-error));
+			goto out;
+		}
+	}
+
+	error = parse_cpu_list(buf, layout);
+	if (error < 0) {
+		ERROR_PRINTF("Invalid core list: %s\n", buf);
+		puts(usage_msg);
+		goto out;
+	}
+
+	if (restool.cmd_option_mask &
+	    ONE_BIT_MASK(PLAN_CPUS_OPT_DPIO_PRIORITIES)) {
+		restool.cmd_option_mask &=
+			~ONE_BIT_MASK(PLAN_CPUS_OPT_DPIO_PRIORITIES);
+		error = get_option_value(PLAN_CPUS_OPT_DPIO_PRIORITIES, &value,
+					 "Invalid number of priorities", 1, 8);
+		if (error)
+			goto out;
+		dpio_prios = value;
+	}
+
+	if (restool.cmd_option_mask &
+	    ONE_BIT_MASK(PLAN_CPUS_OPT_DPCON_PRIORITIES)) {
+		restool.cmd_option_mask &=
+			~ONE_BIT_MASK(PLAN_CPUS_OPT_DPCON_PRIORITIES);
+		error = get_option_value(PLAN_CPUS_OPT_DPCON_PRIORITIES, &value,
+					 "Invalid number of priorities", 1, 8);
+		if (error)
+			goto out;
+		dpcon_prios = value;
+	}
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(PLAN_CPUS_OPT_APPLY)) {
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(PLAN_CPUS_OPT_APPLY);
+		apply = true;
+	}
+
+	/* cores sorted by cluster, keeping their order within a cluster */
+	for (unsigned int i = 0; i < layout->num_cpus; i++) {
+		unsigned int cpu = layout->cpus[i];
+		int cluster = read_cpu_cluster(cpu);
+		unsigned int j = i;
+
+		for (; j > 0 && layout->cluster[j - 1] > cluster; j--) {
+			layout->cpus[j] = layout->cpus[j - 1];
+			layout->cluster[j] = layout->cluster[j - 1];
+		}
+		layout->cpus[j] = cpu;
+		layout->cluster[j] = cluster;
+	}
+
+	error = ensure_mc_session();
+	if (error < 0)
+		goto out;
+
+	error = check_mc_v10("plan-cpus");
+	if (error < 0)
+		goto out;
+
+	dprc_id = restool.root_dprc_id;
+	if (restool.cmd_option_mask & ONE_BIT_MASK(PLAN_CPUS_OPT_CONTAINER)) {
+		restool.cmd_option_mask &=
+			~ONE_BIT_MASK(PLAN_CPUS_OPT_CONTAINER);
+		dprc_name = restool.cmd_option_args[PLAN_CPUS_OPT_CONTAINER];
+		error = parse_object_name(dprc_name, "dprc", &dprc_id);
+		if (error < 0)
+			goto out;
+	}
+
+	error = read_cpu_objs(dprc_id, layout);
+	if (error < 0)
+		goto out;
+
+	assign_cpu_objs(layout);
+	print_cpu_layout(layout);
+	if (!apply)
+		goto out;
+
+	dprc_handle = restool.root_dprc_handle;
+	if (dprc_id != restool.root_dprc_id) {
+		error = open_dprc(dprc_id, &dprc_handle);
+		if (error < 0)
+			goto out;
+		dprc_opened = true;
+	}
+
+	error = apply_cpu_layout(layout, dprc_handle, dpio_prios,
+				 dpcon_prios);
+	if (error < 0) {
+		mc_status = flib_error_to_mc_status(error);
+		ERROR_PRINTF("MC error: %s (status %#x)\n",
+			     mc_status_to_string(mc_status), mc_status);
+	}
+	obj_index_invalidate();
+
+out:
+	if (dprc_opened)
+		(void)dprc_close(&restool.mc_io, 0, dprc_handle);
+	for (int t = 0; t < CPU_NUM_OBJS; t++)
+		free(layout->descs[t]);
+	free(layout);
+	return error;
+}
+
+/**
+ * link command options
+ */
+enum link_options {
+	LINK_OPT_HELP = 0,
+	LINK_OPT_INTERVAL,
+	LINK_OPT_COUNT,
+	LINK_OPT_DURATION,
+	LINK_OPT_TYPE,
+};
+
+static struct option link_options[] = {
+	[LINK_OPT_HELP] = {
+		.name = "help",
+		.has_arg = 0,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[LINK_OPT_INTERVAL] = {
+		.name = "interval",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[LINK_OPT_COUNT] = {
+		.name = "count",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[LINK_OPT_DURATION] = {
+		.name = "duration",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	[LINK_OPT_TYPE] = {
+		.name = "type",
+		.has_arg = 1,
+		.flag = NULL,
+		.val = 0,
+	},
+
+	{ 0 },
+};
+
+C_ASSERT(ARRAY_SIZE(link_options) <= MAX_NUM_CMD_LINE_OPTIONS + 1);
+
+/* the object types which have a link the monitor can poll */
+static const char * const link_types[] = { "dpni", "dpci", "dpmac" };
+
+#define LINK_UP			1
+#define LINK_DOWN		0
+#define LINK_NOT_CONNECTED	(-1)
+#define LINK_UNKNOWN		(-2)
+
+/* upper bounds, in seconds, of the buckets of the up and down durations */
+static const struct {
+	double secs;
+	const char *name;
+} link_hist_buckets[] = {
+	{ 0.1, "<100ms" },
+	{ 1, "<1s" },
+	{ 10, "<10s" },
+	{ 60, "<1m" },
+	{ 600, "<10m" },
+	{ 3600, "<1h" },
+	{ INFINITY, ">=1h" },
+};
+
+#define LINK_HIST_BUCKETS	ARRAY_SIZE(link_hist_buckets)
+
+struct link_mon {
+	char type[OBJ_TYPE_MAX_LENGTH + 1];
+	uint32_t id;
+	uint16_t token;
+	bool opened;
+	int state;
+	/* when the link entered its current state */
+	struct timespec since;
+	unsigned int flaps;
+	unsigned int up_hist[LINK_HIST_BUCKETS];
+	unsigned int down_hist[LINK_HIST_BUCKETS];
+	double up_secs;
+	double down_secs;
+};
+
+static const char *link_state_str(int state)
+{
+	switch (state) {
+	case LINK_UP:
+		return "up";
+	case LINK_DOWN:
+		return "down";
+	case LINK_NOT_CONNECTED:
+		return "unconnected";
+	default:
+		return "unknown";
+	}
+}
+
+
+static int link_open(struct link_mon *link)
+{
+	int error = 0;
+
+	if (strcmp(link->type, "dpni") == 0)
+		error = dpni_open_v10(&restool.mc_io, 0, link->id,
+				      &link->token);
+	else if (strcmp(link->type, "dpci") == 0)
+		error = dpci_open_v10(&restool.mc_io, 0, link->id,
+				      &link->token);
+	else
+		/* a dpmac link is read from its connection, not opened */
+		return 0;
+
+	link->opened = error == 0;
+	return error;
+}
+
+static void link_close(struct link_mon *link)
+{
+	if (!link->opened)
+		return;
+
+	if (strcmp(link->type, "dpni") == 0)
+		(void)dpni_close_v10(&restool.mc_io, 0, link->token);
+	else
+		(void)dpci_close_v10(&restool.mc_io, 0, link->token);
+	link->opened = false;
+}
+
+static int link_read_state(struct link_mon *link)
+{
+	struct dpni_link_state_v10 dpni_state;
+	struct dprc_endpoint endpoint1;
+	struct dprc_endpoint endpoint2;
+	int state, error;
+
+	if (strcmp(link->type, "dpni") == 0) {
+		memset(&dpni_state, 0, sizeof(dpni_state));
+		error = dpni_get_link_state_v10(&restool.mc_io, LINK_LANE,
+						link->token, &dpni_state);
+		state = dpni_state.up ? LINK_UP : LINK_DOWN;
+	} else if (strcmp(link->type, "dpci") == 0) {
+		error = dpci_get_link_state_v10(&restool.mc_io, LINK_LANE,
+						link->token, &state);
+		state = state ? LINK_UP : LINK_DOWN;
+	} else {
+		memset(&endpoint1, 0, sizeof(endpoint1));
+		memset(&endpoint2, 0, sizeof(endpoint2));
+		strncpy(endpoint1.type, "dpmac", EP_OBJ_TYPE_MAX_LEN);
+		endpoint1.id = link->id;
+		error = dprc_get_connection(&restool.mc_io, CONN_LANE,
+					    restool.root_dprc_handle,
+					    &endpoint1, &endpoint2, &state);
+		if (state != LINK_UP && state != LINK_NOT_CONNECTED)
+			state = LINK_DOWN;
+	}
+
+	return error ? LINK_UNKNOWN : state;
+}
+
+static void link_print_time(void)
+{
+	struct timespec now;
+	struct tm tm;
+	char buf[32];
+
+	clock_gettime(CLOCK_REALTIME, &now);
+	localtime_r(&now.tv_sec, &tm);
+	strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
+	printf("%s.%03ld ", buf, now.tv_nsec / 1000000);
+}
+
+/**
+ * Account for the period a link spent in its previous state, print the
+ * transition and count it as a flap when the link went down
+ */
+static void link_transition(struct link_mon *link, int state,
+			    const struct timespec *now)
+{
+	double secs = timespec_elapsed(&link->since, now);
+	unsigned int *hist = NULL;
+	unsigned int b;
+
+	link_print_time();
+	printf("%s.%u %s -> %s after %.3f s\n", link->type, link->id,
+	       link_state_str(link->state), link_state_str(state), secs);
+
+	if (link->state == LINK_UP) {
+		hist = link->up_hist;
+		link->up_secs += secs;
+		if (state == LINK_DOWN)
+			link->flaps++;
+	} else if (link->state == LINK_DOWN) {
+		hist = link->down_hist;
+		link->down_secs += secs;
+	}
+
+	if (hist) {
+		for (b = 0; secs >= link_hist_buckets[b].secs; b++)
+			;
+		hist[b]++;
+	}
+
+	link->state = state;
+	link->since = *now;
+}
+
+static void link_print_hist(const char *what, const unsigned int *hist)
+{
+	printf("  %-14s", what);
+	for (unsigned int b = 0; b < LINK_HIST_BUCKETS; b++)
+		printf(" %s:%u", link_hist_buckets[b].name, hist[b]);
+	printf("\n");
+}
+
+static void link_print_summary(struct link_mon *links, unsigned int num,
+			       const struct timespec *now)
+{
+	printf("\n%-12s %-12s %6s %7s\n", "link", "state", "flaps", "up %");
+	for (unsigned int i = 0; i < num; i++) {
+		struct link_mon *link = &links[i];
+		double secs = timespec_elapsed(&link->since, now);
+		double up = link->up_secs, down = link->down_secs;
+		char name[32];
+
+		/* the current period counts in the time up, not in the histograms */
+		if (link->state == LINK_UP)
+			up += secs;
+		else if (link->state == LINK_DOWN)
+			down += secs;
+
+		snprintf(name, sizeof(name), "%s.%u", link->type, link->id);
+		printf("%-12s %-12s %6u", name, link_state_str(link->state),
+		       link->flaps);
+		if (up + down > 0)
+			printf(" %7.2f\n", 100 * up / (up + down));
+		else
+			printf(" %7s\n", "-");
+
+		if (link->up_secs + link->down_secs == 0)
+			continue;
+		link_print_hist("up periods:", link->up_hist);
+		link_print_hist("down periods:", link->down_hist);
+	}
+}
+
+static bool link_type_wanted(const char *types, const char *type)
+{
+	size_t len = strlen(type);
+
+	if (!types)
+		return true;
+
+	for (const char *p = types; p; p = strchr(p, ',')) {
+		if (*p == ',')
+			p++;
+		if (strncmp(p, type, len) == 0 &&
+		    (p[len] == ',' || p[len] == '\0'))
+			return true;
+	}
+
+	return false;
+}
+
+static int link_monitor(struct link_mon *links, unsigned int num,
+			struct watch *watch)
+{
+	struct timespec now;
+
+	watch_start(watch);
+	for (unsigned int i = 0; i < num; i++) {
+		links[i].state = link_read_state(&links[i]);
+		links[i].since = watch->now;
+		link_print_time();
+		printf("%s.%u %s\n", links[i].type, links[i].id,
+		       link_state_str(links[i].state));
+	}
+	fflush(stdout);
+
+	while (watch_next(watch)) {
+		for (unsigned int i = 0; i < num; i++) {
+			int state = link_read_state(&links[i]);
+
+			if (state != links[i].state)
+				link_transition(&links[i], state, &watch->now);
+		}
+		fflush(stdout);
+	}
+
+	watch_stop(watch);
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	link_print_summary(links, num, &now);
+
+	return 0;
+}
+
+static int cmd_link(void)
+{
+	static const char usage_msg[] =
+		"\n"
+		"Usage: restool link monitor [OPTIONS]\n"
+		"   Polls the link state of all the DPNIs, DPCIs and DPMACs,\n"
+		"   and prints each transition with its time and how long the\n"
+		"   link stayed in its previous state. When interrupted, or\n"
+		"   at the end of --count or --duration, prints per link its\n"
+		"   number of flaps (up to down transitions), the share of time\n"
+		"   it was up and histograms of the durations of its up and\n"
+		"   down periods.\n"
+		"\n"
+		"OPTIONS:\n"
+		"--interval=<ms>\n"
+		"   Polls every <ms> milliseconds. Default is 1000.\n"
+		"--count=<n>\n"
+		"   Stops after <n> intervals.\n"
+		"--duration=<seconds>\n"
+		"   Stops after <seconds>. Default is to run until interrupted.\n"
+		"--type=<types>\n"
+		"   Only monitors these object types, e.g. dpni,dpmac.\n"
+		"\n"
+		"EXAMPLE:\n"
+		"Poll the DPMAC links every 100 ms for a minute:\n"
+		"   $ restool link monitor --type=dpmac --interval=100 --duration=60\n"
+		"\n";
+	struct watch watch = { .interval_ms = 1000 };
+	struct link_mon *links = NULL;
+	const char *types = NULL;
+	struct obj_index index;
+	unsigned int num = 0;
+	int error;
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(LINK_OPT_HELP)) {
+		puts(usage_msg);
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(LINK_OPT_HELP);
+		return 0;
+	}
+
+	if (restool.obj_name == NULL ||
+	    strcmp(restool.obj_name, "monitor") != 0) {
+		ERROR_PRINTF("expected 'monitor'\n");
+		puts(usage_msg);
+		return -EINVAL;
+	}
+
+	error = get_watch_options(&watch, LINK_OPT_INTERVAL, LINK_OPT_COUNT,
+				  LINK_OPT_DURATION);
+	if (error < 0)
+		return error;
+
+	if (restool.cmd_option_mask & ONE_BIT_MASK(LINK_OPT_TYPE)) {
+		restool.cmd_option_mask &= ~ONE_BIT_MASK(LINK_OPT_TYPE);
+		types = restool.cmd_option_args[LINK_OPT_TYPE];
+		for (const char *p = types; p; p = strchr(p + 1, ',')) {
+			const char *type = *p == ',' ? p + 1 : p;
+			size_t len = strcspn(type, ",");
+			unsigned int t;
+
+			for (t = 0; t < ARRAY_SIZE(link_types); t++)
+				if (strlen(link_types[t]) == len &&
+				    strncmp(type, link_types[t], len) == 0)
+					break;
+
+			if (t == ARRAY_SIZE(link_types)) {
+				ERROR_PRINTF("Invalid type: %.*s\n", (int)len,
+					     type);
+				puts(usage_msg);
+				return -EINVAL;
+			}
+		}
+	}
+
+	error = ensure_mc_session();
+	if (error < 0)
+		return error;
+
+	/* link_open() and link_read_state() use the v10 DPNI/DPMAC/DPCI API */
+	error = check_mc_v10("link monitor");
+	if (error < 0)
+		return error;
+
+	error = obj_index_get(&index);
+	if (error < 0)
+		return error;
+
+	links = calloc(index.num_entries, sizeof(*links));
+	if (!links) {
+		error = -ENOMEM;
+		goto out;
+	}
+
+	for (unsigned int i = 0; i < index.num_entries; i++) {
+		const struct obj_index_entry *entry = &index.entries[i];
+		unsigned int t;
+
+		for (t = 0; t < ARRAY_SIZE(link_types); t++)
+			if (strcmp(entry->type, link_types[t]) == 0)
+				break;
+		if (t == ARRAY_SIZE(link_types) ||
+		    !link_type_wanted(types, entry->type))
+			continue;
+
+		strcpy(links[num].type, entry->type);
+		links[num].id = entry->id;
+		links[num].state = LINK_UNKNOWN;
+		error = link_open(&links[num]);
+		if (error < 0) {
+			mc_status = flib_error_to_mc_status(error);
+			ERROR_PRINTF("%s.%u: MC error: %s (status %#x)\n",
+				     entry->type, entry->id,
+				     mc_status_to_string(mc_status), mc_status);
+			continue;
+		}
+		num++;
+	}
+
+	if (num == 0) {
+		ERROR_PRINTF("no link to monitor\n");
+		error = -ENOENT;
+		goto out;
+	}
+
+	error = link_monitor(links, num, &watch);
+out:
+	for (unsigned int i = 0; i < num; i++)
+		link_close(&links[i]);
+	free(links);
+	obj_index_free(&index);
+	return error;
+}
+
+struct object_command toplevel_commands[] = {
+	{ .cmd_name = "complete",
+	  .options = complete_options,
+	  .cmd_func = cmd_complete },
+
+	{ .cmd_name = "plan",
+	  .options = plan_options,
+	  .cmd_func = cmd_plan },
+
+	{ .cmd_name = "plan-cpus",
+	  .options = plan_cpus_options,
+	  .cmd_func = cmd_plan_cpus },
+
+	{ .cmd_name = "link",
+	  .options = link_options,
+	  .cmd_func = cmd_link },
+
+	{ .cmd_name = NULL },
+};